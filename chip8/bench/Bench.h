@@ -0,0 +1,105 @@
+//
+// Created by david on 18-10-26.
+//
+
+#ifndef CHIP8_BENCH_H
+#define CHIP8_BENCH_H
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+    /**
+     * Keep a value alive so the optimizer can't drop the work that produced it
+     */
+    template<typename T>
+    inline void keep(const T & value) {
+        asm volatile("" : : "g"(&value) : "memory");
+    }
+
+    struct Result {
+        std::string name;
+        uint64_t iterations;
+        double seconds;
+
+        double nanosPerOp() const { return seconds * 1e9 / iterations; }
+        double opsPerSecond() const { return iterations / seconds; }
+    };
+
+    /**
+     * Time iterations calls of fn
+     * @param name Name of the benchmark
+     * @param iterations Number of calls
+     * @param fn Function to call
+     * @return Timing result
+     */
+    template<typename Fn>
+    Result run(const std::string & name, uint64_t iterations, Fn && fn) {
+        // Warm up caches and branch predictors
+        for (uint64_t i = 0; i < iterations / 10 + 1; ++i) {
+            fn();
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        for (uint64_t i = 0; i < iterations; ++i) {
+            fn();
+        }
+        auto end = std::chrono::steady_clock::now();
+
+        return Result{name, iterations, std::chrono::duration<double>(end - start).count()};
+    }
+
+    /**
+     * @return Every result reported so far
+     */
+    inline std::vector<Result> & results() {
+        static std::vector<Result> all;
+        return all;
+    }
+
+    inline void report(const Result & result) {
+        results().push_back(result);
+        std::cout << result.name << ": " << result.nanosPerOp() << " ns/op, "
+                  << (uint64_t) result.opsPerSecond() << " ops/s" << std::endl;
+    }
+
+    /**
+     * Write every reported result as JSON, for tracking regressions across commits
+     */
+    inline void writeJson(std::ostream & out) {
+        out << "{\n  \"results\": [";
+        for (size_t i = 0; i < results().size(); ++i) {
+            const Result & result = results()[i];
+            out << (i ? ",\n    " : "\n    ")
+                << "{\"name\": \"" << result.name << "\", \"iterations\": " << result.iterations
+                << ", \"seconds\": " << result.seconds << ", \"ns_per_op\": " << result.nanosPerOp() << "}";
+        }
+        out << "\n  ]\n}\n";
+    }
+}
+
+void benchSnapshot();
+void benchPagedSnapshot();
+void benchRewind();
+void benchReplay();
+void benchReplayFile();
+void benchRunAhead();
+void benchDebugger();
+void benchDebugPolicy();
+void benchAnnotate();
+void benchTrace();
+void benchOpcodes();
+void benchPrograms();
+void benchQuirks();
+void benchMachines();
+void benchScheduler();
+void benchTiming();
+void benchTimer();
+void benchSessions();
+void benchKeyChannel();
+
+#endif //CHIP8_BENCH_H
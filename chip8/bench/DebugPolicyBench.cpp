@@ -0,0 +1,46 @@
+//
+// Created by david on 18-10-26.
+//
+
+#include "Bench.h"
+#include "Programs.h"
+#include "../src/chip8.h"
+#include "../src/Debugger/DebugPolicy.h"
+
+void benchDebugPolicy() {
+    const uint64_t cycles = 10000000;
+
+    // The interpreter as the front-end runs it
+    chip8 plain;
+    programs::load(plain, programs::counter());
+    bench::Result frames = bench::run("interpreter_plain", cycles / CYCLES_PER_FRAME, [&]() {
+        plain.runFrame();
+    });
+    frames.iterations *= CYCLES_PER_FRAME;
+    bench::report(frames);
+
+    // Same loop through runUntil(), once with the null policy and once with an idle and a busy debugger
+    auto runWith = [&](const char * name, auto & debug) {
+        chip8 machine;
+        programs::load(machine, programs::counter());
+        auto start = std::chrono::steady_clock::now();
+        machine.runUntil(cycles, debug);
+        auto end = std::chrono::steady_clock::now();
+        bench::report(bench::Result{name, cycles, std::chrono::duration<double>(end - start).count()});
+    };
+
+    NullDebugPolicy none;
+    runWith("interpreter_null_policy", none);
+
+    DebugPolicy idle;
+    runWith("interpreter_debug_policy_idle", idle);
+
+    // Breakpoints and watchpoints everywhere the program doesn't go, so it never stops
+    DebugPolicy busy;
+    for (unsigned short address = 0x400; address < 0x1000; ++address) {
+        busy.setBreakpoint(address);
+        busy.setWatchpoint(address);
+    }
+    busy.watchRegister(0xE);
+    runWith("interpreter_debug_policy_3k_breakpoints", busy);
+}
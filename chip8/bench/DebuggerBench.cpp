@@ -0,0 +1,86 @@
+//
+// Created by david on 18-10-26.
+//
+
+#include <random>
+#include <string>
+#include <vector>
+#include "Bench.h"
+#include "Programs.h"
+#include "../src/chip8.h"
+#include "../src/Debugger/TimeTravelDebugger.h"
+
+/**
+ * Time a single debugger operation
+ */
+template<typename Fn>
+static void timeOperation(const std::string & name, Fn && fn) {
+    auto start = std::chrono::steady_clock::now();
+    bool found = fn();
+    auto end = std::chrono::steady_clock::now();
+
+    std::cout << name << ": " << std::chrono::duration<double, std::milli>(end - start).count() << " ms"
+              << (found ? "" : " (not found)") << std::endl;
+}
+
+void benchDebugger() {
+    // Three nested counters, the outer one reaches 10 after about 55 minutes of play and is then stored
+    static const std::vector<unsigned char> program = {
+            0x60, 0x00, // 200: LD V0, 0
+            0x61, 0x00, // 202: LD V1, 0
+            0x62, 0x00, // 204: LD V2, 0
+            0x70, 0x01, // 206: ADD V0, 1
+            0x30, 0x00, // 208: SE V0, 0
+            0x12, 0x06, // 20A: JP 0x206
+            0x71, 0x01, // 20C: ADD V1, 1
+            0x31, 0x00, // 20E: SE V1, 0
+            0x12, 0x06, // 210: JP 0x206
+            0x72, 0x01, // 212: ADD V2, 1
+            0x32, 0x0A, // 214: SE V2, 10
+            0x12, 0x06, // 216: JP 0x206
+            0xA3, 0x00, // 218: LD I, 0x300
+            0xF2, 0x33, // 21A: LD B, V2
+            0x12, 0x1C, // 21C: JP 0x21C
+    };
+    const uint64_t hour = uint64_t(CYCLES_PER_FRAME) * FRAMES_PER_SECOND * 60 * 60;
+
+    chip8 machine;
+    programs::load(machine, program);
+    TimeTravelDebugger debugger(machine);
+
+    auto start = std::chrono::steady_clock::now();
+    debugger.run(hour);
+    auto end = std::chrono::steady_clock::now();
+    bench::report(bench::Result{"debugger_record", hour, std::chrono::duration<double>(end - start).count()});
+    std::cout << "debugger_memory: " << debugger.checkpointCount() << " checkpoints, "
+              << debugger.bytesUsed() / 1024 << " KiB" << std::endl;
+
+    timeOperation("debugger_reverse_step", [&]() {
+        return debugger.reverseStep();
+    });
+
+    debugger.seek(hour);
+    timeOperation("debugger_reverse_to_V2", [&]() {
+        return debugger.reverseToRegisterWrite(2);
+    });
+
+    debugger.seek(hour);
+    timeOperation("debugger_reverse_to_0x300", [&]() {
+        return debugger.reverseToMemoryWrite(0x300);
+    });
+
+    debugger.seek(hour);
+    timeOperation("debugger_reverse_to_unwritten_V5", [&]() {
+        return debugger.reverseToRegisterWrite(5);
+    });
+
+    timeOperation("debugger_first_reach_0x218", [&]() {
+        uint64_t cycle;
+        return debugger.firstReach(0x218, cycle);
+    });
+
+    std::mt19937_64 random(42);
+    timeOperation("debugger_random_seek", [&]() {
+        return debugger.seek(random() % hour);
+    });
+}
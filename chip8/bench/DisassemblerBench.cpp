@@ -0,0 +1,40 @@
+//
+// Created by david on 18-10-26.
+//
+
+#include <sstream>
+#include "Bench.h"
+#include "Programs.h"
+#include "../src/chip8.h"
+#include "../src/Disassembler/Disassembler.h"
+
+void benchAnnotate() {
+    // pc histogram of ten million instructions, written like Profiler's CSV
+    static uint64_t pcs[RAM_SIZE];
+    chip8 machine;
+    programs::load(machine, programs::counter());
+    for (uint64_t i = 0; i < 10000000; ++i) {
+        ++pcs[machine.programCounter() & 0x0FFF];
+        machine.emulateCycle();
+    }
+
+    std::ostringstream csv;
+    csv << "kind,key,count\n";
+    for (unsigned int pc = 0; pc < RAM_SIZE; ++pc) {
+        if (pcs[pc]) {
+            csv << "pc,0x" << std::hex << pc << std::dec << "," << pcs[pc] << "\n";
+        }
+    }
+    const std::string profile = csv.str();
+
+    Disassembler disassembler(machine.memory);
+    bench::report(bench::run("annotate_profile", 1000, [&]() {
+        static uint64_t histogram[RAM_SIZE];
+        std::istringstream in(profile);
+        Disassembler::readHistogram(in, histogram);
+
+        std::ostringstream out;
+        disassembler.annotate(out, histogram);
+        bench::keep(out);
+    }));
+}
@@ -0,0 +1,75 @@
+//
+// Created by david on 18-10-26.
+//
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include "Bench.h"
+#include "Programs.h"
+#include "../src/chip8.h"
+#include "../src/KeyChannel/KeyChannel.h"
+#include "../src/Timer.h"
+#include "../src/includes/globals.h"
+
+// One second of key changes, one every 2 ms
+static const unsigned int CHANGES = 500;
+static const std::chrono::microseconds CHANGE_PERIOD(2000);
+
+/**
+ * Send key changes from an input thread while the machine runs on this one and receives them polls times
+ * per frame, then print how long the changes waited
+ */
+static void measureLatency(const std::string & name, unsigned int polls) {
+    chip8 machine;
+    programs::load(machine, programs::counter());
+    KeyChannel channel;
+
+    std::atomic<bool> sending(true);
+    std::thread input([&channel, &sending]() {
+        for (unsigned int change = 0; change < CHANGES; ++change) {
+            channel.send((uint8_t) (change / 2 % 16), change % 2 == 0);
+            std::this_thread::sleep_for(CHANGE_PERIOD);
+        }
+        sending = false;
+    });
+
+    Timer timer(FRAMES_PER_SECOND * polls);
+    timer.start();
+    uint64_t poll = 0;
+    while (sending || channel.received() < CHANGES) {
+        ++poll;
+        machine.runUntil(poll * machine.cyclesPerFrame() / polls);
+        channel.receive([&machine](const KeyChannel::KeyEvent & event) {
+            machine.setKey(event.key, event.pressed);
+        });
+        timer.wait();
+    }
+    input.join();
+
+    bench::keep(machine.framebuffer());
+    std::cout << name << ": " << channel.received() << " changes, latency mean "
+              << std::chrono::duration<double, std::micro>(channel.meanLatency()).count() << " us, max "
+              << std::chrono::duration<double, std::micro>(channel.worstLatency()).count() << " us, dropped "
+              << channel.dropped() << std::endl;
+}
+
+void benchKeyChannel() {
+    // Cost of the queue itself, one thread sending and receiving
+    {
+        KeyChannel channel;
+        uint64_t change = 0;
+        unsigned int keys = 0;
+        bench::report(bench::run("input_send_receive", 1000000, [&]() {
+            channel.send((uint8_t) (change / 2 % 16), change % 2 == 0);
+            if (++change % 64 == 0) {
+                channel.receive([&keys](const KeyChannel::KeyEvent & event) { keys += event.key; });
+            }
+        }));
+        bench::keep(keys);
+    }
+
+    measureLatency("input_latency_per_frame", 1);
+    measureLatency("input_latency_quarter_frame", 4);
+}
@@ -0,0 +1,48 @@
+//
+// Created by david on 18-10-26.
+//
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include "Bench.h"
+#include "Programs.h"
+#include "../src/chip8.h"
+
+static const uint64_t CYCLES = 10000000;
+
+/**
+ * Time a program on one instantiation of Machine
+ */
+template<typename M>
+static void measure(const std::string & name, const std::vector<unsigned char> & program) {
+    M machine;
+    machine.initialize();
+    machine.loadProgram(program.data(), (int) program.size());
+    machine.runUntil(CYCLES / 10);
+
+    uint64_t start_cycle = machine.cycleCount();
+    auto start = std::chrono::steady_clock::now();
+    machine.runUntil(start_cycle + CYCLES);
+    auto end = std::chrono::steady_clock::now();
+    bench::keep(machine.framebuffer());
+    bench::report(bench::Result{name, CYCLES, std::chrono::duration<double>(end - start).count()});
+}
+
+void benchMachines() {
+    // Byte framebuffer and keypad, what the frontends run
+    measure<chip8>("machine_framebuffer_sprites", programs::sprites());
+    measure<chip8>("machine_framebuffer_counter", programs::counter());
+
+    // Nothing drawn, nothing pressed
+    measure<HeadlessMachine>("machine_headless_sprites", programs::sprites());
+    measure<HeadlessMachine>("machine_headless_counter", programs::counter());
+
+    // One bit per pixel
+    measure<PackedMachine>("machine_packed_sprites", programs::sprites());
+    measure<PackedMachine>("machine_packed_counter", programs::counter());
+
+    // Every memory access counted
+    measure<TracingMachine>("machine_tracing_sprites", programs::sprites());
+    measure<TracingMachine>("machine_tracing_counter", programs::counter());
+}
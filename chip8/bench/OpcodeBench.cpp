@@ -0,0 +1,133 @@
+//
+// Created by david on 18-10-26.
+//
+
+#include <chrono>
+#include <initializer_list>
+#include <string>
+#include <vector>
+#include "Bench.h"
+#include "Programs.h"
+#include "../src/chip8.h"
+
+static const uint64_t OPCODE_CYCLES = 4000000;
+static const uint64_t PROGRAM_CYCLES = 10000000;
+static const unsigned int COPIES = 1024;
+
+/**
+ * Build a program that runs setup once and then loops over COPIES copies of opcode, so nearly every
+ * executed instruction is the one being measured
+ */
+static std::vector<unsigned char> unrolled(std::initializer_list<uint16_t> setup, uint16_t opcode) {
+    std::vector<unsigned char> program;
+    auto emit = [&](uint16_t word) {
+        program.push_back((unsigned char) (word >> 8));
+        program.push_back((unsigned char) (word & 0xFF));
+    };
+
+    for (uint16_t word : setup) {
+        emit(word);
+    }
+    uint16_t loop = (uint16_t) (PROGRAM_START + program.size());
+    for (unsigned int i = 0; i < COPIES; ++i) {
+        emit(opcode);
+    }
+    emit((uint16_t) (0x1000 | loop));
+    return program;
+}
+
+/**
+ * Time cycles instructions of a program, reported per instruction
+ */
+static void measure(const std::string & name, const std::vector<unsigned char> & program, uint64_t cycles,
+                    QuirkProfile quirks = QUIRKS_MODERN) {
+    chip8 machine;
+    programs::load(machine, program);
+    machine.setQuirks(quirks);
+    // Past the setup and into a steady state
+    machine.runUntil(cycles / 10);
+
+    uint64_t start_cycle = machine.cycleCount();
+    auto start = std::chrono::steady_clock::now();
+    machine.runUntil(start_cycle + cycles);
+    auto end = std::chrono::steady_clock::now();
+    bench::report(bench::Result{name, cycles, std::chrono::duration<double>(end - start).count()});
+}
+
+static void measureOpcode(const std::string & name, std::initializer_list<uint16_t> setup, uint16_t opcode) {
+    measure("op_" + name, unrolled(setup, opcode), OPCODE_CYCLES);
+}
+
+void benchOpcodes() {
+    // Registers start at 0, the setups load V1 = 1 where a second operand matters
+    measureOpcode("00E0_cls", {}, 0x00E0);
+    measureOpcode("0nnn_sys", {}, 0x0123);
+    measureOpcode("3xkk_se_skip", {}, 0x3000);
+    measureOpcode("3xkk_se_no_skip", {}, 0x3001);
+    measureOpcode("4xkk_sne_skip", {}, 0x4001);
+    measureOpcode("5xy0_se", {0x6101}, 0x5010);
+    measureOpcode("6xkk_ld", {}, 0x6012);
+    measureOpcode("7xkk_add", {}, 0x7001);
+    measureOpcode("8xy0_ld", {0x6101}, 0x8010);
+    measureOpcode("8xy1_or", {0x6101}, 0x8011);
+    measureOpcode("8xy2_and", {0x6101}, 0x8012);
+    measureOpcode("8xy3_xor", {0x6101}, 0x8013);
+    measureOpcode("8xy4_add", {0x6101}, 0x8014);
+    measureOpcode("8xy5_sub", {0x6101}, 0x8015);
+    measureOpcode("8xy6_shr", {0x6101}, 0x8016);
+    measureOpcode("8xy7_subn", {0x6101}, 0x8017);
+    measureOpcode("8xyE_shl", {0x6101}, 0x801E);
+    measureOpcode("9xy0_sne", {0x6101}, 0x9010);
+    measureOpcode("Annn_ld_i", {}, 0xA300);
+    measureOpcode("Cxkk_rnd", {}, 0xC0FF);
+    measureOpcode("Ex9E_skp", {}, 0xE09E);
+    measureOpcode("ExA1_sknp", {}, 0xE0A1);
+    measureOpcode("Fx07_ld_dt", {}, 0xF007);
+    measureOpcode("Fx15_ld_dt", {}, 0xF015);
+    measureOpcode("Fx18_ld_st", {}, 0xF018);
+    measureOpcode("Fx1E_add_i", {}, 0xF01E);
+    measureOpcode("Fx29_ld_f", {0x600A}, 0xF029);
+
+    // Sprites from the font, drawn fully on screen and wrapping around the bottom right corner
+    const unsigned int heights[] = {1, 5, 8, 15};
+    for (unsigned int height : heights) {
+        measureOpcode("Dxyn_n" + std::to_string(height), {0xA000, 0x6008, 0x6108},
+                      (uint16_t) (0xD010 | height));
+        measureOpcode("Dxyn_n" + std::to_string(height) + "_wrap", {0xA000, 0x603C, 0x611E},
+                      (uint16_t) (0xD010 | height));
+    }
+
+    // Memory operations write beyond the program so they don't modify the code being run
+    measureOpcode("Fx33_ld_b", {0xAF00, 0x60FF}, 0xF033);
+    measureOpcode("Fx55_ld_i_v0", {0xAF00}, 0xF055);
+    measureOpcode("Fx55_ld_i_vf", {0xAF00}, 0xFF55);
+    measureOpcode("Fx65_ld_v0_i", {0xAF00}, 0xF065);
+    measureOpcode("Fx65_ld_vf_i", {0xAF00}, 0xFF65);
+
+    // Control flow can't be unrolled, so these loops are measured per instruction executed
+    measure("op_1nnn_jp", {0x12, 0x00}, OPCODE_CYCLES);
+    measure("op_Bnnn_jp_v0", {0xB2, 0x00}, OPCODE_CYCLES);
+    // 200: CALL 0x204, 202: JP 0x200, 204: RET
+    measure("op_2nnn_00EE_call_ret_jp", {0x22, 0x04, 0x12, 0x00, 0x00, 0xEE}, OPCODE_CYCLES);
+}
+
+void benchPrograms() {
+    measure("program_counter", programs::counter(), PROGRAM_CYCLES);
+    measure("program_sprites", programs::sprites(), PROGRAM_CYCLES);
+    measure("program_arithmetic", programs::arithmetic(), PROGRAM_CYCLES);
+    measure("program_memory", programs::memory(), PROGRAM_CYCLES);
+    measure("program_calls", programs::calls(), PROGRAM_CYCLES);
+}
+
+void benchQuirks() {
+    // Every profile runs its own instantiation of the interpreter, so they should all be as fast as modern.
+    // vip's display wait idles the rest of the frame after every sprite, its sprites figure is per
+    // instruction slot rather than per executed instruction
+    const QuirkProfile profiles[] = {QUIRKS_MODERN, QUIRKS_VIP, QUIRKS_SCHIP, QUIRKS_XOCHIP};
+    for (QuirkProfile profile : profiles) {
+        std::string prefix = std::string("quirks_") + quirksName(profile);
+        measure(prefix + "_sprites", programs::sprites(), PROGRAM_CYCLES, profile);
+        measure(prefix + "_arithmetic", programs::arithmetic(), PROGRAM_CYCLES, profile);
+        measure(prefix + "_memory", programs::memory(), PROGRAM_CYCLES, profile);
+    }
+}
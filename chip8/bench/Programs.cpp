@@ -0,0 +1,90 @@
+//
+// Created by david on 18-10-26.
+//
+
+#include "Programs.h"
+#include "../src/chip8.h"
+
+namespace programs {
+
+    const std::vector<unsigned char> & counter() {
+        static const std::vector<unsigned char> program = {
+                0x60, 0x00, // 200: LD V0, 0
+                0x61, 0x08, // 202: LD V1, 8
+                0xA3, 0x00, // 204: LD I, 0x300
+                0x70, 0x01, // 206: ADD V0, 1
+                0xF0, 0x33, // 208: LD B, V0
+                0xD0, 0x13, // 20A: DRW V0, V1, 3
+                0x12, 0x06, // 20C: JP 0x206
+        };
+        return program;
+    }
+
+    const std::vector<unsigned char> & sprites() {
+        static const std::vector<unsigned char> program = {
+                0x00, 0xE0, // 200: CLS
+                0xA0, 0x00, // 202: LD I, 0x000
+                0x60, 0x00, // 204: LD V0, 0
+                0x61, 0x00, // 206: LD V1, 0
+                0xD0, 0x15, // 208: DRW V0, V1, 5
+                0x70, 0x08, // 20A: ADD V0, 8
+                0x30, 0x40, // 20C: SE V0, 64
+                0x12, 0x08, // 20E: JP 0x208
+                0x60, 0x00, // 210: LD V0, 0
+                0x71, 0x06, // 212: ADD V1, 6
+                0x31, 0x1E, // 214: SE V1, 30
+                0x12, 0x08, // 216: JP 0x208
+                0x12, 0x00, // 218: JP 0x200
+        };
+        return program;
+    }
+
+    const std::vector<unsigned char> & arithmetic() {
+        static const std::vector<unsigned char> program = {
+                0x60, 0x01, // 200: LD V0, 1
+                0x61, 0x03, // 202: LD V1, 3
+                0x80, 0x14, // 204: ADD V0, V1
+                0x81, 0x05, // 206: SUB V1, V0
+                0x82, 0x06, // 208: SHR V2
+                0x80, 0x23, // 20A: XOR V0, V2
+                0x72, 0x07, // 20C: ADD V2, 7
+                0x83, 0x12, // 20E: AND V3, V1
+                0x33, 0x00, // 210: SE V3, 0
+                0x12, 0x04, // 212: JP 0x204
+                0x12, 0x04, // 214: JP 0x204
+        };
+        return program;
+    }
+
+    const std::vector<unsigned char> & memory() {
+        static const std::vector<unsigned char> program = {
+                0x60, 0x00, // 200: LD V0, 0
+                0xA4, 0x00, // 202: LD I, 0x400
+                0xF0, 0x33, // 204: LD B, V0
+                0xF3, 0x55, // 206: LD [I], V3
+                0xF3, 0x65, // 208: LD V3, [I]
+                0x70, 0x13, // 20A: ADD V0, 0x13
+                0x12, 0x02, // 20C: JP 0x202
+        };
+        return program;
+    }
+
+    const std::vector<unsigned char> & calls() {
+        static const std::vector<unsigned char> program = {
+                0x22, 0x06, // 200: CALL 0x206
+                0x70, 0x01, // 202: ADD V0, 1
+                0x12, 0x00, // 204: JP 0x200
+                0x22, 0x0C, // 206: CALL 0x20C
+                0x71, 0x01, // 208: ADD V1, 1
+                0x00, 0xEE, // 20A: RET
+                0x72, 0x01, // 20C: ADD V2, 1
+                0x00, 0xEE, // 20E: RET
+        };
+        return program;
+    }
+
+    void load(chip8 & machine, const std::vector<unsigned char> & program) {
+        machine.initialize();
+        machine.loadProgram(program.data(), (int) program.size());
+    }
+}
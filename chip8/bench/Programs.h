@@ -0,0 +1,47 @@
+//
+// Created by david on 18-10-26.
+//
+
+#ifndef CHIP8_PROGRAMS_H
+#define CHIP8_PROGRAMS_H
+
+#include <vector>
+
+class chip8;
+
+namespace programs {
+
+    /**
+     * Counts in V0, stores its BCD representation and draws it, so every frame writes some memory
+     * and a few framebuffer rows
+     */
+    const std::vector<unsigned char> & counter();
+
+    /**
+     * Clears the screen and fills it with a grid of 40 sprites, over and over
+     */
+    const std::vector<unsigned char> & sprites();
+
+    /**
+     * Tight loop of register arithmetic, logic and shifts
+     */
+    const std::vector<unsigned char> & arithmetic();
+
+    /**
+     * BCD conversion and register stores and loads to a fixed buffer, I is reloaded every iteration so
+     * profiles where Fx55/Fx65 move it stay in the buffer
+     */
+    const std::vector<unsigned char> & memory();
+
+    /**
+     * Two levels of subroutine calls
+     */
+    const std::vector<unsigned char> & calls();
+
+    /**
+     * Initialize a machine and load a program into it
+     */
+    void load(chip8 & machine, const std::vector<unsigned char> & program);
+}
+
+#endif //CHIP8_PROGRAMS_H
@@ -0,0 +1,95 @@
+//
+// Created by david on 18-10-26.
+//
+
+#include <cstdio>
+#include <random>
+#include "Bench.h"
+#include "Programs.h"
+#include "../src/chip8.h"
+#include "../src/Replay/Recorder.h"
+#include "../src/Replay/ReplayFile.h"
+
+void benchReplay() {
+    const std::vector<unsigned char> & program = programs::counter();
+    const uint64_t frames = 60 * 60 * 60;
+
+    // Record an hour of play with a key event every few frames
+    chip8 recorded;
+    programs::load(recorded, program);
+    Recorder recorder(recorded, 1234, fnv1a(program.data(), program.size()));
+
+    std::mt19937 random(42);
+    for (uint64_t frame = 0; frame < frames; ++frame) {
+        if (random() % 8 == 0) {
+            uint8_t key = (uint8_t) (random() % 16);
+            recorder.setKey(key, !((recorded.keyState() >> key) & 1));
+        }
+        recorded.runFrame();
+    }
+    const InputLog & log = recorder.finish();
+
+    chip8 replayed;
+    auto start = std::chrono::steady_clock::now();
+    programs::load(replayed, program);
+    Replayer replayer(log);
+    replayer.start(replayed);
+    replayer.runToEnd(replayed);
+    auto end = std::chrono::steady_clock::now();
+
+    bench::Result result{"replay_hour", log.end_cycle, std::chrono::duration<double>(end - start).count()};
+    bench::report(result);
+    std::cout << "replay_hour_check: " << log.events.size() << " events, " << result.seconds << " s, "
+              << (recorded.snapshot().hash() == replayed.snapshot().hash() ? "identical" : "DIVERGED")
+              << std::endl;
+}
+
+void benchReplayFile() {
+    const std::vector<unsigned char> & program = programs::counter();
+    const uint64_t frames = 60 * 60 * 60;
+    const char * path = "bench_replay.c8r";
+
+    // Frame time while recording to a file, against the same run without recording
+    chip8 plain;
+    programs::load(plain, program);
+    bench::report(bench::run("frame_unrecorded", frames, [&]() {
+        plain.runFrame();
+    }));
+
+    chip8 recorded;
+    programs::load(recorded, program);
+    std::mt19937 random(42);
+    {
+        ReplayWriter writer(path, 1234, fnv1a(program.data(), program.size()), recorded.quirks(), recorded.timing(),
+                            CYCLES_PER_FRAME * FRAMES_PER_SECOND * 10);
+        Recorder recorder(recorded, 1234, fnv1a(program.data(), program.size()), &writer);
+
+        auto start = std::chrono::steady_clock::now();
+        for (uint64_t frame = 0; frame < frames; ++frame) {
+            if (random() % 8 == 0) {
+                uint8_t key = (uint8_t) (random() % 16);
+                recorder.setKey(key, !((recorded.keyState() >> key) & 1));
+            }
+            recorded.runFrame();
+            recorder.frame();
+        }
+        auto end = std::chrono::steady_clock::now();
+        recorder.finish();
+        bench::report(bench::Result{"frame_recorded", frames, std::chrono::duration<double>(end - start).count()});
+    }
+
+    // Jump to minute 45 of the hour, in between two keyframes
+    chip8 replayed;
+    programs::load(replayed, program);
+    ReplayReader reader(path);
+    const uint64_t target = CYCLES_PER_FRAME * FRAMES_PER_SECOND * (60 * 45 + 7);
+    bench::report(bench::run("replay_seek_45min", 100, [&]() {
+        reader.seek(replayed, target);
+    }));
+
+    reader.runToEnd(replayed);
+    std::cout << "replay_seek_check: " << reader.keyframes().size() << " keyframes, "
+              << (recorded.snapshot().hash() == replayed.snapshot().hash() ? "identical" : "DIVERGED")
+              << std::endl;
+    std::remove(path);
+}
@@ -0,0 +1,56 @@
+//
+// Created by david on 18-10-26.
+//
+
+#include <random>
+#include "Bench.h"
+#include "Programs.h"
+#include "../src/chip8.h"
+#include "../src/Rewind/RewindBuffer.h"
+
+void benchRewind() {
+    chip8 machine;
+    programs::load(machine, programs::counter());
+
+    // Ten minutes of frames don't fit in 4 MB, so this also covers eviction
+    RewindBuffer rewind(4, 60);
+    const int frames = 60 * 60 * 10;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < frames; ++frame) {
+        machine.runFrame();
+        rewind.capture(machine);
+    }
+    auto end = std::chrono::steady_clock::now();
+    bench::report(bench::Result{"rewind_capture", (uint64_t) frames,
+                                std::chrono::duration<double>(end - start).count()});
+
+    std::cout << "rewind_history: " << rewind.frameCount() << " frames ("
+              << rewind.frameCount() / FRAMES_PER_SECOND << " s) in " << rewind.bytesUsed() / 1024 << " KB of "
+              << rewind.capacity() / 1024 << " KB" << std::endl;
+
+    // The frame right before a keyframe needs the most deltas applied
+    uint64_t worst = rewind.newestFrame();
+    while ((worst + 1) % 60 != 0) {
+        --worst;
+    }
+
+    // Decoding plus restoring is what a restore costs, without dropping the newer frames
+    Snapshot snapshot;
+    bench::report(bench::run("rewind_restore_worst", 20000, [&]() {
+        rewind.decode(worst, snapshot);
+        machine.restore(snapshot);
+    }));
+
+    bench::report(bench::run("rewind_restore_keyframe", 20000, [&]() {
+        rewind.decode(worst + 1 - 60, snapshot);
+        machine.restore(snapshot);
+    }));
+
+    std::mt19937 random(42);
+    std::uniform_int_distribution<uint64_t> frame(rewind.oldestFrame(), rewind.newestFrame());
+    bench::report(bench::run("rewind_restore_random", 20000, [&]() {
+        rewind.decode(frame(random), snapshot);
+        machine.restore(snapshot);
+    }));
+}
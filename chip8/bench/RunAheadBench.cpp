@@ -0,0 +1,22 @@
+//
+// Created by david on 18-10-26.
+//
+
+#include <string>
+#include "Bench.h"
+#include "Programs.h"
+#include "../src/chip8.h"
+#include "../src/RunAhead/RunAhead.h"
+
+void benchRunAhead() {
+    // Host CPU time per presented frame at every run-ahead depth, 0 is plain emulation
+    for (unsigned int depth = 0; depth <= 4; ++depth) {
+        chip8 machine;
+        programs::load(machine, programs::counter());
+        RunAhead runAhead(depth);
+
+        bench::report(bench::run("run_ahead_" + std::to_string(depth), 100000, [&]() {
+            bench::keep(runAhead.frame(machine));
+        }));
+    }
+}
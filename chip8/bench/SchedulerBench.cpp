@@ -0,0 +1,55 @@
+//
+// Created by david on 18-10-26.
+//
+
+#include <chrono>
+#include <string>
+#include "Bench.h"
+#include "Programs.h"
+#include "../src/chip8.h"
+#include "../src/Scheduler/Scheduler.h"
+
+static const uint64_t CYCLES = 10000000;
+
+/**
+ * Time CYCLES instructions run through a scheduler holding periodic events, each due every period cycles
+ */
+static void measure(const std::string & name, unsigned int events, uint64_t period) {
+    chip8 machine;
+    programs::load(machine, programs::counter());
+
+    Scheduler scheduler;
+    for (unsigned int i = 0; i < events; ++i) {
+        scheduler.schedule(i, period, period);
+    }
+    uint64_t handled = 0;
+    auto count = [&handled](const Scheduler::Event &) {
+        ++handled;
+        return true;
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    scheduler.run(machine, CYCLES, count);
+    auto end = std::chrono::steady_clock::now();
+    bench::keep(handled);
+    bench::report(bench::Result{name, CYCLES, std::chrono::duration<double>(end - start).count()});
+}
+
+void benchScheduler() {
+    // Straight runUntil, the baseline
+    {
+        chip8 machine;
+        programs::load(machine, programs::counter());
+        auto start = std::chrono::steady_clock::now();
+        machine.runUntil(CYCLES);
+        auto end = std::chrono::steady_clock::now();
+        bench::report(bench::Result{"scheduler_none", CYCLES, std::chrono::duration<double>(end - start).count()});
+    }
+
+    // What the SDL frontend schedules, a few events per frame
+    measure("scheduler_frame_events", 3, CYCLES_PER_FRAME);
+
+    // A crowded heap, and an event after every instruction as the worst case
+    measure("scheduler_64_events", 64, CYCLES_PER_FRAME);
+    measure("scheduler_every_cycle", 1, 1);
+}
@@ -0,0 +1,79 @@
+//
+// Created by david on 18-10-26.
+//
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Bench.h"
+#include "Programs.h"
+#include "../src/chip8.h"
+#include "../src/Session/SessionExecutor.h"
+#include "../src/includes/globals.h"
+
+static const size_t SESSIONS = 1000;
+static const uint64_t FRAMES = 120;
+
+/**
+ * Waits for a key, forever: LD V0, K; JP 0x200
+ */
+static const std::vector<unsigned char> KEY_WAIT = {0xF0, 0x0A, 0x12, 0x00};
+
+/**
+ * Report the time per session frame and how many such sessions one core keeps at 60 fps
+ */
+static void report(const std::string & name, double seconds) {
+    bench::Result result{name, SESSIONS * FRAMES, seconds};
+    bench::report(result);
+    std::cout << name << ": " << (uint64_t) (1e9 / FRAMES_PER_SECOND / result.nanosPerOp())
+              << " sessions per core at " << FRAMES_PER_SECOND << " fps" << std::endl;
+}
+
+/**
+ * Run SESSIONS machines for FRAMES frames on one executor
+ * @param waiting Every how many-th machine waits on Fx0A instead of counting, 0 for none
+ */
+static void measure(const std::string & name, size_t waiting) {
+    std::unique_ptr<chip8[]> machines(new chip8[SESSIONS]);
+    SessionExecutor executor;
+    for (size_t i = 0; i < SESSIONS; ++i) {
+        programs::load(machines[i], waiting && i % waiting == 0 ? KEY_WAIT : programs::counter());
+        executor.add(machines[i]);
+    }
+    for (int frame = 0; frame < 10; ++frame) {
+        executor.runFrame();
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t frame = 0; frame < FRAMES; ++frame) {
+        executor.runFrame();
+    }
+    auto end = std::chrono::steady_clock::now();
+    bench::keep(machines[SESSIONS - 1].framebuffer());
+    report(name, std::chrono::duration<double>(end - start).count());
+}
+
+void benchSessions() {
+    // The same frames without coroutines, the cost of a resume is the difference
+    {
+        std::unique_ptr<chip8[]> machines(new chip8[SESSIONS]);
+        for (size_t i = 0; i < SESSIONS; ++i) {
+            programs::load(machines[i], programs::counter());
+        }
+        auto start = std::chrono::steady_clock::now();
+        for (uint64_t frame = 0; frame < FRAMES; ++frame) {
+            for (size_t i = 0; i < SESSIONS; ++i) {
+                machines[i].runFrame();
+            }
+        }
+        auto end = std::chrono::steady_clock::now();
+        bench::keep(machines[SESSIONS - 1].framebuffer());
+        report("sessions_plain_loop", std::chrono::duration<double>(end - start).count());
+    }
+
+    measure("sessions_counter", 0);
+
+    // Half of the machines parked on Fx0A
+    measure("sessions_half_waiting", 2);
+}
@@ -0,0 +1,78 @@
+//
+// Created by david on 18-10-26.
+//
+
+#include <sstream>
+#include <vector>
+#include "Bench.h"
+#include "Programs.h"
+#include "../src/chip8.h"
+
+void benchSnapshot() {
+    chip8 machine;
+    machine.initialize();
+
+    // Something other than zeroes in every region of memory
+    unsigned char program[MEMORY_SIZE];
+    for (int i = 0; i < MEMORY_SIZE; ++i) {
+        program[i] = (unsigned char) (i * 31 + 7);
+    }
+    machine.loadProgram(program, MEMORY_SIZE);
+
+    Snapshot snapshot;
+    bench::report(bench::run("snapshot", 1000000, [&]() {
+        machine.snapshot(snapshot);
+        bench::keep(snapshot);
+    }));
+
+    bench::report(bench::run("restore", 1000000, [&]() {
+        machine.restore(snapshot);
+        bench::keep(machine);
+    }));
+
+    std::stringstream disk;
+    bench::report(bench::run("snapshot_write", 100000, [&]() {
+        disk.seekp(0);
+        snapshot.write(disk);
+    }));
+
+    bench::report(bench::run("snapshot_read", 100000, [&]() {
+        disk.seekg(0);
+        Snapshot::read(disk, snapshot);
+        bench::keep(snapshot);
+    }));
+}
+
+void benchPagedSnapshot() {
+    // The store has to outlive the machine and the snapshots
+    PageStore store;
+
+    chip8 machine;
+    programs::load(machine, programs::counter());
+
+    const int snapshotCount = 10000;
+    std::vector<PagedSnapshot> snapshots(snapshotCount);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < snapshotCount; ++i) {
+        for (int cycle = 0; cycle < 12; ++cycle) {
+            machine.emulateCycle();
+        }
+        machine.snapshot(snapshots[i], store);
+    }
+    auto end = std::chrono::steady_clock::now();
+    bench::report(bench::Result{"paged_snapshot", (uint64_t) snapshotCount,
+                                std::chrono::duration<double>(end - start).count()});
+
+    size_t paged = store.bytesAllocated() + snapshotCount * sizeof(PagedSnapshot);
+    size_t flat = snapshotCount * sizeof(Snapshot);
+    std::cout << "paged_snapshot_memory: " << snapshotCount << " snapshots, " << store.pageCount() << " pages, "
+              << paged / 1024 << " KB paged vs " << flat / 1024 << " KB flat" << std::endl;
+
+    size_t index = 0;
+    bench::report(bench::run("paged_restore", 100000, [&]() {
+        machine.restore(snapshots[index]);
+        index = (index + 1) % snapshotCount;
+        bench::keep(machine);
+    }));
+}
@@ -0,0 +1,54 @@
+//
+// Created by david on 18-10-26.
+//
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Bench.h"
+#include "../src/Timer.h"
+#include "../src/includes/globals.h"
+
+// Two seconds of frames per pacing method
+static const unsigned int FRAMES = FRAMES_PER_SECOND * 2;
+
+/**
+ * Pace FRAMES frames and print how far the frame intervals were off the 60 Hz period
+ */
+template<typename Wait>
+static void measure(const std::string & name, Wait && wait) {
+    const double period = 1e6 / FRAMES_PER_SECOND;
+    std::vector<double> jitter;
+    jitter.reserve(FRAMES);
+
+    auto last = std::chrono::steady_clock::now();
+    auto first = last;
+    for (unsigned int frame = 0; frame < FRAMES; ++frame) {
+        wait();
+        auto now = std::chrono::steady_clock::now();
+        jitter.push_back(std::fabs(std::chrono::duration<double, std::micro>(now - last).count() - period));
+        last = now;
+    }
+    double drift = std::chrono::duration<double, std::micro>(last - first).count() - FRAMES * period;
+
+    std::sort(jitter.begin(), jitter.end());
+    std::cout << name << ": jitter p50 " << jitter[FRAMES / 2] << " us, p99 " << jitter[FRAMES * 99 / 100]
+              << " us, max " << jitter.back() << " us, drift " << drift << " us" << std::endl;
+}
+
+void benchTimer() {
+    // What the frame loop used to do
+    measure("pacing_sleep_for", []() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1000 / FRAMES_PER_SECOND));
+    });
+
+    Timer timer(FRAMES_PER_SECOND);
+    measure("pacing_timer", [&timer]() {
+        timer.wait();
+    });
+    std::cout << "pacing_timer: " << timer.missed() << " missed deadlines, worst lateness "
+              << std::chrono::duration<double, std::micro>(timer.worstLateness()).count() << " us" << std::endl;
+}
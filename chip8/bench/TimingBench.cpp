@@ -0,0 +1,57 @@
+//
+// Created by david on 18-10-26.
+//
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include "Bench.h"
+#include "Programs.h"
+#include "../src/chip8.h"
+
+// An hour of play
+static const uint64_t FRAMES = FRAMES_PER_SECOND * 60 * 60;
+
+/**
+ * Time FRAMES frames of a program in a timing model, reported per executed instruction
+ */
+static void measure(const std::string & name, const std::vector<unsigned char> & program, TimingMode timing,
+                    QuirkProfile quirks = QUIRKS_MODERN) {
+    chip8 machine;
+    programs::load(machine, program);
+    machine.setQuirks(quirks);
+    machine.setTiming(timing);
+    uint64_t end = FRAMES * machine.cyclesPerFrame();
+
+    // Cycles aren't instructions in every model, count them on a copy one instruction at a time
+    chip8 counter;
+    programs::load(counter, program);
+    counter.setQuirks(quirks);
+    counter.setTiming(timing);
+    uint64_t instructions = 0;
+    while (counter.cycleCount() < end) {
+        counter.emulateCycle();
+        ++instructions;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    machine.runUntil(end);
+    auto stop = std::chrono::steady_clock::now();
+    bench::keep(machine.framebuffer());
+    bench::report(bench::Result{name, instructions, std::chrono::duration<double>(stop - start).count()});
+}
+
+void benchTiming() {
+    // The cost table lookup against one cycle per instruction, same programs and quirks
+    measure("timing_fixed_counter", programs::counter(), TIMING_FIXED);
+    measure("timing_vip_counter", programs::counter(), TIMING_VIP);
+    measure("timing_fixed_arithmetic", programs::arithmetic(), TIMING_FIXED);
+    measure("timing_vip_arithmetic", programs::arithmetic(), TIMING_VIP);
+    measure("timing_fixed_memory", programs::memory(), TIMING_FIXED);
+    measure("timing_vip_memory", programs::memory(), TIMING_VIP);
+    measure("timing_fixed_sprites", programs::sprites(), TIMING_FIXED);
+    measure("timing_vip_sprites", programs::sprites(), TIMING_VIP);
+
+    // The whole VIP model, sprites wait for the display interrupt
+    measure("timing_vip_display_wait_sprites", programs::sprites(), TIMING_VIP, QUIRKS_VIP);
+}
@@ -0,0 +1,33 @@
+//
+// Created by david on 18-10-26.
+//
+
+#include "Bench.h"
+#include "Programs.h"
+#include "../src/chip8.h"
+#include "../src/RunAhead/RunAhead.h"
+#include "../src/Trace/Trace.h"
+
+void benchTrace() {
+    // A frame as the timer loop runs it, with tracing off and on
+    chip8 machine;
+    programs::load(machine, programs::counter());
+    RunAhead runAhead(1);
+
+    auto frame = [&]() {
+        TRACE_SPAN("frame");
+        const unsigned char * pixels;
+        {
+            TRACE_SPAN("execute");
+            pixels = runAhead.frame(machine);
+        }
+        bench::keep(pixels);
+    };
+
+    trace::stop();
+    bench::report(bench::run("frame_trace_off", 200000, frame));
+
+    trace::start();
+    bench::report(bench::run("frame_trace_on", 200000, frame));
+    trace::stop();
+}
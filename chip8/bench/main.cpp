@@ -0,0 +1,73 @@
+//
+// Created by david on 18-10-26.
+//
+
+#include <fstream>
+#include <string>
+#include <vector>
+#include "Bench.h"
+
+struct Suite {
+    const char * name;
+    void (* run)();
+};
+
+static const Suite SUITES[] = {
+        {"snapshot", benchSnapshot},
+        {"paged_snapshot", benchPagedSnapshot},
+        {"rewind", benchRewind},
+        {"replay", benchReplay},
+        {"replay_file", benchReplayFile},
+        {"run_ahead", benchRunAhead},
+        {"debugger", benchDebugger},
+        {"debug_policy", benchDebugPolicy},
+        {"annotate", benchAnnotate},
+        {"trace", benchTrace},
+        {"opcodes", benchOpcodes},
+        {"programs", benchPrograms},
+        {"quirks", benchQuirks},
+        {"machines", benchMachines},
+        {"scheduler", benchScheduler},
+        {"timing", benchTiming},
+        {"pacing", benchTimer},
+        {"sessions", benchSessions},
+        {"input", benchKeyChannel},
+};
+
+/**
+ * chip8-bench [--json file] [suite...]
+ * Runs the named suites, or all of them, and optionally writes the results as JSON
+ */
+int main(int argc, char **argv) {
+    const char * jsonPath = nullptr;
+    std::vector<std::string> selected;
+    for (int i = 1; i < argc; ++i) {
+        std::string argument = argv[i];
+        if (argument == "--json" && i + 1 < argc) {
+            jsonPath = argv[++i];
+        } else {
+            selected.push_back(argument);
+        }
+    }
+
+    for (const Suite & suite : SUITES) {
+        bool run = selected.empty();
+        for (const std::string & name : selected) {
+            run = run || name == suite.name;
+        }
+        if (run) {
+            suite.run();
+        }
+    }
+
+    if (jsonPath) {
+        std::ofstream out(jsonPath, std::ios::out | std::ios::trunc);
+        bench::writeJson(out);
+        if (!out) {
+            std::cerr << "Could not write " << jsonPath << std::endl;
+            return 1;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,42 @@
+//
+// Created by david on 18-10-26.
+//
+
+#include "DebugPolicy.h"
+
+DebugPolicy::DebugPolicy():
+        breakpoints(), watchpoints(), watched_registers(), stop_reason( STOP_NONE ), stop_address(),
+        stop_pending() {}
+
+void DebugPolicy::watchRegister(unsigned int reg, bool set) {
+    if (set) {
+        watched_registers |= 1u << reg;
+    } else {
+        watched_registers &= ~(1u << reg);
+    }
+}
+
+void DebugPolicy::setRegisterHook(RegisterHook hook) {
+    register_hook = std::move(hook);
+}
+
+void DebugPolicy::clear() {
+    for (unsigned int i = 0; i < 4096 / 64; ++i) {
+        breakpoints[i] = 0;
+        watchpoints[i] = 0;
+    }
+    watched_registers = 0;
+    register_hook = nullptr;
+    stop_reason = STOP_NONE;
+    stop_address = 0;
+    stop_pending = false;
+}
+
+void DebugPolicy::setBit(uint64_t * bitmap, unsigned short address, bool set) {
+    address &= 0x0FFF;
+    if (set) {
+        bitmap[address >> 6] |= uint64_t(1) << (address & 63);
+    } else {
+        bitmap[address >> 6] &= ~(uint64_t(1) << (address & 63));
+    }
+}
@@ -0,0 +1,157 @@
+//
+// Created by david on 18-10-26.
+//
+
+#ifndef CHIP8_DEBUGPOLICY_H
+#define CHIP8_DEBUGPOLICY_H
+
+#include <cstdint>
+#include <functional>
+
+/**
+ * Debug policies are the template argument of chip8::runUntil(cycle, debug). The interpreter calls
+ *
+ *   bool breakpoint(pc)                         before every instruction, true stops before it
+ *   void memoryWrite(address, length, pc)       for every store into memory
+ *   void registerWrite(reg, before, after)      for every register an instruction changed
+ *   bool takeStop()                             after every instruction, true stops after it
+ *
+ * and only does so, or keeps the register values needed for registerWrite(), if ENABLED is true.
+ */
+
+/**
+ * Policy without any hooks, everything compiles away. This is what the plain interpreter runs with.
+ */
+struct NullDebugPolicy {
+    static const bool ENABLED = false;
+
+    bool breakpoint(unsigned short) const { return false; }
+    void memoryWrite(unsigned short, unsigned int, unsigned short) {}
+    void registerWrite(unsigned int, uint16_t, uint16_t) {}
+    bool takeStop() { return false; }
+};
+
+/**
+ * Breakpoints on pc, watchpoints on memory bytes and hooks on register changes.
+ * Breakpoints and watchpoints are bitmaps over all 4096 addresses, so checking one is a shift and a mask
+ * no matter how many are set.
+ */
+class DebugPolicy {
+public:
+    static const bool ENABLED = true;
+
+    /**
+     * Register number of I, V0 to VF are 0 to 15
+     */
+    static const unsigned int REGISTER_I = 16;
+
+    enum StopReason : uint8_t {
+        STOP_NONE,
+        STOP_BREAKPOINT,
+        STOP_WATCHPOINT,
+        STOP_REGISTER,
+    };
+
+    typedef std::function<void(unsigned int reg, uint16_t before, uint16_t after)> RegisterHook;
+
+    DebugPolicy();
+
+    /**
+     * Stop before executing the instruction at an address
+     */
+    void setBreakpoint(unsigned short address, bool set = true) {
+        setBit(breakpoints, address, set);
+    }
+
+    /**
+     * Stop after an instruction that stored into a memory byte
+     */
+    void setWatchpoint(unsigned short address, bool set = true) {
+        setBit(watchpoints, address, set);
+    }
+
+    /**
+     * Stop after an instruction that changed a register
+     * @param reg 0 to 15 for V0 to VF, REGISTER_I for I
+     */
+    void watchRegister(unsigned int reg, bool set = true);
+
+    /**
+     * Set the function that is called for every register change, may be empty
+     */
+    void setRegisterHook(RegisterHook hook);
+
+    /**
+     * Remove all breakpoints, watchpoints, watched registers and the register hook, and forget why the last
+     * run stopped
+     */
+    void clear();
+
+    /**
+     * @return Why the last run stopped early
+     */
+    StopReason stopReason() const { return stop_reason; }
+
+    /**
+     * @return Address of the breakpoint or watchpoint, or the register number, that stopped the last run
+     */
+    unsigned short stopAddress() const { return stop_address; }
+
+    inline bool breakpoint(unsigned short pc) {
+        if (!testBit(breakpoints, pc)) {
+            return false;
+        }
+        stop(STOP_BREAKPOINT, pc);
+        return true;
+    }
+
+    inline void memoryWrite(unsigned short address, unsigned int length, unsigned short) {
+        for (unsigned int i = 0; i < length; ++i) {
+            if (testBit(watchpoints, (unsigned short) (address + i))) {
+                stop(STOP_WATCHPOINT, (unsigned short) ((address + i) & 0x0FFF));
+                stop_pending = true;
+            }
+        }
+    }
+
+    inline void registerWrite(unsigned int reg, uint16_t before, uint16_t after) {
+        if (register_hook) {
+            register_hook(reg, before, after);
+        }
+        if ((watched_registers >> reg) & 1u) {
+            stop(STOP_REGISTER, (unsigned short) reg);
+            stop_pending = true;
+        }
+    }
+
+    inline bool takeStop() {
+        bool pending = stop_pending;
+        stop_pending = false;
+        return pending;
+    }
+
+private:
+    uint64_t breakpoints[4096 / 64];
+    uint64_t watchpoints[4096 / 64];
+    uint32_t watched_registers;
+    RegisterHook register_hook;
+
+    StopReason stop_reason;
+    unsigned short stop_address;
+    bool stop_pending;
+
+    static inline bool testBit(const uint64_t * bitmap, unsigned short address) {
+        address &= 0x0FFF;
+        return (bitmap[address >> 6] >> (address & 63)) & 1u;
+    }
+
+    static void setBit(uint64_t * bitmap, unsigned short address, bool set);
+
+    void stop(StopReason reason, unsigned short address) {
+        stop_reason = reason;
+        stop_address = address;
+    }
+};
+
+
+#endif //CHIP8_DEBUGPOLICY_H
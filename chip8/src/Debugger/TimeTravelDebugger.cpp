@@ -0,0 +1,366 @@
+//
+// Created by david on 18-10-26.
+//
+
+#include <algorithm>
+#include "TimeTravelDebugger.h"
+#include "../chip8.h"
+
+TimeTravelDebugger::Segment::Segment(PageStore & store):
+        cycle(), event_index(), state( store ), pcs(), memory_writes(), register_writes() {}
+
+TimeTravelDebugger::TimeTravelDebugger(chip8 & machine, uint64_t checkpointInterval):
+        machine( machine ), checkpoint_interval( checkpointInterval ? checkpointInterval : machine.cyclesPerFrame() * FRAMES_PER_SECOND ), newest_cycle( machine.cycleCount() ),
+        next_event( 0 ) {
+    checkpoint();
+}
+
+TimeTravelDebugger::~TimeTravelDebugger() {
+    // The machine's page cache points into our store
+    machine.releasePages();
+}
+
+uint64_t TimeTravelDebugger::position() const {
+    return machine.cycleCount();
+}
+
+size_t TimeTravelDebugger::bytesUsed() const {
+    return store.bytesAllocated() + segments.capacity() * sizeof(Segment) + events.capacity() * sizeof(InputEvent);
+}
+
+void TimeTravelDebugger::setKey(uint8_t key, bool pressed) {
+    if (machine.cycleCount() < newest_cycle) {
+        truncate();
+    }
+
+    InputEvent event = {machine.cycleCount(), key, (uint8_t) pressed, {}};
+    events.push_back(event);
+    ++next_event;
+    machine.setKey(key, pressed);
+}
+
+bool TimeTravelDebugger::step() {
+    if (machine.fault() != chip8::FAULT_NONE) {
+        return false;
+    }
+
+    if (machine.cycleCount() < newest_cycle) {
+        machine.runUntil(machine.cycleCount() + 1);
+        applyEvents();
+        return true;
+    }
+
+    execute(segments.back());
+    newest_cycle = machine.cycleCount();
+    if (newest_cycle - segments.back().cycle >= checkpoint_interval) {
+        checkpoint();
+    }
+    return true;
+}
+
+uint64_t TimeTravelDebugger::run(uint64_t maxCycles) {
+    uint64_t executed = 0;
+    while (executed < maxCycles && step()) {
+        ++executed;
+    }
+    return executed;
+}
+
+bool TimeTravelDebugger::seek(uint64_t cycle) {
+    if (cycle < firstCycle() || cycle > newest_cycle) {
+        return false;
+    }
+
+    uint64_t current = machine.cycleCount();
+    if (cycle >= current && cycle - current <= checkpoint_interval) {
+        // Closer than any checkpoint could be
+        forwardTo(cycle);
+    } else {
+        replay(segmentAt(cycle), cycle);
+    }
+    return true;
+}
+
+bool TimeTravelDebugger::reverseStep() {
+    // Instructions can take more than one cycle, the last one to start before the current cycle is found
+    // by running forward to it
+    return reverseTo(
+            [](const Segment &) {
+                return true;
+            },
+            []() {
+                return true;
+            });
+}
+
+bool TimeTravelDebugger::reverseToRegisterWrite(unsigned int reg) {
+    uint32_t mask = 1u << reg;
+    return reverseTo(
+            [mask](const Segment & segment) {
+                return (segment.register_writes & mask) != 0;
+            },
+            [this, mask]() {
+                uint32_t registers;
+                unsigned short address;
+                decodeWrites(registers, address);
+                return (registers & mask) != 0;
+            });
+}
+
+bool TimeTravelDebugger::reverseToMemoryWrite(unsigned short address) {
+    address &= 0x0FFF;
+    return reverseTo(
+            [address](const Segment & segment) {
+                return (segment.memory_writes[address >> 6] >> (address & 63)) & 1u;
+            },
+            [this, address]() {
+                uint32_t registers;
+                unsigned short first;
+                unsigned int length = decodeWrites(registers, first);
+                return ((address - first) & 0x0FFF) < length;
+            });
+}
+
+bool TimeTravelDebugger::firstReach(unsigned short address, uint64_t & cycle) {
+    address &= 0x0FFF;
+    uint64_t current = machine.cycleCount();
+
+    for (size_t segment = 0; segment < segments.size(); ++segment) {
+        if (!((segments[segment].pcs[address >> 6] >> (address & 63)) & 1u)) {
+            continue;
+        }
+
+        uint64_t found = scan(segment, segmentEnd(segment), true, [this, address]() {
+            return (machine.programCounter() & 0x0FFF) == address;
+        });
+        if (found != NOT_FOUND) {
+            // scan() stopped right there
+            cycle = found;
+            return true;
+        }
+    }
+
+    seek(current);
+    return false;
+}
+
+bool TimeTravelDebugger::reverseTo(const std::function<bool(const Segment &)> & candidate,
+                                   const std::function<bool()> & match) {
+    uint64_t current = machine.cycleCount();
+    if (current <= firstCycle()) {
+        return false;
+    }
+
+    for (size_t segment = segmentAt(current - 1) + 1; segment-- > 0;) {
+        // Summaries say what a segment may do, only re-executing it tells when
+        if (!candidate(segments[segment])) {
+            continue;
+        }
+
+        uint64_t found = scan(segment, std::min(segmentEnd(segment), current), false, match);
+        if (found != NOT_FOUND) {
+            seek(found);
+            return true;
+        }
+    }
+
+    seek(current);
+    return false;
+}
+
+uint64_t TimeTravelDebugger::scan(size_t segment, uint64_t end, bool first, const std::function<bool()> & match) {
+    replay(segment, segments[segment].cycle);
+
+    uint64_t found = NOT_FOUND;
+    while (machine.cycleCount() < end) {
+        if (match()) {
+            found = machine.cycleCount();
+            if (first) {
+                break;
+            }
+        }
+        machine.runUntil(machine.cycleCount() + 1);
+        applyEvents();
+    }
+    return found;
+}
+
+void TimeTravelDebugger::checkpoint() {
+    segments.emplace_back(store);
+    Segment & segment = segments.back();
+    segment.cycle = machine.cycleCount();
+    segment.event_index = next_event;
+    machine.snapshot(segment.state, store);
+}
+
+void TimeTravelDebugger::replay(size_t segment, uint64_t cycle) {
+    machine.restore(segments[segment].state);
+    next_event = segments[segment].event_index;
+    applyEvents();
+    forwardTo(cycle);
+}
+
+void TimeTravelDebugger::forwardTo(uint64_t cycle) {
+    while (machine.cycleCount() < cycle) {
+        // Run in one go up to the next key event
+        uint64_t stop = cycle;
+        if (next_event < events.size() && events[next_event].cycle < stop) {
+            stop = events[next_event].cycle;
+        }
+        machine.runUntil(stop);
+        applyEvents();
+    }
+}
+
+void TimeTravelDebugger::applyEvents() {
+    while (next_event < events.size() && events[next_event].cycle <= machine.cycleCount()) {
+        machine.setKey(events[next_event].key, events[next_event].pressed != 0);
+        ++next_event;
+    }
+}
+
+void TimeTravelDebugger::execute(Segment & segment) {
+    unsigned short pc = machine.programCounter() & 0x0FFF;
+    segment.pcs[pc >> 6] |= uint64_t(1) << (pc & 63);
+
+    uint32_t registers;
+    unsigned short address;
+    unsigned int length = decodeWrites(registers, address);
+    segment.register_writes |= registers;
+    for (unsigned int i = 0; i < length; ++i) {
+        unsigned short byte = (address + i) & 0x0FFF;
+        segment.memory_writes[byte >> 6] |= uint64_t(1) << (byte & 63);
+    }
+
+    machine.runUntil(machine.cycleCount() + 1);
+}
+
+void TimeTravelDebugger::truncate() {
+    uint64_t cycle = machine.cycleCount();
+
+    events.resize(next_event);
+    while (segments.back().cycle > cycle) {
+        segments.pop_back();
+    }
+    newest_cycle = cycle;
+
+    // The summary of the last segment still covers the dropped cycles, build it again
+    Segment & last = segments.back();
+    std::fill(std::begin(last.pcs), std::end(last.pcs), 0);
+    std::fill(std::begin(last.memory_writes), std::end(last.memory_writes), 0);
+    last.register_writes = 0;
+
+    machine.restore(last.state);
+    next_event = last.event_index;
+    applyEvents();
+    while (machine.cycleCount() < cycle) {
+        execute(last);
+        applyEvents();
+    }
+}
+
+size_t TimeTravelDebugger::segmentAt(uint64_t cycle) const {
+    auto after = std::upper_bound(segments.begin(), segments.end(), cycle,
+                                  [](uint64_t c, const Segment & segment) { return c < segment.cycle; });
+    return (size_t) (after - segments.begin()) - 1;
+}
+
+uint64_t TimeTravelDebugger::segmentEnd(size_t segment) const {
+    return segment + 1 < segments.size() ? segments[segment + 1].cycle : newest_cycle;
+}
+
+/**
+ * decodeWrites() for one quirk profile
+ */
+template<typename Quirks>
+static unsigned int decodeWrites(unsigned short opcode, unsigned short I, uint32_t & registers,
+                                 unsigned short & address) {
+    const uint32_t REGISTER_I = 1u << TimeTravelDebugger::REGISTER_I;
+    unsigned int x = (opcode & 0x0F00u) >> 8;
+
+    registers = 0;
+    address = 0;
+    switch (opcode & 0xF000) {
+        case 0x6000:
+        case 0x7000:
+        case 0xC000:
+            registers = 1u << x;
+            break;
+        case 0x8000:
+            registers = 1u << x;
+            switch (opcode & 0x000F) {
+                case 0x1:
+                case 0x2:
+                case 0x3:
+                    if (Quirks::LOGIC_RESETS_VF) {
+                        registers |= 1u << 0xF;
+                    }
+                    break;
+                case 0x4:
+                case 0x5:
+                case 0x6:
+                case 0x7:
+                case 0xE:
+                    registers |= 1u << 0xF;
+                    break;
+                default:
+                    break;
+            }
+            break;
+        case 0xA000:
+            registers = REGISTER_I;
+            break;
+        case 0xD000:
+            registers = 1u << 0xF;
+            break;
+        case 0xF000:
+            switch (opcode & 0x00FF) {
+                case 0x07:
+                case 0x0A:
+                    registers = 1u << x;
+                    break;
+                case 0x1E:
+                case 0x29:
+                    registers = REGISTER_I;
+                    break;
+                case 0x65:
+                    registers = (2u << x) - 1;
+                    if (Quirks::LOAD_STORE_INCREMENTS_I) {
+                        registers |= REGISTER_I;
+                    }
+                    break;
+                case 0x33:
+                    address = I;
+                    return 3;
+                case 0x55:
+                    if (Quirks::LOAD_STORE_INCREMENTS_I) {
+                        registers = REGISTER_I;
+                    }
+                    address = I;
+                    return x + 1;
+                default:
+                    break;
+            }
+            break;
+        default:
+            break;
+    }
+    return 0;
+}
+
+unsigned int TimeTravelDebugger::decodeWrites(uint32_t & registers, unsigned short & address) const {
+    unsigned short opcode = machine.memory.getOpcode(machine.programCounter());
+    unsigned short I = machine.indexRegister();
+
+    // What an instruction writes depends on the profile the machine runs with
+    switch (machine.quirks()) {
+        case QUIRKS_VIP:
+            return ::decodeWrites<VipQuirks>(opcode, I, registers, address);
+        case QUIRKS_SCHIP:
+            return ::decodeWrites<SchipQuirks>(opcode, I, registers, address);
+        case QUIRKS_XOCHIP:
+            return ::decodeWrites<XochipQuirks>(opcode, I, registers, address);
+        default:
+            return ::decodeWrites<ModernQuirks>(opcode, I, registers, address);
+    }
+}
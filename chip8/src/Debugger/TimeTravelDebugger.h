@@ -0,0 +1,202 @@
+//
+// Created by david on 18-10-26.
+//
+
+#ifndef CHIP8_TIMETRAVELDEBUGGER_H
+#define CHIP8_TIMETRAVELDEBUGGER_H
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include "../PagedSnapshot.h"
+#include "../Replay/InputLog.h"
+#include "../includes/globals.h"
+
+class chip8;
+
+/**
+ * Reverse debugger.
+ *
+ * While the program runs forward the debugger takes a paged snapshot every checkpoint interval and logs
+ * every key event, so any earlier cycle can be reached by restoring the checkpoint before it and
+ * re-executing deterministically. Every segment between two checkpoints also keeps a summary of what
+ * its instructions did: the addresses executed and the registers and memory bytes written. Reverse
+ * searches only re-execute the segments whose summary can contain the answer, which keeps them in the
+ * milliseconds even on hour-long runs.
+ *
+ * The machine must only be driven through the debugger while it is attached.
+ */
+class TimeTravelDebugger {
+public:
+    /**
+     * Register number of I in register searches, V0 to VF are 0 to 15
+     */
+    static const unsigned int REGISTER_I = 16;
+
+    /**
+     * A constructor
+     * Takes the first checkpoint at the machine's current cycle, which is as far back as it can go
+     * @param machine Machine to debug
+     * @param checkpointInterval Cycles between checkpoints, 0 for one emulated second of the machine's timing model
+     */
+    explicit TimeTravelDebugger(chip8 & machine, uint64_t checkpointInterval = 0);
+
+    ~TimeTravelDebugger();
+
+    /**
+     * Press or release a key at the current cycle.
+     * When the debugger is behind the newest recorded cycle, the recorded future is dropped.
+     */
+    void setKey(uint8_t key, bool pressed);
+
+    /**
+     * Execute one instruction, recording it when at the newest recorded cycle
+     * @return False if the machine is faulted, nothing is executed then
+     */
+    bool step();
+
+    /**
+     * Step until the program faults
+     * @param maxCycles Maximum number of instructions to execute
+     * @return Number of instructions executed
+     */
+    uint64_t run(uint64_t maxCycles);
+
+    /**
+     * Move to a recorded cycle
+     * @param cycle Cycle between the first checkpoint and the newest recorded cycle
+     * @return False if the cycle wasn't recorded
+     */
+    bool seek(uint64_t cycle);
+
+    /**
+     * Move back one instruction
+     * @return False at the first checkpoint
+     */
+    bool reverseStep();
+
+    /**
+     * Move back to the last instruction before the current cycle that wrote a register, stopping before
+     * it executes
+     * @param reg 0 to 15 for V0 to VF, REGISTER_I for I
+     * @return False if there is no such instruction, the position is unchanged then
+     */
+    bool reverseToRegisterWrite(unsigned int reg);
+
+    /**
+     * Move back to the last instruction before the current cycle that wrote a memory byte, stopping
+     * before it executes
+     * @param address Address of the byte
+     * @return False if there is no such instruction, the position is unchanged then
+     */
+    bool reverseToMemoryWrite(unsigned short address);
+
+    /**
+     * Move to the first recorded cycle at which the program counter was at an address
+     * @param address Address to look for
+     * @param cycle Set to the cycle found
+     * @return False if the address was never executed, the position is unchanged then
+     */
+    bool firstReach(unsigned short address, uint64_t & cycle);
+
+    /**
+     * @return Cycle the machine is at
+     */
+    uint64_t position() const;
+
+    /**
+     * @return Newest recorded cycle
+     */
+    uint64_t frontier() const { return newest_cycle; }
+
+    uint64_t firstCycle() const { return segments.front().cycle; }
+
+    size_t checkpointCount() const { return segments.size(); }
+
+    /**
+     * @return Approximate bytes used by checkpoints, summaries and events
+     */
+    size_t bytesUsed() const;
+
+private:
+    /**
+     * Cycles from one checkpoint up to the next, with a summary of the instructions executed in them
+     */
+    struct Segment {
+        uint64_t cycle; // Cycle of the checkpoint
+        size_t event_index; // First event that isn't in the checkpoint
+        PagedSnapshot state;
+        uint64_t pcs[RAM_SIZE / 64]; // Addresses executed, one bit each
+        uint64_t memory_writes[RAM_SIZE / 64]; // Bytes written, one bit each
+        uint32_t register_writes; // V0 to VF, I in bit REGISTER_I
+
+        explicit Segment(PageStore & store);
+    };
+
+    chip8 & machine;
+    uint64_t checkpoint_interval;
+
+    // Must outlive the segments and the machine's page cache
+    PageStore store;
+    std::vector<Segment> segments;
+    std::vector<InputEvent> events;
+
+    uint64_t newest_cycle;
+    size_t next_event; // First event that hasn't been applied to the machine
+
+    static const uint64_t NOT_FOUND = ~uint64_t(0);
+
+    void checkpoint();
+
+    /**
+     * Restore a checkpoint and re-execute up to a cycle, applying the logged events on the way
+     */
+    void replay(size_t segment, uint64_t cycle);
+
+    void forwardTo(uint64_t cycle);
+
+    void applyEvents();
+
+    /**
+     * Move back to the last instruction before the current cycle that matches
+     * @param candidate Whether a segment's summary allows a match in it
+     * @param match Whether the instruction at the program counter matches
+     * @return False if nothing matches, the position is unchanged then
+     */
+    bool reverseTo(const std::function<bool(const Segment &)> & candidate, const std::function<bool()> & match);
+
+    /**
+     * Re-execute a segment from its checkpoint up to a cycle, looking for a matching instruction
+     * @param first Stop at the first match instead of looking for the last one
+     * @return Cycle of the match, NOT_FOUND if nothing matched
+     */
+    uint64_t scan(size_t segment, uint64_t end, bool first, const std::function<bool()> & match);
+
+    /**
+     * Execute one instruction, adding it to a segment's summary
+     */
+    void execute(Segment & segment);
+
+    /**
+     * Drop everything recorded after the current cycle
+     */
+    void truncate();
+
+    /**
+     * @return Index of the segment containing cycle
+     */
+    size_t segmentAt(uint64_t cycle) const;
+
+    uint64_t segmentEnd(size_t segment) const;
+
+    /**
+     * Decode the instruction at the program counter
+     * @param registers Set to the bitmap of registers the instruction writes
+     * @param address Set to the first memory byte the instruction writes
+     * @return Number of memory bytes the instruction writes
+     */
+    unsigned int decodeWrites(uint32_t & registers, unsigned short & address) const;
+};
+
+
+#endif //CHIP8_TIMETRAVELDEBUGGER_H
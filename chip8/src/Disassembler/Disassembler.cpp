@@ -2,21 +2,262 @@
 // Created by david on 11-10-19.
 //
 
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include "Disassembler.h"
 
 Disassembler::Disassembler(Memory memory): memory( memory ) {}
 
-void Disassembler::disassemble(std::ofstream& outFile)
+void Disassembler::disassemble(std::ostream & outFile)
 {
-    //TODO: implement Disassembler::disassemble
-    uint16_t opCode;
-    int result;
+    int last = RAM_SIZE - 1;
+    while (last >= PROGRAM_START && memory.read((unsigned int) last) == 0) {
+        --last;
+    }
+
+    char line[64];
+    for (int address = PROGRAM_START; address <= last; address += 2) {
+        uint16_t opcode = memory.getOpcode((unsigned int) address);
+        std::snprintf(line, sizeof(line), "0x%03X  %04X  ", address, opcode);
+        outFile << line << instruction(opcode) << "\n";
+    }
+}
 
-    for (int i = 0; i < this->memory.size; ++i) {
+std::vector<Disassembler::Block> Disassembler::blocks(const uint64_t * pcs) const {
+    // Jump and call targets and the instructions after a skipped one start a block
+    std::vector<bool> targets(RAM_SIZE);
+    for (unsigned int address = 0; address < RAM_SIZE; ++address) {
+        if (pcs[address] == 0) {
+            continue;
+        }
+        uint16_t opcode = memory.getOpcode(address);
+        switch (opcode & 0xF000) {
+            case 0x1000:
+            case 0x2000:
+                targets[opcode & 0x0FFF] = true;
+                break;
+            case 0x3000:
+            case 0x4000:
+            case 0x5000:
+            case 0x9000:
+            case 0xE000:
+                targets[(address + 4) & 0x0FFF] = true;
+                break;
+            default:
+                break;
+        }
+    }
+
+    std::vector<Block> result;
+    bool open = false;
+    for (unsigned int address = 0; address < RAM_SIZE; ++address) {
+        if (pcs[address] == 0) {
+            continue;
+        }
 
+        if (open) {
+            Block & block = result.back();
+            if (address == block.end + 2u && !targets[address] && pcs[address] == pcs[block.end]
+                    && !endsBlock(memory.getOpcode(block.end))) {
+                block.end = (unsigned short) address;
+                block.executions += pcs[address];
+                continue;
+            }
+        }
+
+        result.push_back(Block{(unsigned short) address, (unsigned short) address, pcs[address], pcs[address]});
+        open = true;
     }
+
+    std::stable_sort(result.begin(), result.end(), [](const Block & a, const Block & b) {
+        return a.executions > b.executions;
+    });
+    return result;
 }
 
-int Disassembler::opCodeToInstruction(uint16_t *buffer) {
-    //TODO: implement Disassembler::opCodeToInstruction
-}
\ No newline at end of file
+void Disassembler::annotate(std::ostream & out, const uint64_t * pcs, size_t maxBlocks) const {
+    uint64_t total = 0;
+    for (unsigned int address = 0; address < RAM_SIZE; ++address) {
+        total += pcs[address];
+    }
+
+    std::vector<Block> hot = blocks(pcs);
+    out << "; " << total << " instructions executed in " << hot.size() << " blocks\n";
+    if (total == 0) {
+        return;
+    }
+
+    if (maxBlocks == 0 || maxBlocks > hot.size()) {
+        maxBlocks = hot.size();
+    }
+
+    char line[128];
+    for (size_t i = 0; i < maxBlocks; ++i) {
+        const Block & block = hot[i];
+        std::snprintf(line, sizeof(line), "\n; block 0x%03X-0x%03X: %u instructions, entered %llu times, %.2f%%\n",
+                      block.start, block.end, (block.end - block.start) / 2u + 1,
+                      (unsigned long long) block.entries, 100.0 * block.executions / total);
+        out << line;
+
+        for (unsigned int address = block.start; address <= block.end; address += 2) {
+            uint16_t opcode = memory.getOpcode(address);
+            std::snprintf(line, sizeof(line), "0x%03X  %04X  %-18s %12llu  %6.2f%%\n", address, opcode,
+                          instruction(opcode).c_str(), (unsigned long long) pcs[address],
+                          100.0 * pcs[address] / total);
+            out << line;
+        }
+    }
+}
+
+bool Disassembler::endsBlock(uint16_t opcode) {
+    switch (opcode & 0xF000) {
+        case 0x0000:
+            return opcode == 0x00EE;
+        case 0x1000:
+        case 0x2000:
+        case 0x3000:
+        case 0x4000:
+        case 0x5000:
+        case 0x9000:
+        case 0xB000:
+        case 0xE000:
+            return true;
+        default:
+            return false;
+    }
+}
+
+std::string Disassembler::instruction(uint16_t opcode) {
+    unsigned int x = (opcode >> 8) & 0x0F;
+    unsigned int y = (opcode >> 4) & 0x0F;
+    unsigned int n = opcode & 0x0F;
+    unsigned int kk = opcode & 0xFF;
+    unsigned int nnn = opcode & 0x0FFF;
+
+    char text[32];
+    switch (opcode & 0xF000) {
+        case 0x0000:
+            if (opcode == 0x00E0) {
+                return "CLS";
+            }
+            if (opcode == 0x00EE) {
+                return "RET";
+            }
+            std::snprintf(text, sizeof(text), "SYS 0x%03X", nnn);
+            break;
+        case 0x1000:
+            std::snprintf(text, sizeof(text), "JP 0x%03X", nnn);
+            break;
+        case 0x2000:
+            std::snprintf(text, sizeof(text), "CALL 0x%03X", nnn);
+            break;
+        case 0x3000:
+            std::snprintf(text, sizeof(text), "SE V%X, 0x%02X", x, kk);
+            break;
+        case 0x4000:
+            std::snprintf(text, sizeof(text), "SNE V%X, 0x%02X", x, kk);
+            break;
+        case 0x5000:
+            if (n != 0) {
+                goto unknown;
+            }
+            std::snprintf(text, sizeof(text), "SE V%X, V%X", x, y);
+            break;
+        case 0x6000:
+            std::snprintf(text, sizeof(text), "LD V%X, 0x%02X", x, kk);
+            break;
+        case 0x7000:
+            std::snprintf(text, sizeof(text), "ADD V%X, 0x%02X", x, kk);
+            break;
+        case 0x8000: {
+            static const char * const names[16] = {
+                    "LD", "OR", "AND", "XOR", "ADD", "SUB", "SHR", "SUBN",
+                    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, "SHL", nullptr,
+            };
+            if (!names[n]) {
+                goto unknown;
+            }
+            std::snprintf(text, sizeof(text), "%s V%X, V%X", names[n], x, y);
+            break;
+        }
+        case 0x9000:
+            if (n != 0) {
+                goto unknown;
+            }
+            std::snprintf(text, sizeof(text), "SNE V%X, V%X", x, y);
+            break;
+        case 0xA000:
+            std::snprintf(text, sizeof(text), "LD I, 0x%03X", nnn);
+            break;
+        case 0xB000:
+            std::snprintf(text, sizeof(text), "JP V0, 0x%03X", nnn);
+            break;
+        case 0xC000:
+            std::snprintf(text, sizeof(text), "RND V%X, 0x%02X", x, kk);
+            break;
+        case 0xD000:
+            std::snprintf(text, sizeof(text), "DRW V%X, V%X, %u", x, y, n);
+            break;
+        case 0xE000:
+            if (kk == 0x9E) {
+                std::snprintf(text, sizeof(text), "SKP V%X", x);
+            } else if (kk == 0xA1) {
+                std::snprintf(text, sizeof(text), "SKNP V%X", x);
+            } else {
+                goto unknown;
+            }
+            break;
+        default:
+            switch (kk) {
+                case 0x07: std::snprintf(text, sizeof(text), "LD V%X, DT", x); break;
+                case 0x0A: std::snprintf(text, sizeof(text), "LD V%X, K", x); break;
+                case 0x15: std::snprintf(text, sizeof(text), "LD DT, V%X", x); break;
+                case 0x18: std::snprintf(text, sizeof(text), "LD ST, V%X", x); break;
+                case 0x1E: std::snprintf(text, sizeof(text), "ADD I, V%X", x); break;
+                case 0x29: std::snprintf(text, sizeof(text), "LD F, V%X", x); break;
+                case 0x33: std::snprintf(text, sizeof(text), "LD B, V%X", x); break;
+                case 0x55: std::snprintf(text, sizeof(text), "LD [I], V%X", x); break;
+                case 0x65: std::snprintf(text, sizeof(text), "LD V%X, [I]", x); break;
+                default: goto unknown;
+            }
+            break;
+    }
+    return text;
+
+    unknown:
+    std::snprintf(text, sizeof(text), "DW 0x%04X", opcode);
+    return text;
+}
+
+bool Disassembler::readHistogram(std::istream & in, uint64_t * pcs) {
+    std::memset(pcs, 0, RAM_SIZE * sizeof(uint64_t));
+
+    // CSV rows look like "pc,0x200,12", JSON members like "0x200": 12 and are the only keys starting with 0x
+    bool found = false;
+    std::string line;
+    while (std::getline(in, line)) {
+        const char * text = line.c_str();
+        while (*text == ' ' || *text == '\t') {
+            ++text;
+        }
+
+        if (std::strncmp(text, "pc,0x", 5) == 0) {
+            text += 5;
+        } else if (std::strncmp(text, "\"0x", 3) == 0) {
+            text += 3;
+        } else {
+            continue;
+        }
+
+        char * rest;
+        unsigned long address = std::strtoul(text, &rest, 16);
+        while (*rest == '"' || *rest == ':' || *rest == ',' || *rest == ' ') {
+            ++rest;
+        }
+        pcs[address & (RAM_SIZE - 1)] = std::strtoull(rest, nullptr, 10);
+        found = true;
+    }
+    return found;
+}
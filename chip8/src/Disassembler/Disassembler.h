@@ -5,16 +5,73 @@
 #ifndef CHIP8_DISASSEMBLER_H
 #define CHIP8_DISASSEMBLER_H
 
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
 #include "../Memory.h"
 
-//TODO: Use Disassembler and Memory
+/**
+ * Disassembles a program, optionally annotated with how often every instruction was executed.
+ */
 class Disassembler {
-private:
-    Memory memory;
-    int opCodeToInstruction(uint16_t * buffer);
 public:
+    /**
+     * Straight-line code between two control flow boundaries
+     */
+    struct Block {
+        unsigned short start; // Address of the first instruction
+        unsigned short end; // Address of the last instruction
+        uint64_t entries; // Executions of the first instruction
+        uint64_t executions; // Executions of all instructions in the block
+    };
+
     explicit Disassembler(Memory memory);
-    void disassemble(std::ofstream& outFile);
+
+    /**
+     * Write a plain listing of the program, from PROGRAM_START to its last non-zero byte
+     */
+    void disassemble(std::ostream & outFile);
+
+    /**
+     * Write the executed code as basic blocks, hottest block first, every instruction with its execution
+     * count and its share of all executed instructions
+     * @param out Stream to write to
+     * @param pcs Executions per address, RAM_SIZE entries
+     * @param maxBlocks Number of blocks to list, 0 lists all of them
+     */
+    void annotate(std::ostream & out, const uint64_t * pcs, size_t maxBlocks = 0) const;
+
+    /**
+     * Split the executed code into basic blocks. A block ends at every jump, call, return or skip, before
+     * every jump target, and wherever the execution count changes, which is where control entered or left
+     * in between.
+     * @param pcs Executions per address, RAM_SIZE entries
+     * @return Blocks sorted by executions, hottest first
+     */
+    std::vector<Block> blocks(const uint64_t * pcs) const;
+
+    /**
+     * @return Assembly for an opcode, e.g. "LD V0, 0x12"
+     */
+    static std::string instruction(uint16_t opcode);
+
+    /**
+     * Read the pc histogram from a profile written by Profiler, JSON or CSV
+     * @param in Profile
+     * @param pcs Set to the executions per address, RAM_SIZE entries
+     * @return False if the profile didn't contain any pc counts
+     */
+    static bool readHistogram(std::istream & in, uint64_t * pcs);
+
+private:
+    Memory memory;
+
+    /**
+     * @return Whether the instruction can continue anywhere else than at the next one
+     */
+    static bool endsBlock(uint16_t opcode);
 };
 
 
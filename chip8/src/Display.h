@@ -0,0 +1,118 @@
+//
+// Created by david on 18-10-26.
+//
+
+#ifndef CHIP8_DISPLAY_H
+#define CHIP8_DISPLAY_H
+
+#include <cstdint>
+#include <cstring>
+#include "includes/globals.h"
+
+/**
+ * Display policies of Machine. A display has to provide
+ *   void clear();
+ *   bool drawRow(unsigned int x, unsigned int y, uint8_t bits, unsigned int columns);
+ *   const unsigned char * frame() const;
+ * All calls are resolved at compile time, so a display is free to inline or drop them.
+ */
+
+/**
+ * One byte per pixel, what snapshots and the frontends work with
+ */
+struct FrameBuffer {
+    unsigned char pixels[SCREEN_WIDTH * SCREEN_HEIGHT]; // 1 for a lit pixel
+    uint64_t dirty_rows; // Rows written since the owner last cleared this
+
+    FrameBuffer(): pixels(), dirty_rows( ~uint64_t(0) ) {}
+
+    void clear() {
+        memset(pixels, 0, sizeof(pixels));
+        dirty_rows = ~uint64_t(0);
+    }
+
+    /**
+     * XOR a row of a sprite onto the screen
+     * @param x First column, wraps around the right edge
+     * @param y Row, less than SCREEN_HEIGHT
+     * @param bits Sprite row, the most significant bit is the leftmost pixel
+     * @param columns Pixels of bits to draw, counted from the left
+     * @return Whether a lit pixel was erased
+     */
+    inline bool drawRow(unsigned int x, unsigned int y, uint8_t bits, unsigned int columns) {
+        bool collision = false;
+        unsigned char * row = pixels + y * SCREEN_WIDTH;
+        for (unsigned int i = 0; i < columns; ++i) {
+            if ((bits & (0x80 >> i)) != 0) {
+                unsigned char & target = row[(x + i) % SCREEN_WIDTH];
+                if (target == 1)
+                    collision = true;
+                target ^= 1;
+            }
+        }
+        // One framebuffer page per row
+        dirty_rows |= uint64_t(1) << y;
+        return collision;
+    }
+
+    /**
+     * @return SCREEN_WIDTH * SCREEN_HEIGHT pixels, one byte each
+     */
+    const unsigned char * frame() const { return pixels; }
+};
+
+/**
+ * One bit per pixel, a sprite row is drawn with a rotate, an AND and an XOR
+ */
+struct PackedDisplay {
+    uint64_t rows[SCREEN_HEIGHT]; // The most significant bit is the leftmost pixel
+
+    PackedDisplay(): rows(), unpacked() {}
+
+    void clear() {
+        memset(rows, 0, sizeof(rows));
+    }
+
+    inline bool drawRow(unsigned int x, unsigned int y, uint8_t bits, unsigned int columns) {
+        uint64_t sprite = (uint64_t) (bits & (uint8_t) (0xFF00 >> columns)) << (SCREEN_WIDTH - 8);
+        // Rotating wraps the pixels that fall off the right edge around to the left
+        if (x != 0) {
+            sprite = sprite >> x | sprite << (SCREEN_WIDTH - x);
+        }
+        bool collision = (rows[y] & sprite) != 0;
+        rows[y] ^= sprite;
+        return collision;
+    }
+
+    /**
+     * Unpack the frame to one byte per pixel, valid until the next call
+     */
+    const unsigned char * frame() const {
+        for (unsigned int y = 0; y < SCREEN_HEIGHT; ++y) {
+            for (unsigned int x = 0; x < SCREEN_WIDTH; ++x) {
+                unpacked[y * SCREEN_WIDTH + x] = (unsigned char) ((rows[y] >> (SCREEN_WIDTH - 1 - x)) & 1);
+            }
+        }
+        return unpacked;
+    }
+
+private:
+    mutable unsigned char unpacked[SCREEN_WIDTH * SCREEN_HEIGHT];
+};
+
+/**
+ * Nothing is drawn and sprites never collide, for running programs whose output doesn't matter.
+ * Programs that test VF after Dxyn take other branches than they would on a real display.
+ */
+struct NullDisplay {
+    void clear() {}
+
+    inline bool drawRow(unsigned int, unsigned int, uint8_t, unsigned int) { return false; }
+
+    const unsigned char * frame() const {
+        static const unsigned char blank[SCREEN_WIDTH * SCREEN_HEIGHT] = {};
+        return blank;
+    }
+};
+
+#endif //CHIP8_DISPLAY_H
@@ -0,0 +1,317 @@
+//
+// Created by david on 18-10-26.
+//
+
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include "SdlFrontend.h"
+#include "../chip8.h"
+#include "../Replay/Recorder.h"
+#include "../Trace/Trace.h"
+
+/**
+ * CHIP-8 key of each key of the left hand side of a QWERTY keyboard, laid out like the hex keypad:
+ *   1 2 3 4      1 2 3 C
+ *   Q W E R  ->  4 5 6 D
+ *   A S D F      7 8 9 E
+ *   Z X C V      A 0 B F
+ */
+static const struct {
+    SDL_Keycode sym;
+    uint8_t key;
+} KEYMAP[] = {
+        {SDLK_1, 0x1}, {SDLK_2, 0x2}, {SDLK_3, 0x3}, {SDLK_4, 0xC},
+        {SDLK_q, 0x4}, {SDLK_w, 0x5}, {SDLK_e, 0x6}, {SDLK_r, 0xD},
+        {SDLK_a, 0x7}, {SDLK_s, 0x8}, {SDLK_d, 0x9}, {SDLK_f, 0xE},
+        {SDLK_z, 0xA}, {SDLK_x, 0x0}, {SDLK_c, 0xB}, {SDLK_v, 0xF},
+};
+
+SdlFrontend::SdlFrontend(chip8 & machine, SDL_Window * screen): machine( machine ), frame_timer( FRAMES_PER_SECOND ), screen( screen ), renderer( nullptr ), recorder( nullptr ), stats_overlay( false ), fault_reported( false ), frame_ready_event( SDL_RegisterEvents(2) ), trace_dump_event( frame_ready_event + 1 ), quitting( false ), frame_pending( false ), trace_dump_pending( false ), next_frame(), next_frame_times(), shown_frame(), shown_frame_times() {
+    if (screen) {
+        renderer = SDL_CreateRenderer(screen, -1, SDL_RENDERER_ACCELERATED);
+        if (!renderer) {
+            // No GPU, e.g. on a remote display
+            renderer = SDL_CreateRenderer(screen, -1, SDL_RENDERER_SOFTWARE);
+        }
+    }
+    if (renderer) {
+        // Draw in CHIP-8 pixels, SDL scales them up to the window
+        SDL_RenderSetLogicalSize(renderer, SCREEN_WIDTH, SCREEN_HEIGHT);
+    }
+}
+
+SdlFrontend::~SdlFrontend() {
+    if (renderer) {
+        SDL_DestroyRenderer(renderer);
+    }
+}
+
+void SdlFrontend::run()
+{
+    quitting = false;
+    std::thread emulation(&SdlFrontend::emulate, this);
+
+    // SDL's event queue and the renderer belong to the thread that created the window
+    pollInput();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        quitting = true;
+    }
+    wakeup.notify_one();
+    emulation.join();
+}
+
+void SdlFrontend::emulate()
+{
+    // Frame loop events fire at frame boundaries, where the timers tick
+    uint64_t frame = machine.cyclesPerFrame();
+    uint64_t frame_end = (machine.cycleCount() / frame + 1) * frame;
+    stats.setCyclesPerFrame(frame);
+    scheduler.clear();
+    scheduler.schedule(EVENT_VBLANK, frame_end, frame);
+    scheduler.schedule(EVENT_POLL, frame_end, frame);
+    scheduler.schedule(EVENT_PUBLISH_STATS, frame_end + (FRAMES_PER_SECOND - 1) * frame, FRAMES_PER_SECOND * frame);
+
+    frame_timer.start();
+    scheduler.run(machine, Scheduler::NEVER, [this](const Scheduler::Event & event) {
+        return handle(event);
+    });
+}
+
+bool SdlFrontend::handle(const Scheduler::Event & event) {
+    switch (event.id) {
+        case EVENT_VBLANK: {
+            {
+                TRACE_SPAN("frame");
+                {
+                    TRACE_SPAN("sleep");
+                    frame_timer.wait();
+                }
+
+                if (recorder) {
+                    recorder->frame();
+                }
+                publishFrame(run_ahead.ahead(machine));
+                stats.frame(machine.cycleCount(), machine.instructionCount(), trace::now());
+                stats.setMissedDeadlines(frame_timer.missed());
+            }
+
+            if (machine.waitingForKey() && key_channel.empty()) {
+                idle();
+            }
+            receiveKeys();
+            return !quitting;
+        }
+
+        case EVENT_POLL:
+            poll();
+            break;
+
+        case EVENT_PUBLISH_STATS:
+            stats_exporter.publish(stats);
+            break;
+
+        default:
+            break;
+    }
+    return true;
+}
+
+void SdlFrontend::publishFrame(const unsigned char * frame) {
+    bool notify;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        memcpy(next_frame, frame, sizeof(next_frame));
+        if (stats_overlay) {
+            for (unsigned int age = 0; age < SCREEN_WIDTH / 2; ++age) {
+                next_frame_times[age] = stats.frameTime(age);
+            }
+        }
+        notify = !frame_pending;
+        frame_pending = true;
+    }
+
+    // One event in the queue at a time, a frame the window thread is late for is replaced, not queued
+    if (notify) {
+        SDL_Event ready = {};
+        ready.type = frame_ready_event;
+        SDL_PushEvent(&ready);
+    }
+}
+
+void SdlFrontend::receiveKeys() {
+    TRACE_SPAN("input");
+    key_channel.receive([this](const KeyChannel::KeyEvent & event) {
+        if (recorder) {
+            recorder->setKey(event.key, event.pressed);
+        } else {
+            machine.setKey(event.key, event.pressed);
+        }
+    });
+}
+
+void SdlFrontend::idle() {
+    {
+        TRACE_SPAN("idle");
+        std::unique_lock<std::mutex> lock(mutex);
+        wakeup.wait(lock, [this]() { return !key_channel.empty() || quitting; });
+    }
+
+    // Every deadline slept through is a frame the machine spent waiting, not a dropped frame
+    stats.wake(trace::now());
+    uint64_t skipped = frame_timer.skip();
+    if (skipped > 0) {
+        uint64_t cycles = skipped * machine.cyclesPerFrame();
+        machine.runUntil(machine.cycleCount() + cycles);
+        scheduler.delay(cycles);
+    }
+}
+
+/**
+ * Write the trace to its output file, if there is one
+ */
+static void writeTrace() {
+    if (!trace::dump()) {
+        std::cerr << "Could not write the trace" << std::endl;
+    }
+}
+
+void SdlFrontend::dumpTrace() {
+    std::unique_lock<std::mutex> lock(mutex);
+    trace_dump_pending = true;
+    SDL_Event dump = {};
+    dump.type = trace_dump_event;
+    SDL_PushEvent(&dump);
+    wakeup.wait(lock, [this]() { return !trace_dump_pending || quitting; });
+
+    if (trace_dump_pending) {
+        // The window was closed before it got to the dump, its thread doesn't record anymore
+        trace_dump_pending = false;
+        writeTrace();
+    }
+}
+
+void SdlFrontend::pollInput() {
+    SDL_Event event;
+    while (SDL_WaitEvent(&event)) {
+        if (event.type == SDL_QUIT) {
+            return;
+        }
+        if (event.type == frame_ready_event) {
+            updateScreen();
+            continue;
+        }
+        if (event.type == trace_dump_event) {
+            // The emulation thread waits until the trace is written
+            writeTrace();
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                trace_dump_pending = false;
+            }
+            wakeup.notify_one();
+            continue;
+        }
+        if ((event.type != SDL_KEYDOWN && event.type != SDL_KEYUP) || event.key.repeat) {
+            continue;
+        }
+        for (const auto & mapping : KEYMAP) {
+            if (mapping.sym == event.key.keysym.sym) {
+                if (key_channel.send(mapping.key, event.type == SDL_KEYDOWN)) {
+                    // Taking the lock orders the send before a sleeping idle() checks the channel
+                    { std::lock_guard<std::mutex> lock(mutex); }
+                    wakeup.notify_one();
+                }
+                break;
+            }
+        }
+    }
+}
+
+void SdlFrontend::poll() {
+    if (trace::takeDumpRequest()) {
+        dumpTrace();
+    }
+#ifdef CHIP8_PROFILE
+    machine.profiler().timerPoll();
+    if (Profiler::takeDumpRequest() && !machine.profiler().dump()) {
+        std::cerr << "Could not write the profile" << std::endl;
+    }
+#endif
+
+    if (machine.fault() != chip8::FAULT_NONE && !fault_reported) {
+        std::cerr << "Program crashed at pc " << std::hex << machine.programCounter() << ": ";
+        switch (machine.fault()) {
+            case chip8::FAULT_UNKNOWN_OPCODE:
+                std::cerr << "unknown opcode " << machine.memory.getOpcode(machine.programCounter());
+                break;
+            case chip8::FAULT_STACK_OVERFLOW:
+                std::cerr << "stack overflow";
+                break;
+            case chip8::FAULT_STACK_UNDERFLOW:
+                std::cerr << "stack underflow";
+                break;
+            default:
+                break;
+        }
+        std::cerr << std::dec << std::endl;
+        fault_reported = true;
+    }
+}
+
+void SdlFrontend::updateScreen() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        memcpy(shown_frame, next_frame, sizeof(shown_frame));
+        memcpy(shown_frame_times, next_frame_times, sizeof(shown_frame_times));
+        frame_pending = false;
+    }
+    if (renderer == nullptr) {
+        return;
+    }
+
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+    SDL_RenderClear(renderer);
+    SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
+    {
+        TRACE_SPAN("convert");
+        for (unsigned int y = 0; y < SCREEN_HEIGHT; ++y) {
+            for (unsigned int x = 0; x < SCREEN_WIDTH; ++x) {
+                if (shown_frame[y * SCREEN_WIDTH + x] == 1) {
+                    SDL_RenderDrawPoint(renderer, x, y);
+                }
+            }
+        }
+    }
+
+    if (stats_overlay) {
+        drawStatsOverlay();
+    }
+
+    TRACE_SPAN("present");
+    SDL_RenderPresent(renderer);
+}
+
+void SdlFrontend::drawStatsOverlay() {
+    // One column per frame, newest on the right, a full frame period is a quarter of the screen height
+    const double period = 1000.0 / FRAMES_PER_SECOND;
+    const unsigned int unit = SCREEN_HEIGHT / 4;
+
+    for (unsigned int age = 0; age < SCREEN_WIDTH / 2; ++age) {
+        double frameTime = shown_frame_times[age];
+        unsigned int height = (unsigned int) (frameTime / period * unit + 0.5);
+        if (height > SCREEN_HEIGHT) {
+            height = SCREEN_HEIGHT;
+        }
+
+        for (unsigned int row = 0; row < height; ++row) {
+            if (row < unit) {
+                SDL_SetRenderDrawColor(renderer, 0, 160, 0, 255);
+            } else {
+                SDL_SetRenderDrawColor(renderer, 220, 0, 0, 255);
+            }
+            SDL_RenderDrawPoint(renderer, SCREEN_WIDTH - 1 - age, SCREEN_HEIGHT - 1 - row);
+        }
+    }
+}
@@ -0,0 +1,178 @@
+//
+// Created by david on 18-10-26.
+//
+
+#ifndef CHIP8_SDLFRONTEND_H
+#define CHIP8_SDLFRONTEND_H
+
+#include <SDL.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include "../KeyChannel/KeyChannel.h"
+#include "../RunAhead/RunAhead.h"
+#include "../Scheduler/Scheduler.h"
+#include "../Stats/Stats.h"
+#include "../Stats/StatsExporter.h"
+#include "../Timer.h"
+
+class chip8;
+class Recorder;
+
+/**
+ * Runs a machine in real time and presents its frames in an SDL window.
+ *
+ * The thread calling run() owns the window: it waits on SDL's event queue, sends key changes to the
+ * machine through a KeyChannel and presents the frames the emulation thread hands over. The emulation
+ * thread runs the frame loop and receives the key changes at every vblank, so a key never waits for a
+ * batch of instructions to be polled, and the machine only sees key changes at frame boundaries.
+ */
+class SdlFrontend {
+public:
+    /**
+     * A constructor
+     * @param machine Machine to run, must outlive the frontend
+     * @param screen Window to draw in, may be null to run without drawing
+     */
+    SdlFrontend(chip8 & machine, SDL_Window * screen);
+    ~SdlFrontend();
+
+    SdlFrontend(const SdlFrontend &) = delete;
+    SdlFrontend & operator=(const SdlFrontend &) = delete;
+
+    /**
+     * Emulate and present one frame every 1/60 s until the window is closed. The machine runs in batches
+     * up to the next event of the frame loop, on a thread of its own.
+     */
+    void run();
+
+    /**
+     * @param frames Frames to run ahead of the real frame when presenting, 0 disables run-ahead
+     */
+    void setRunAhead(unsigned int frames) { run_ahead.setFrames(frames); }
+
+    /**
+     * Live statistics of the frame loop, updated every presented frame
+     */
+    const Stats & frameStats() const { return stats; }
+
+    /**
+     * Key changes from the window thread to the emulation thread, with their latency
+     */
+    const KeyChannel & keyChannel() const { return key_channel; }
+
+    /**
+     * Exporter the frame loop publishes frameStats() to once per second
+     */
+    StatsExporter & statsExporter() { return stats_exporter; }
+
+    void setStatsOverlay(bool enabled) { stats_overlay = enabled; }
+
+    /**
+     * Record the session: key events go through the recorder, which also gets every frame boundary
+     * @param recorder Recorder of the machine, may be null to stop recording, must outlive run()
+     */
+    void setRecorder(Recorder * recorder) { this->recorder = recorder; }
+
+    /**
+     * Frame pacing, its missed deadlines are also published with the stats
+     */
+    const Timer & frameTimer() const { return frame_timer; }
+
+private:
+    /**
+     * Events of the frame loop, scheduled on the machine's cycle count
+     */
+    enum FrameEvent : unsigned int {
+        EVENT_VBLANK, // Every frame: wait for the frame's deadline, hand it over and receive key changes
+        EVENT_POLL, // Every frame: dump requests and faults
+        EVENT_PUBLISH_STATS, // Every emulated second
+    };
+
+    chip8 & machine;
+    Scheduler scheduler;
+    Timer frame_timer;
+    SDL_Window * screen;
+    SDL_Renderer * renderer; // SDL Renderer to use with window
+    RunAhead run_ahead;
+    Recorder * recorder;
+    Stats stats;
+    StatsExporter stats_exporter;
+    bool stats_overlay;
+    bool fault_reported;
+
+    KeyChannel key_channel;
+    uint32_t frame_ready_event; // SDL user event telling the window thread a frame is waiting
+    uint32_t trace_dump_event; // SDL user event asking the window thread to write the trace
+    std::atomic<bool> quitting;
+
+    // Shared by the two threads
+    std::mutex mutex;
+    std::condition_variable wakeup; // Signalled on key changes, written traces and on quitting
+    bool frame_pending; // A frame_ready_event is in SDL's queue
+    bool trace_dump_pending; // A trace_dump_event is in SDL's queue, the emulation thread waits for it
+    unsigned char next_frame[SCREEN_WIDTH * SCREEN_HEIGHT];
+    double next_frame_times[SCREEN_WIDTH / 2]; // Frame times for the overlay, newest first
+
+    // Window thread only
+    unsigned char shown_frame[SCREEN_WIDTH * SCREEN_HEIGHT];
+    double shown_frame_times[SCREEN_WIDTH / 2];
+
+    /**
+     * Emulation thread: the frame loop, until the window thread is quitting
+     */
+    void emulate();
+
+    /**
+     * Handle an event of the frame loop
+     * @param event Due event
+     * @return True to keep running
+     */
+    bool handle(const Scheduler::Event & event);
+
+    /**
+     * Emulation thread: hand a frame to the window thread, replacing one it hasn't presented yet
+     */
+    void publishFrame(const unsigned char * frame);
+
+    /**
+     * Emulation thread: hand the queued key changes to the machine
+     */
+    void receiveKeys();
+
+    /**
+     * Emulation thread: sleep while the program waits for a key, until a key change arrives, then move
+     * the machine and the frame loop past the frames slept through. The machine only counts cycles while
+     * it waits, so the timers come out as if every frame had run.
+     */
+    void idle();
+
+    /**
+     * Emulation thread: have the window thread write the trace and wait until it did. Both threads record
+     * spans, and no thread may record while another one writes them.
+     */
+    void dumpTrace();
+
+    /**
+     * Window thread: wait for SDL events and send key changes until the window is closed
+     */
+    void pollInput();
+
+    /**
+     * Window thread: draw the last frame handed over
+     */
+    void updateScreen();
+
+    /**
+     * Draw the frame times of the last frames as bars in the bottom right corner
+     */
+    void drawStatsOverlay();
+
+    /**
+     * Handle dump requests and report a crashed program, once per frame
+     */
+    void poll();
+};
+
+
+#endif //CHIP8_SDLFRONTEND_H
@@ -0,0 +1,54 @@
+//
+// Created by david on 18-10-26.
+//
+
+#ifndef CHIP8_INPUT_H
+#define CHIP8_INPUT_H
+
+#include <cstdint>
+
+/**
+ * Input policies of Machine. An input has to provide
+ *   void clear();
+ *   void set(uint8_t key, bool pressed);
+ *   bool pressed(unsigned int key) const;
+ *   uint16_t state() const;
+ *   void load(uint16_t state);
+ */
+
+/**
+ * The 16 key hex keypad, bit n is set while key n is down
+ */
+struct Keypad {
+    uint16_t keys;
+
+    Keypad(): keys() {}
+
+    void clear() { keys = 0; }
+
+    void set(uint8_t key, bool pressed) {
+        if (pressed) {
+            keys |= 1u << (key & 0xF);
+        } else {
+            keys &= ~(1u << (key & 0xF));
+        }
+    }
+
+    inline bool pressed(unsigned int key) const { return ((keys >> (key & 0xF)) & 1) != 0; }
+
+    uint16_t state() const { return keys; }
+    void load(uint16_t state) { keys = state; }
+};
+
+/**
+ * No key is ever down
+ */
+struct NullInput {
+    void clear() {}
+    void set(uint8_t, bool) {}
+    inline bool pressed(unsigned int) const { return false; }
+    uint16_t state() const { return 0; }
+    void load(uint16_t) {}
+};
+
+#endif //CHIP8_INPUT_H
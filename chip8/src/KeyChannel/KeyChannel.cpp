@@ -0,0 +1,41 @@
+//
+// Created by david on 18-10-26.
+//
+
+#include "KeyChannel.h"
+
+KeyChannel::KeyChannel(): head( 0 ), tail( 0 ), key_mask( 0 ), dropped_count( 0 ), events(), received_count( 0 ),
+                          total_latency( Clock::duration::zero() ), worst_latency( Clock::duration::zero() ) {}
+
+bool KeyChannel::send(uint8_t key, bool pressed) {
+    // Only the producer writes the mask, so it can read it relaxed
+    uint16_t mask = key_mask.load(std::memory_order_relaxed);
+    uint16_t bit = (uint16_t) (1u << (key & 0xF));
+    uint16_t changed = pressed ? (uint16_t) (mask | bit) : (uint16_t) (mask & ~bit);
+    if (changed == mask) {
+        return false;
+    }
+
+    size_t index = tail.load(std::memory_order_relaxed);
+    if (index - head.load(std::memory_order_acquire) == CAPACITY) {
+        dropped_count.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    events[index & (CAPACITY - 1)] = KeyEvent{Clock::now(), (uint8_t) (key & 0xF), pressed};
+    tail.store(index + 1, std::memory_order_release);
+    key_mask.store(changed, std::memory_order_release);
+    return true;
+}
+
+KeyChannel::Clock::duration KeyChannel::meanLatency() const {
+    return received_count == 0 ? Clock::duration::zero() : total_latency / (Clock::duration::rep) received_count;
+}
+
+void KeyChannel::record(Clock::duration latency) {
+    ++received_count;
+    total_latency += latency;
+    if (latency > worst_latency) {
+        worst_latency = latency;
+    }
+}
@@ -0,0 +1,118 @@
+//
+// Created by david on 18-10-26.
+//
+
+#ifndef CHIP8_KEYCHANNEL_H
+#define CHIP8_KEYCHANNEL_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Hands key presses and releases from an input thread to the thread running the machine, without locks.
+ *
+ * One producer sends, one consumer receives. The producer publishes the key mask it last sent as a 16-bit
+ * atomic that any thread can read, and queues every change as a timestamped event in a ring buffer.
+ * The consumer applies the events in order between runs, e.g. at every frame boundary, through
+ * machine.setKey() or Recorder::setKey(). The machine's own Keypad only changes there, so runs stay
+ * deterministic and recordable: Ex9E/ExA1 test a bit that can't flip mid-batch, and a press released again
+ * before the consumer looked still ends an Fx0A wait and still lands in the replay.
+ */
+class KeyChannel {
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    /**
+     * Events the ring holds, a power of two
+     */
+    static constexpr size_t CAPACITY = 256;
+
+    struct KeyEvent {
+        Clock::time_point time; // When the producer sent it
+        uint8_t key; // 0 to F
+        bool pressed;
+    };
+
+    KeyChannel();
+
+    /**
+     * Producer side: queue a key change. A change the mask already has, e.g. a key repeat, is dropped.
+     * @param key Key 0 to F
+     * @param pressed True when the key goes down
+     * @return True if the change was queued, false for a repeat or if the ring was full and the change was
+     * lost (counted in dropped())
+     */
+    bool send(uint8_t key, bool pressed);
+
+    /**
+     * @return The keys down as last sent, bit n for key n. Safe to read from any thread.
+     */
+    uint16_t keys() const { return key_mask.load(std::memory_order_acquire); }
+
+    /**
+     * Consumer side: hand every queued event to handler in the order sent and measure how long each waited
+     * @param handler Called as handler(const KeyEvent &)
+     * @return Number of events received
+     */
+    template<typename Handler>
+    size_t receive(Handler && handler) {
+        size_t first = head.load(std::memory_order_relaxed);
+        size_t last = tail.load(std::memory_order_acquire);
+        if (first == last) {
+            return 0;
+        }
+
+        Clock::time_point now = Clock::now();
+        for (size_t index = first; index != last; ++index) {
+            const KeyEvent & event = events[index & (CAPACITY - 1)];
+            handler(event);
+            record(now - event.time);
+        }
+        head.store(last, std::memory_order_release);
+        return last - first;
+    }
+
+    /**
+     * Consumer side: e.g. to sleep until there is something to receive
+     * @return True if no events are queued
+     */
+    bool empty() const {
+        return head.load(std::memory_order_relaxed) == tail.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @return Events received so far
+     */
+    uint64_t received() const { return received_count; }
+
+    /**
+     * Latency from send() to receive() over the events received so far, read on the consumer side
+     */
+    Clock::duration meanLatency() const;
+    Clock::duration worstLatency() const { return worst_latency; }
+
+    /**
+     * @return Changes send() lost to a full ring
+     */
+    uint64_t dropped() const { return dropped_count.load(std::memory_order_relaxed); }
+
+private:
+    // Producer and consumer indices on their own cache lines, they are written by different threads
+    alignas(64) std::atomic<size_t> head; // Next event to receive, written by the consumer
+    alignas(64) std::atomic<size_t> tail; // Next free slot, written by the producer
+    std::atomic<uint16_t> key_mask;
+    std::atomic<uint64_t> dropped_count;
+    alignas(64) KeyEvent events[CAPACITY];
+
+    // Consumer only
+    uint64_t received_count;
+    Clock::duration total_latency;
+    Clock::duration worst_latency;
+
+    void record(Clock::duration latency);
+};
+
+
+#endif //CHIP8_KEYCHANNEL_H
@@ -0,0 +1,857 @@
+//
+// Created by David Strootman on 9-4-2019.
+//
+// Most of the comments in this file come from Cowgod's Chip-8 Technical reference
+//
+
+#include "Machine.h"
+#include "opcode_helper.h"
+#ifdef CHIP8_TRACE
+#include <iostream>
+#endif
+
+static const uint32_t DEFAULT_SEED = 0x2545F491;
+
+static const unsigned char FONTSET[80] =
+{
+    0xF0, 0x90, 0x90, 0x90, 0xF0, // 0
+    0x20, 0x60, 0x20, 0x20, 0x70, // 1
+    0xF0, 0x10, 0xF0, 0x80, 0xF0, // 2
+    0xF0, 0x10, 0xF0, 0x10, 0xF0, // 3
+    0x90, 0x90, 0xF0, 0x10, 0x10, // 4
+    0xF0, 0x80, 0xF0, 0x10, 0xF0, // 5
+    0xF0, 0x80, 0xF0, 0x90, 0xF0, // 6
+    0xF0, 0x10, 0x20, 0x40, 0x40, // 7
+    0xF0, 0x90, 0xF0, 0x90, 0xF0, // 8
+    0xF0, 0x90, 0xF0, 0x10, 0xF0, // 9
+    0xF0, 0x90, 0xF0, 0x90, 0x90, // A
+    0xE0, 0x90, 0xE0, 0x90, 0xE0, // B
+    0xF0, 0x80, 0x80, 0x80, 0xF0, // C
+    0xE0, 0x90, 0x90, 0x90, 0xE0, // D
+    0xF0, 0x80, 0xF0, 0x80, 0xF0, // E
+    0xF0, 0x80, 0xF0, 0x80, 0x80  // F
+};
+
+template<typename MemoryPolicy, typename DisplayPolicy, typename InputPolicy>
+Machine<MemoryPolicy, DisplayPolicy, InputPolicy>::Machine(): V(), I(), sp(), delay_timer(), sound_timer(), delay_tick(), sound_tick(), rng_state( DEFAULT_SEED ), cycles(), batch_end(), instructions(), fault_state( FAULT_NONE ), key_wait(), quirk_profile( QUIRKS_MODERN ), timing_mode( TIMING_FIXED ), cycles_per_frame( FixedTiming::CYCLES_PER_FRAME ), draw_flag()
+{
+    pc = 0x200; // Program counter (First 512/0x200 bytes are reserved for Chip8)
+    opcode = 0; // Current opcode
+}
+
+template<typename MemoryPolicy, typename DisplayPolicy, typename InputPolicy>
+void Machine<MemoryPolicy, DisplayPolicy, InputPolicy>::loadProgram(const unsigned char * program, int size) {
+    memory.load(PROGRAM_START, program, size);
+
+    write_tracker.reset();
+}
+
+template<typename MemoryPolicy, typename DisplayPolicy, typename InputPolicy>
+void Machine<MemoryPolicy, DisplayPolicy, InputPolicy>::initialize()
+{
+    // zero-initialize the display, stack, registers and memory
+    display.clear();
+    memset(stack, 0, sizeof(stack));
+    memset(V, 0, sizeof(V));
+    memory.clear();
+    memory.load(0, FONTSET, sizeof(FONTSET));
+
+    I = 0; // Index Register
+    sp = 0; // Stack pointer
+    pc = 0x200; // program counter (starts at first byte of program memory: 512)
+
+    draw_flag = false;
+
+    rng_state = DEFAULT_SEED;
+    input.clear();
+    cycles = 0;
+    instructions = 0;
+    loadTimers(0, 0);
+    fault_state = FAULT_NONE;
+    key_wait = 0;
+#ifdef CHIP8_PROFILE
+    profile.reset();
+#endif
+}
+
+template<typename MemoryPolicy, typename DisplayPolicy, typename InputPolicy>
+void Machine<MemoryPolicy, DisplayPolicy, InputPolicy>::seed(uint32_t seed) {
+    // xorshift never leaves the all zero state
+    rng_state = seed == 0 ? DEFAULT_SEED : seed;
+}
+
+template<typename MemoryPolicy, typename DisplayPolicy, typename InputPolicy>
+void Machine<MemoryPolicy, DisplayPolicy, InputPolicy>::setTiming(TimingMode mode) {
+    // The timers count in frames of the model, keep their current values
+    unsigned char delay = delayTimer();
+    unsigned char sound = soundTimer();
+
+    timing_mode = mode;
+    cycles_per_frame = mode == TIMING_VIP ? VipTiming::CYCLES_PER_FRAME : FixedTiming::CYCLES_PER_FRAME;
+    loadTimers(delay, sound);
+}
+
+template<typename MemoryPolicy, typename DisplayPolicy, typename InputPolicy>
+void Machine<MemoryPolicy, DisplayPolicy, InputPolicy>::runFrame()
+{
+    runUntil((cycles / cycles_per_frame + 1) * cycles_per_frame);
+}
+
+template<typename MemoryPolicy, typename DisplayPolicy, typename InputPolicy>
+void Machine<MemoryPolicy, DisplayPolicy, InputPolicy>::runUntil(uint64_t cycle)
+{
+    NullDebugPolicy none;
+    runUntil(cycle, none);
+}
+
+template<typename MemoryPolicy, typename DisplayPolicy, typename InputPolicy>
+template<typename Debug>
+bool Machine<MemoryPolicy, DisplayPolicy, InputPolicy>::runUntil(uint64_t cycle, Debug & debug)
+{
+    // One branch per run, the instructions themselves don't look at the profile
+    switch (quirk_profile) {
+        case QUIRKS_VIP:
+            return runTimed<VipQuirks>(cycle, debug);
+        case QUIRKS_SCHIP:
+            return runTimed<SchipQuirks>(cycle, debug);
+        case QUIRKS_XOCHIP:
+            return runTimed<XochipQuirks>(cycle, debug);
+        default:
+            return runTimed<ModernQuirks>(cycle, debug);
+    }
+}
+
+template<typename MemoryPolicy, typename DisplayPolicy, typename InputPolicy>
+template<typename Quirks, typename Debug>
+bool Machine<MemoryPolicy, DisplayPolicy, InputPolicy>::runTimed(uint64_t cycle, Debug & debug)
+{
+    if (timing_mode == TIMING_VIP) {
+        return runBatch<Quirks, VipTiming>(cycle, debug);
+    }
+    return runBatch<Quirks, FixedTiming>(cycle, debug);
+}
+
+template<typename MemoryPolicy, typename DisplayPolicy, typename InputPolicy>
+template<typename Quirks, typename Timing, typename Debug>
+bool Machine<MemoryPolicy, DisplayPolicy, InputPolicy>::runBatch(uint64_t cycle, Debug & debug)
+{
+    uint64_t resume = cycles;
+
+    if (key_wait != 0) {
+        // Nothing runs until a key press, the time until then passes at once
+        cycles = cycles < cycle ? cycle : cycles;
+        return true;
+    }
+    batch_end = cycle;
+
+    // The timers are computed from the cycle count, so frame boundaries don't split the batch
+    while (cycles < cycle) {
+        if (Debug::ENABLED && cycles != resume && debug.breakpoint(pc)) {
+            return false;
+        }
+        step<Quirks, Timing>(debug);
+        if (Debug::ENABLED && debug.takeStop()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template<typename MemoryPolicy, typename DisplayPolicy, typename InputPolicy>
+void Machine<MemoryPolicy, DisplayPolicy, InputPolicy>::emulateCycle()
+{
+    // Any run executes at least the instruction at pc
+    runUntil(cycles + 1);
+}
+
+template<typename MemoryPolicy, typename DisplayPolicy, typename InputPolicy>
+template<typename Quirks, typename Timing, typename Debug>
+inline void Machine<MemoryPolicy, DisplayPolicy, InputPolicy>::step(Debug & debug)
+{
+    ++instructions;
+    if (!Debug::ENABLED) {
+        execute<Quirks, Timing>(debug);
+        // Nothing with FixedTiming, the costs of a batch add up without looking at the clock
+        cycles += Timing::cost(opcode) - 1;
+        return;
+    }
+
+    unsigned char before[16];
+    memcpy(before, V, sizeof(V));
+    unsigned short beforeI = I;
+
+    execute<Quirks, Timing>(debug);
+    cycles += Timing::cost(opcode) - 1;
+
+    if (memcmp(before, V, sizeof(V)) != 0) {
+        for (unsigned int i = 0; i < 16; ++i) {
+            if (V[i] != before[i]) {
+                debug.registerWrite(i, before[i], V[i]);
+            }
+        }
+    }
+    if (I != beforeI) {
+        debug.registerWrite(DebugPolicy::REGISTER_I, beforeI, I);
+    }
+}
+
+template<typename MemoryPolicy, typename DisplayPolicy, typename InputPolicy>
+template<typename Quirks, typename Timing, typename Debug>
+void Machine<MemoryPolicy, DisplayPolicy, InputPolicy>::execute(Debug & debug)
+{
+    // Program memory starts at 512
+    opcode = memory.getOpcode(pc);
+    write_tracker.markCode(pc);
+    ++cycles;
+#ifdef CHIP8_PROFILE
+    profile.instruction(pc, opcode);
+#endif
+
+#ifdef CHIP8_TRACE
+    std::cout << "pc: " << (pc - 512) << ", opcode: " << std::hex << (opcode) << std::endl;
+#endif
+
+    // Decode opcode
+    switch (opcode & 0xF000) {
+        case 0x0000: {
+            switch (opcode & 0x0FF0) {
+                case 0x00E0: {
+                    switch (opcode & 0x000F) {
+                        case 0x0000: {
+                            /*
+                             * 00E0 - CLS
+                             * Clear the display.
+                             */
+                            display.clear();
+
+                            pc += 2;
+                            return;
+                        }
+                        case 0x000E: {
+
+                            /*
+                             * 00EE - RET
+                             * Return from a subroutine.
+                             *
+                             * The interpreter sets the program counter to the address at the top of the stack,
+                             * then subtracts 1 from the stack pointer.
+                             */
+                            if (sp == 0) {
+                                fault_state = fault_state ? fault_state : FAULT_STACK_UNDERFLOW;
+                                return;
+                            }
+                            pc = stack[sp--] + 2;
+                            return;
+                        }
+                        default: {
+                            goto unknown_opcode;
+                        }
+                    }
+                }
+                default: {
+                    /**
+                     * 0nnn - SYS addr
+                     * Jump to a machine code routine at nnn.
+                     *
+                     * This instruction is only used on the old computers on which Chip-8 was originally implemented.
+                     * !!!!!!!!!!!!!!It is ignored by modern interpreters.!!!!!!!!!!!!!!!!
+                     */
+                    pc += 2;
+                    return;
+                }
+            }
+        }
+
+        case 0x1000: {
+            /*
+             * 1nnn - JP addr
+             * Jump to location nnn.
+             * The interpreter sets the program counter to nnn.
+             */
+            pc = NNN;
+            return;
+        }
+
+        case 0x2000: {
+            /*
+             * 2nnn - CALL addr
+             * Call subroutine at nnn.
+             *
+             * The interpreter increments the stack pointer, then puts the current PC on the top of the stack.
+             * The PC is then set to nnn.
+             */
+            if (sp == 15) {
+                fault_state = fault_state ? fault_state : FAULT_STACK_OVERFLOW;
+                return;
+            }
+            ++sp;
+            stack[sp] = pc;
+            pc = NNN;
+            return;
+        }
+
+        case 0x3000: {
+            /*
+             * 3xkk - SE Vx, byte
+             * Skip next instruction if Vx = kk.
+             *
+             * The interpreter compares register Vx to kk, and if they are equal, increments the program counter by 2.
+             */
+
+            if (V[X] == KK) {
+                pc += 2;
+            }
+            pc += 2;
+            return;
+        }
+
+        case 0x4000: {
+            /*
+             * 4xkk - SNE Vx, byte
+             * Skip next instruction if Vx != kk.
+             *
+             * The interpreter compares register Vx to kk, and if they are not equal, increments the program counter by 2.
+             */
+
+            if (V[X] != KK) {
+                pc += 2;
+            }
+            pc += 2;
+            return;
+        }
+
+        case 0x5000: {
+            /*
+             * 5xy0 - SE Vx, Vy
+             * Skip next instruction if Vx = Vy.
+             *
+             * The interpreter compares register Vx to register Vy, and if they are equal,
+             * increments the program counter by 2.
+             */
+
+            if (V[X] == V[Y]) {
+                pc += 2;
+            }
+            pc += 2;
+            return;
+        }
+
+        case 0x6000: {
+            /*
+             * 6xkk - LD Vx, byte
+             * Set Vx = kk.
+             *
+             * The interpreter puts the value kk into register Vx.
+             */
+            V[X] = KK;
+
+            pc += 2;
+            return;
+        }
+
+        case 0x7000: {
+            /*
+             * 7xkk - ADD Vx, byte
+             * Set Vx = Vx + kk.
+             *
+             * Adds the value kk to the value of register Vx, then stores the result in Vx.
+             */
+            V[X] += KK;
+
+            pc += 2;
+            return;
+        }
+
+        case 0x8000: {
+            switch (opcode & 0x000F) {
+                case 0x0000: {
+                    /*
+                     * 8xy0 - LD Vx, Vy
+                     * Set Vx = Vy.
+                     *
+                     * Stores the value of register Vy in register Vx.
+                     */
+                    V[X] = V[Y];
+
+                    pc += 2;
+                    return;
+                }
+
+                case 0x0001: {
+                    /*
+                     * 8xy1 - OR Vx, Vy
+                     * Set Vx = Vx OR Vy.
+                     *
+                     * Performs a bitwise OR on the values of Vx and Vy, then stores the result in Vx.
+                     * A bitwise OR compares the corresponding bits from two values, and if either bit is 1,
+                     * then the same bit in the result is also 1. Otherwise, it is 0.
+                     * With LOGIC_RESETS_VF, VF is set to 0.
+                     */
+                    V[X] |= V[Y];
+                    if (Quirks::LOGIC_RESETS_VF) {
+                        V[0xF] = 0;
+                    }
+
+                    pc += 2;
+                    return;
+                }
+
+                case 0x0002: {
+                    /*
+                     * 8xy2 - AND Vx, Vy
+                     * Set Vx = Vx AND Vy.
+                     *
+                     * Performs a bitwise AND on the values of Vx and Vy, then stores the result in Vx.
+                     * A bitwise AND compares the corresponding bits from two values, and if both bits are 1,
+                     * then the same bit in the result is also 1. Otherwise, it is 0.
+                     * With LOGIC_RESETS_VF, VF is set to 0.
+                     */
+                    V[X] &= V[Y];
+                    if (Quirks::LOGIC_RESETS_VF) {
+                        V[0xF] = 0;
+                    }
+
+                    pc += 2;
+                    return;
+                }
+
+                case 0x0003: {
+                    /*
+                     * 8xy3 - XOR Vx, Vy
+                     * Set Vx = Vx XOR Vy.
+                     *
+                     * Performs a bitwise exclusive OR on the values of Vx and Vy, then stores the result in Vx.
+                     * An exclusive OR compares the corresponding bits from two values,
+                     * and if the bits are not both the same, then the corresponding bit in the result is set to 1.
+                     * Otherwise, it is 0.
+                     * With LOGIC_RESETS_VF, VF is set to 0.
+                     */
+                    V[X] ^= V[Y];
+                    if (Quirks::LOGIC_RESETS_VF) {
+                        V[0xF] = 0;
+                    }
+
+                    pc += 2;
+                    return;
+                }
+
+                case 0x0004: {
+                    /*
+                     * 8xy4 - ADD Vx, Vy
+                     * Set Vx = Vx + Vy, set VF = carry.
+                     *
+                     * The values of Vx and Vy are added together.
+                     * If the result is greater than 8 bits (i.e., > 255,) VF is set to 1, otherwise 0.
+                     * Only the lowest 8 bits of the result are kept, and stored in Vx.
+                     */
+                    unsigned int sum = V[X] + V[Y];
+                    V[X] = (unsigned char) (sum & 0xFF);
+                    V[0xF] = sum > 0xFF; // Last, so that with X = F the flag wins
+
+
+                    pc += 2;
+                    return;
+                }
+
+                case 0x0005: {
+                    /*
+                     * 8xy5 - SUB Vx, Vy
+                     * Set Vx = Vx - Vy, set VF = NOT borrow.
+                     *
+                     * If Vx > Vy, then VF is set to 1, otherwise 0.
+                     * Then Vy is subtracted from Vx, and the results stored in Vx.
+                     */
+                    unsigned char flag = V[X] >= V[Y];
+                    V[X] -= V[Y];
+                    V[0xF] = flag;
+
+                    pc += 2;
+                    return;
+                }
+
+                case 0x0006: {
+                    /*
+                     * 8xy6 - SHR Vx {, Vy}
+                     * Set Vx = Vx SHR 1.
+                     *
+                     * If the least-significant bit of Vx is 1, then VF is set to 1, otherwise 0.
+                     * Then Vx is divided by 2.
+                     * With SHIFT_VY Vx is set to Vy SHR 1 instead.
+                     */
+                    unsigned char source = Quirks::SHIFT_VY ? V[Y] : V[X];
+                    V[X] = source >> 1;
+                    V[0xF] = source & 1;
+
+                    pc += 2;
+                    return;
+                }
+
+                case 0x0007: {
+                    /*
+                     * 8xy7 - SUBN Vx, Vy
+                     * Set Vx = Vy - Vx, set VF = NOT borrow.
+                     *
+                     * If Vy > Vx, then VF is set to 1, otherwise 0.
+                     * Then Vx is subtracted from Vy, and the results stored in Vx.
+                     */
+                    unsigned char flag = V[Y] >= V[X];
+                    V[X] = V[Y] - V[X];
+                    V[0xF] = flag;
+
+                    pc += 2;
+                    return;
+                }
+
+                case 0x000E: {
+                    /*
+                     * 8xyE - SHL Vx {, Vy}
+                     * Set Vx = Vx SHL 1.
+                     *
+                     * If the most-significant bit of Vx is 1, then VF is set to 1, otherwise to 0.
+                     * Then Vx is multiplied by 2.
+                     * With SHIFT_VY Vx is set to Vy SHL 1 instead.
+                     */
+                    unsigned char source = Quirks::SHIFT_VY ? V[Y] : V[X];
+                    V[X] = source << 1;
+                    V[0xF] = source >> 7;
+
+                    pc += 2;
+                    return;
+                }
+
+                default: {
+                    goto unknown_opcode;
+                }
+            }
+            return;
+        }
+
+        case 0x9000: {
+            /*
+             * 9xy0 - SNE Vx, Vy
+             * Skip next instruction if Vx != Vy.
+             *
+             * The values of Vx and Vy are compared, and if they are not equal, the program counter is increased by 2.
+             */
+            pc += (V[X] != V[Y]) ? 2 : 0;
+
+            pc += 2;
+            return;
+        }
+
+        case 0xA000: {
+            /*
+             * Annn - LD I, addr
+             * Set I = nnn.
+             *
+             * The value of register I is set to nnn.
+             */
+            I = opcode & 0x0FFF;
+
+            pc += 2;
+            return;
+        }
+
+        case 0xB000: {
+            /*
+             * Bnnn - JP V0, addr
+             * Jump to location nnn + V0.
+             *
+             * The program counter is set to nnn plus the value of V0.
+             * With JUMP_VX this is Bxnn, a jump to xnn plus the value of Vx.
+             */
+            pc = NNN + V[Quirks::JUMP_VX ? X : 0x0];
+            return;
+        }
+
+        case 0xC000: {
+            /*
+             * Cxkk - RND Vx, byte
+             * Set Vx = random byte AND kk.
+             *
+             * The interpreter generates a random number from 0 to 255, which is then ANDed with the value kk.
+             * The results are stored in Vx. See instruction 8xy2 for more information on AND.
+             */
+
+            rng_state ^= rng_state << 13;
+            rng_state ^= rng_state >> 17;
+            rng_state ^= rng_state << 5;
+            V[X] = (unsigned char)(rng_state >> 24) & KK;
+
+            pc += 2;
+            return;
+        }
+
+        case 0xD000: {
+            /*
+             * Dxyn - DRW Vx, Vy, nibble
+             * Display n-byte sprite starting at memory location I at (Vx, Vy), set VF = collision.
+             *
+             * The interpreter reads n bytes from memory, starting at the address stored in I. These bytes are
+             * then displayed as sprites on screen at coordinates (Vx, Vy). Sprites are XORed onto the existing screen.
+             * If this causes any pixels to be erased, VF is set to 1, otherwise it is set to 0. If the sprite is
+             * positioned so part of it is outside the coordinates of the display, it wraps around to the opposite
+             * side of the screen. See instruction 8xy3 for more information on XOR, and section 2.4, Display,
+             * for more information on the Chip-8 screen and sprites.
+             */
+            if (Quirks::DISPLAY_WAIT) {
+                // Drawing waits for the next display interrupt. The instruction ends on the first frame
+                // boundary its cost fits before, step() adds the rest of the cost after the wait
+                uint64_t end = (cycles - 1 + Timing::cost(opcode) + Timing::CYCLES_PER_FRAME - 1)
+                               / Timing::CYCLES_PER_FRAME * Timing::CYCLES_PER_FRAME;
+                cycles = end - (Timing::cost(opcode) - 1);
+            }
+
+            uint8_t pixel;
+            unsigned int x = V[X] % SCREEN_WIDTH;
+            unsigned int y = V[Y] % SCREEN_HEIGHT;
+
+            // With CLIP_SPRITES only the start position wraps, whatever ends up beyond the edges is dropped
+            unsigned int rows = N;
+            unsigned int columns = 8;
+            if (Quirks::CLIP_SPRITES) {
+                rows = y + rows > SCREEN_HEIGHT ? SCREEN_HEIGHT - y : rows;
+                columns = x + columns > SCREEN_WIDTH ? SCREEN_WIDTH - x : columns;
+            }
+
+            V[0xF] = 0;
+            for (unsigned int yline = 0; yline < rows; ++yline) {
+                unsigned int row = (y + yline) % SCREEN_HEIGHT;
+                pixel = memory.read(I + yline);
+                if (display.drawRow(x, row, pixel, columns))
+                    V[0xF] = 1;
+            }
+
+            draw_flag = true;
+#ifdef CHIP8_PROFILE
+            profile.sprite(memory, I, N);
+#endif
+
+            pc += 2;
+            return;
+        }
+
+        case 0xE000: {
+            switch (opcode & 0x00FF) {
+                case 0x009E: {
+                    /*
+                     * Ex9E - SKP Vx
+                     * Skip next instruction if key with the value of Vx is pressed.
+                     *
+                     * Checks the keyboard, and if the key corresponding to the value of Vx is currently in
+                     * the down position, PC is increased by 2.
+                     */
+                    if (input.pressed(V[X])) {
+                        pc += 2;
+                    }
+                    pc += 2;
+                    return;
+                }
+
+                case 0x00A1: {
+                    /*
+                     * ExA1 - SKNP Vx
+                     * Skip next instruction if key with the value of Vx is not pressed.
+                     *
+                     * Checks the keyboard, and if the key corresponding to the value of Vx is currently in
+                     * the up position, PC is increased by 2.
+                     */
+                    if (!input.pressed(V[X])) {
+                        pc += 2;
+                    }
+                    pc += 2;
+                    return;
+                }
+
+                default: {
+                    goto unknown_opcode;
+                }
+            }
+            return;
+        }
+
+        case 0xF000: {
+            switch (opcode & 0x00F0) {
+                case 0x0000: {
+                    switch (opcode & 0x000F) {
+                        case 0x0007: {
+                            /*
+                             * Fx07 - LD Vx, DT
+                             * Set Vx = delay timer value.
+                             *
+                             * The value of DT is placed into Vx.
+                             */
+                            V[X] = timerValue(delay_timer, delay_tick, executingTick<Timing>());
+
+                            pc += 2;
+                            return;
+                        }
+
+                        case 0x000A: {
+                            /*
+                             * Fx0A - LD Vx, K
+                             * Wait for a key press, store the value of the key in Vx.
+                             *
+                             * All execution stops until a key is pressed, then the value of that key is stored in Vx.
+                            */
+                            // The machine blocks until setKey() stores a key, the rest of the batch passes
+                            // at once. step() adds the rest of the cost, the instruction ends on batch_end.
+                            key_wait = (uint8_t) (X + 1);
+                            if (cycles - 1 + Timing::cost(opcode) < batch_end) {
+                                cycles = batch_end - (Timing::cost(opcode) - 1);
+                            }
+
+                            pc += 2;
+                            return;
+                        }
+
+                        default: {
+                            goto unknown_opcode;
+                        }
+                    }
+                }
+
+                case 0x0010: {
+                    switch (opcode & 0x000F) {
+                        case 0x0005: {
+                            /*
+                             * Fx15 - LD DT, Vx
+                             * Set delay timer = Vx.
+                             *
+                             * DT is set equal to the value of Vx.
+                             */
+                            delay_timer = V[X];
+                            delay_tick = executingTick<Timing>();
+
+                            pc += 2;
+                            return;
+                        }
+
+                        case 0x0008: {
+                            /*
+                             * Fx18 - LD ST, Vx
+                             * Set sound timer = Vx.
+                             *
+                             * ST is set equal to the value of Vx.
+                             */
+                            sound_timer = V[X];
+                            sound_tick = executingTick<Timing>();
+
+                            pc += 2;
+                            return;
+                        }
+
+                        case 0x000E: {
+                            /*
+                             * Fx1E - ADD I, Vx
+                             * Set I = I + Vx.
+                             *
+                             * The values of I and Vx are added, and the results are stored in I.
+                             */
+                            I += V[X];
+
+                            pc += 2;
+                            return;
+                        }
+
+                        default: {
+                            goto unknown_opcode;
+                        }
+                    }
+                }
+
+                case 0x0020: {
+                    /*
+                     * Fx29 - LD F, Vx
+                     * Set I = location of sprite for digit Vx.
+                     *
+                     * The value of I is set to the location for the hexadecimal sprite corresponding to
+                     * the value of Vx. See section 2.4, Display, for more information on the Chip-8 hexadecimal font.
+                     * The font is loaded at address 0, five bytes per digit.
+                     */
+                    I = (unsigned short) ((V[X] & 0x0F) * 5);
+
+                    pc += 2;
+                    return;
+                }
+
+                case 0x0030: {
+                    /*
+                     * Fx33 - LD B, Vx
+                     * Store BCD representation of Vx in memory locations I, I+1, and I+2.
+                     *
+                     * The interpreter takes the decimal value of Vx, and places the hundreds digit in memory at
+                     * location in I, the tens digit at location I+1, and the ones digit at location I+2.
+                     */
+                    write_tracker.noteWrite(I, 3, pc);
+                    debug.memoryWrite(I, 3, pc);
+                    memory.write(I, (unsigned char)((V[X] / 100) % 10));
+                    memory.write(I + 1, (unsigned char)((V[X] / 10) % 10));
+                    memory.write(I + 2, (unsigned char)(V[X] % 10));
+
+                    pc+=2;
+                    return;
+                }
+
+                case 0x0050: {
+                    /*
+                     * Fx55 - LD [I], Vx
+                     * Store registers V0 through Vx in memory starting at location I.
+                     *
+                     * The interpreter copies the values of registers V0 through Vx into memory,
+                     * starting at the address in I.
+                     * With LOAD_STORE_INCREMENTS_I, I is left at I + x + 1.
+                     */
+                    write_tracker.noteWrite(I, X + 1, pc);
+                    debug.memoryWrite(I, X + 1, pc);
+                    for (unsigned int i = 0; i <= X; ++i) {
+                        memory.write(I + i, V[0 + i]);
+                    }
+                    if (Quirks::LOAD_STORE_INCREMENTS_I) {
+                        I += X + 1;
+                    }
+
+                    pc += 2;
+                    return;
+                }
+
+                case 0x0060: {
+                    /*
+                     * Fx65 - LD Vx, [I]
+                     * Read registers V0 through Vx from memory starting at location I.
+                     *
+                     * The interpreter reads values from memory starting at location I into registers V0 through Vx.
+                     * With LOAD_STORE_INCREMENTS_I, I is left at I + x + 1.
+                     */
+
+                    for (int i = 0; i <= X; ++i) {
+                        V[i] = memory.read(I + i);
+                    }
+                    if (Quirks::LOAD_STORE_INCREMENTS_I) {
+                        I += X + 1;
+                    }
+
+                    pc += 2;
+                    return;
+                }
+
+                default: {
+                    goto unknown_opcode;
+                }
+            }
+        }
+        default: {
+        unknown_opcode:
+            // The frontend reports the fault
+            fault_state = fault_state ? fault_state : FAULT_UNKNOWN_OPCODE;
+        }
+    }
+}
+
+template class Machine<Memory, FrameBuffer, Keypad>;
+template bool Machine<Memory, FrameBuffer, Keypad>::runUntil<NullDebugPolicy>(uint64_t cycle, NullDebugPolicy & debug);
+template bool Machine<Memory, FrameBuffer, Keypad>::runUntil<DebugPolicy>(uint64_t cycle, DebugPolicy & debug);
+
+template class Machine<Memory, NullDisplay, NullInput>;
+template class Machine<Memory, PackedDisplay, Keypad>;
+template class Machine<TracingMemory, FrameBuffer, Keypad>;
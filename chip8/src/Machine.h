@@ -0,0 +1,259 @@
+//
+// Created by david on 18-10-26.
+//
+
+#ifndef CHIP8_MACHINE_H
+#define CHIP8_MACHINE_H
+
+#include <cstdint>
+#include <cstring>
+
+#include "WriteTracker.h"
+#include "Memory.h"
+#include "TracingMemory.h"
+#include "Display.h"
+#include "Input.h"
+#include "Quirks.h"
+#include "Timing.h"
+#include "Debugger/DebugPolicy.h"
+#ifdef CHIP8_PROFILE
+#include "Profiler/Profiler.h"
+#endif
+
+/**
+ * The CPU and the interpreter, over the memory, display and input it runs on.
+ *
+ * The policies are plain types whose members the interpreter calls directly (see Display.h and
+ * Input.h, memory has the interface of Memory), so a headless machine inlines its null display and
+ * input away and a packed display or a tracing memory costs no virtual calls.
+ * Instantiated in Machine.cpp for chip8's policies and for the aliases below.
+ */
+template<typename MemoryPolicy, typename DisplayPolicy, typename InputPolicy>
+class Machine {
+    public:
+        /**
+         * Reasons the program crashed. The first fault sticks, the machine keeps hanging on the
+         * faulting instruction.
+         */
+        enum Fault : uint8_t {
+            FAULT_NONE,
+            FAULT_UNKNOWN_OPCODE,
+            FAULT_STACK_OVERFLOW,
+            FAULT_STACK_UNDERFLOW,
+        };
+
+    protected:
+        unsigned short pc; // Program counter (First 512/0x200 bytes are reserved for Chip8)
+        unsigned short opcode; // Current opcode
+
+        unsigned char V[16]; // Registers
+        unsigned short I; // Index Register
+
+        unsigned short stack[16] = {}; // Stack
+        unsigned short sp; // Stack pointer
+
+        // The timers count down once every CYCLES_PER_FRAME instructions. Nothing ticks them, each holds
+        // its value at a timer tick and the current value is computed from the cycle count when read
+        unsigned char delay_timer; // Delay timer at delay_tick
+        unsigned char sound_timer; // Sound timer at sound_tick
+        uint64_t delay_tick;
+        uint64_t sound_tick;
+
+        uint32_t rng_state; // xorshift32 state for Cxkk, part of the machine state
+        uint64_t cycles; // Clock of the timing model since initialize(), instructions executed with TIMING_FIXED
+        uint64_t batch_end; // Cycle the running batch stops at
+        uint64_t instructions; // Executed since initialize(), for statistics, not part of the machine state
+        Fault fault_state;
+        uint8_t key_wait; // Register + 1 that Fx0A stores the next key press in, 0 while running
+        QuirkProfile quirk_profile; // Configuration like the program, snapshots keep it with the memory image
+        TimingMode timing_mode; // Configuration too
+        uint64_t cycles_per_frame; // CYCLES_PER_FRAME of the timing model
+
+        WriteTracker write_tracker; // Self-modifying code detection for memory
+#ifdef CHIP8_PROFILE
+        Profiler profile;
+#endif
+
+        /**
+         * Decode and execute the instruction at pc, counting it as one cycle
+         */
+        template<typename Quirks, typename Timing, typename Debug>
+        void execute(Debug & debug);
+
+        /**
+         * execute() and report the registers it changed, then charge the rest of the instruction's cost
+         */
+        template<typename Quirks, typename Timing, typename Debug>
+        void step(Debug & debug);
+
+        /**
+         * runUntil() for one quirk profile
+         */
+        template<typename Quirks, typename Debug>
+        bool runTimed(uint64_t cycle, Debug & debug);
+
+        /**
+         * runUntil() for one quirk profile and timing model
+         */
+        template<typename Quirks, typename Timing, typename Debug>
+        bool runBatch(uint64_t cycle, Debug & debug);
+
+        /**
+         * @param value Timer value at tick anchor
+         * @param anchor Timer tick the value was set at
+         * @param tick Current timer tick
+         * @return Timer value at tick
+         */
+        static unsigned char timerValue(unsigned char value, uint64_t anchor, uint64_t tick) {
+            uint64_t elapsed = tick - anchor;
+            return elapsed >= value ? 0 : (unsigned char) (value - elapsed);
+        }
+
+        /**
+         * Timer ticks before the instruction being executed, cycles already counts it
+         */
+        template<typename Timing>
+        uint64_t executingTick() const { return (cycles - 1) / Timing::CYCLES_PER_FRAME; }
+    public:
+        MemoryPolicy memory;
+        DisplayPolicy display;
+        InputPolicy input;
+        bool draw_flag;
+
+        Machine();
+
+        void loadProgram(const unsigned char * program, int size);
+
+        void initialize();
+
+        void emulateCycle();
+
+        /**
+         * Emulate one 60 Hz frame: run up to the next frame boundary, where the timers tick
+         */
+        void runFrame();
+
+        /**
+         * Run until the cycle count reaches a cycle. The timers tick at every frame boundary (every
+         * cyclesPerFrame() cycles) however the run is split up.
+         * With TIMING_FIXED the run stops exactly at cycle. Instructions costing more than one cycle
+         * and the DISPLAY_WAIT quirk can take it past cycle, the run stops after the instruction that
+         * reaches it.
+         * @param cycle Cycle count to stop at
+         */
+        void runUntil(uint64_t cycle);
+
+        /**
+         * runUntil(cycle) with debugger hooks. The instruction at pc always executes, so a run can be
+         * continued from the breakpoint it stopped at.
+         * Instantiated for NullDebugPolicy and DebugPolicy.
+         * @param cycle Cycle count to stop at
+         * @param debug Debug policy
+         * @return False if the policy stopped the run early
+         */
+        template<typename Debug>
+        bool runUntil(uint64_t cycle, Debug & debug);
+
+        uint64_t cycleCount() const { return cycles; }
+        uint64_t instructionCount() const { return instructions; }
+
+        Fault fault() const { return fault_state; }
+        unsigned short programCounter() const { return pc; }
+        unsigned short indexRegister() const { return I; }
+        unsigned char registerValue(unsigned int index) const { return V[index & 0xF]; }
+        unsigned short stackPointer() const { return sp; }
+        unsigned char delayTimer() const { return timerValue(delay_timer, delay_tick, timerTicks()); }
+        unsigned char soundTimer() const { return timerValue(sound_timer, sound_tick, timerTicks()); }
+
+        /**
+         * @return Timer ticks since initialize()
+         */
+        uint64_t timerTicks() const { return cycles / cycles_per_frame; }
+
+        /**
+         * Set both timers, e.g. when restoring a saved state. Call after setting the cycle count.
+         */
+        void loadTimers(unsigned char delay, unsigned char sound) {
+            delay_timer = delay;
+            sound_timer = sound;
+            delay_tick = sound_tick = timerTicks();
+        }
+
+        /**
+         * Seed the random number generator used by Cxkk.
+         * Two machines with the same program, seed and key events run identically.
+         * @param seed Any value, 0 is replaced by a fixed non-zero seed
+         */
+        void seed(uint32_t seed);
+
+        /**
+         * Select the behaviour of the instructions CHIP-8 variants disagree on, kept across initialize()
+         * @param profile Quirk profile, QUIRKS_MODERN by default
+         */
+        void setQuirks(QuirkProfile profile) { quirk_profile = profile; }
+        QuirkProfile quirks() const { return quirk_profile; }
+
+        /**
+         * Select how long instructions take, kept across initialize(). Cycle counts of one model mean
+         * nothing in another, so pick it before running, like the program.
+         * @param mode Timing model, TIMING_FIXED by default
+         */
+        void setTiming(TimingMode mode);
+        TimingMode timing() const { return timing_mode; }
+
+        /**
+         * @return Cycles per 60 Hz frame of the timing model
+         */
+        uint64_t cyclesPerFrame() const { return cycles_per_frame; }
+
+        /**
+         * Press or release a key. A press ends the wait of Fx0A, the key is stored in its register.
+         * @param key Key 0 to F
+         * @param pressed True when the key goes down
+         */
+        void setKey(uint8_t key, bool pressed) {
+            input.set(key, pressed);
+            if (key_wait != 0 && pressed && input.pressed(key)) {
+                V[key_wait - 1] = key & 0xF;
+                key_wait = 0;
+            }
+        }
+
+        /**
+         * @return True while Fx0A waits for a key press. Runs then only advance the cycle count, without
+         * executing anything, so a host can sleep on its input until a key arrives.
+         */
+        bool waitingForKey() const { return key_wait != 0; }
+        uint16_t keyState() const { return input.state(); }
+
+        /**
+         * @return SCREEN_WIDTH * SCREEN_HEIGHT pixels, one byte each, 1 for a lit pixel
+         */
+        const unsigned char * framebuffer() const { return display.frame(); }
+
+        WriteTracker & writeTracker() { return write_tracker; }
+        const WriteTracker & writeTracker() const { return write_tracker; }
+
+#ifdef CHIP8_PROFILE
+        Profiler & profiler() { return profile; }
+        const Profiler & profiler() const { return profile; }
+#endif
+};
+
+/**
+ * Runs programs without drawing or input, sprites never collide
+ */
+typedef Machine<Memory, NullDisplay, NullInput> HeadlessMachine;
+
+/**
+ * One bit per pixel framebuffer
+ */
+typedef Machine<Memory, PackedDisplay, Keypad> PackedMachine;
+
+/**
+ * Counts the memory accesses of every address
+ */
+typedef Machine<TracingMemory, FrameBuffer, Keypad> TracingMachine;
+
+
+#endif //CHIP8_MACHINE_H
@@ -3,29 +3,56 @@
 //
 
 #include <cstring>
-#include <iostream>
 #include "Memory.h"
 
-Memory::Memory(const unsigned char * memory, unsigned int size): size( size / 2 ) {
-    // Zero-initialize memory member
-    std::memset(this->memory, 0, this->size);
+Memory::Memory(): size( RAM_SIZE ), dirty_pages() {
+    clear();
+}
+
+Memory::Memory(const unsigned char * memory, unsigned int size): Memory() {
+    load(0, memory, size);
+}
 
-    // Shift two chars into one uint16_t
-    unsigned int j = 0;
-    for (unsigned int i = 0; i < this->size; ++i) {
-        this->memory[i] = memory[j] << 8 | memory[j + 1];
-        j += 2;
+void Memory::clear() {
+    // Zero-initialize both views
+    std::memset(bytes, 0, sizeof(bytes));
+    std::memset(words, 0, sizeof(words));
+    dirty_pages = ~uint64_t(0);
+}
+
+void Memory::load(unsigned int address, const unsigned char * data, unsigned int length) {
+    if (address >= RAM_SIZE) {
+        return;
+    }
+    if (length > RAM_SIZE - address) {
+        length = RAM_SIZE - address;
+    }
+
+    if (length == 0) {
+        return;
+    }
+
+    std::memcpy(bytes + address, data, length);
+    syncWords(address, length);
+
+    unsigned int first = address >> PAGE_SHIFT;
+    unsigned int last = (address + length - 1) >> PAGE_SHIFT;
+    for (unsigned int page = first; page <= last; ++page) {
+        dirty_pages |= uint64_t(1) << page;
     }
 }
 
-/**
- * Get instruction from index
- * @param index The index of the instruction to return
- * @return uint16_t instruction
- */
-uint16_t Memory::getOpcode(unsigned int index) {
-    uint16_t instruction = 0;
-//    instruction = stoi(std::to_string(memory[index]) + std::to_string(memory[index + 1]));
+void Memory::syncWords(unsigned int address, unsigned int length) {
+    // The word starting one byte before the range contains its first byte as well
+    unsigned int first = address == 0 ? 0 : address - 1;
+    unsigned int end = address + length;
+    if (end > RAM_SIZE - 1) {
+        end = RAM_SIZE - 1;
+    }
 
-    return instruction;
+    // Shift two chars into one uint16_t, for every byte offset
+    for (unsigned int i = first; i < end; ++i) {
+        words[i] = (uint16_t)(bytes[i] << 8 | bytes[i + 1]);
+    }
+    words[RAM_SIZE - 1] = (uint16_t)(bytes[RAM_SIZE - 1] << 8 | bytes[0]);
 }
@@ -9,21 +9,81 @@
 #include <string>
 #include "includes/globals.h"
 
+/**
+ * Backing store for the 4096 byte address space.
+ *
+ * Next to the byte image a 16-bit view is kept that holds the big-endian word starting at every byte
+ * offset, so fetching an instruction from any (also odd) address is a single aligned load.
+ * All stores go through write(), which keeps both views in sync and marks the 64 byte page that was
+ * written as dirty.
+ */
 struct Memory {
 public:
-    unsigned int size;
-    uint16_t memory[MEMORY_SIZE / 2];
+    static const unsigned int PAGE_SHIFT = 6;
+    static const unsigned int PAGE_SIZE = 1u << PAGE_SHIFT;
+
+    unsigned int size; // Size in bytes
+    uint64_t dirty_pages; // Pages written since the owner last cleared this
+    uint8_t bytes[RAM_SIZE];
+    uint16_t words[RAM_SIZE]; // words[i] == bytes[i] << 8 | bytes[i + 1], wrapping at the end of memory
+
+    /**
+     * A constructor
+     * Zero-initializes the full address space
+     */
+    Memory();
 
     /**
      * A constructor
-     * Stores values as uint16_t, so double bytes
+     * Zero-initializes the full address space and copies an image into it, starting at address 0
      * @param memory Initial memory
      * @param size Memory Size in bytes
      */
     explicit Memory(const unsigned char * memory, unsigned int size);
 
-    uint16_t getOpcode(unsigned int index);
+    /**
+     * Zero the full address space
+     */
+    void clear();
+
+    /**
+     * Copy a block of bytes into memory
+     * @param address Address to store the first byte at
+     * @param data Bytes to copy
+     * @param length Number of bytes, anything beyond the end of memory is dropped
+     */
+    void load(unsigned int address, const unsigned char * data, unsigned int length);
+
+    /**
+     * Get instruction from index
+     * @param index The address of the instruction to return
+     * @return uint16_t instruction
+     */
+    inline uint16_t getOpcode(unsigned int index) const {
+        return words[index & (RAM_SIZE - 1)];
+    }
+
+    inline uint8_t read(unsigned int address) const {
+        return bytes[address & (RAM_SIZE - 1)];
+    }
+
+    inline void write(unsigned int address, uint8_t value) {
+        address &= RAM_SIZE - 1;
+        unsigned int previous = (address - 1) & (RAM_SIZE - 1);
+
+        dirty_pages |= uint64_t(1) << (address >> PAGE_SHIFT);
+        bytes[address] = value;
+        words[address] = (uint16_t)(value << 8 | bytes[(address + 1) & (RAM_SIZE - 1)]);
+        words[previous] = (uint16_t)(bytes[previous] << 8 | value);
+    }
+
 private:
+    /**
+     * Rebuild the word view from the byte image for a range of bytes
+     * @param address First byte that changed
+     * @param length Number of bytes that changed
+     */
+    void syncWords(unsigned int address, unsigned int length);
 };
 
 
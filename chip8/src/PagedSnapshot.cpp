@@ -0,0 +1,147 @@
+//
+// Created by david on 18-10-26.
+//
+
+#include <cstring>
+#include "PagedSnapshot.h"
+
+static_assert(PagedSnapshot::MEMORY_PAGES <= 64, "Memory pages must fit in a 64-bit bitmap");
+static_assert(PagedSnapshot::GFX_PAGES <= 64, "Framebuffer pages must fit in a 64-bit bitmap");
+
+const PageStore::PageId PageStore::NONE;
+
+PageStore::PageId PageStore::add(const uint8_t * bytes) {
+    PageId id;
+    if (free_pages.empty()) {
+        id = (PageId) pages.size();
+        pages.emplace_back();
+    } else {
+        id = free_pages.back();
+        free_pages.pop_back();
+    }
+
+    pages[id].refs = 1;
+    std::memcpy(pages[id].bytes, bytes, PAGE_SIZE);
+    return id;
+}
+
+PagedSnapshot::PagedSnapshot(): cpu(), page_store( nullptr ) {
+    std::fill(memory_pages, memory_pages + MEMORY_PAGES, PageStore::NONE);
+    std::fill(gfx_pages, gfx_pages + GFX_PAGES, PageStore::NONE);
+}
+
+PagedSnapshot::PagedSnapshot(PageStore & store): PagedSnapshot() {
+    page_store = &store;
+}
+
+PagedSnapshot::PagedSnapshot(const PagedSnapshot & other): cpu( other.cpu ), page_store( other.page_store ) {
+    std::memcpy(memory_pages, other.memory_pages, sizeof(memory_pages));
+    std::memcpy(gfx_pages, other.gfx_pages, sizeof(gfx_pages));
+    retainAll();
+}
+
+PagedSnapshot & PagedSnapshot::operator=(const PagedSnapshot & other) {
+    if (this == &other) {
+        return *this;
+    }
+
+    // Retain first, other may share pages with this snapshot
+    PagedSnapshot copy(other);
+    releaseAll();
+
+    cpu = copy.cpu;
+    page_store = copy.page_store;
+    std::memcpy(memory_pages, copy.memory_pages, sizeof(memory_pages));
+    std::memcpy(gfx_pages, copy.gfx_pages, sizeof(gfx_pages));
+    retainAll();
+    return *this;
+}
+
+PagedSnapshot::~PagedSnapshot() {
+    releaseAll();
+}
+
+void PagedSnapshot::retainAll() {
+    if (!page_store) {
+        return;
+    }
+    for (PageStore::PageId id : memory_pages) {
+        if (id != PageStore::NONE) {
+            page_store->retain(id);
+        }
+    }
+    for (PageStore::PageId id : gfx_pages) {
+        if (id != PageStore::NONE) {
+            page_store->retain(id);
+        }
+    }
+}
+
+void PagedSnapshot::releaseAll() {
+    if (!page_store) {
+        return;
+    }
+    for (PageStore::PageId id : memory_pages) {
+        if (id != PageStore::NONE) {
+            page_store->release(id);
+        }
+    }
+    for (PageStore::PageId id : gfx_pages) {
+        if (id != PageStore::NONE) {
+            page_store->release(id);
+        }
+    }
+}
+
+/**
+ * Replace every dirty (or not yet captured) page by a new page from image
+ */
+static void capturePages(PageStore & store, PageStore::PageId * ids, unsigned int count,
+                         const uint8_t * image, uint64_t dirty) {
+    for (unsigned int page = 0; page < count; ++page) {
+        if (ids[page] != PageStore::NONE && !(dirty & (uint64_t(1) << page))) {
+            continue;
+        }
+        if (ids[page] != PageStore::NONE) {
+            store.release(ids[page]);
+        }
+        ids[page] = store.add(image + page * PageStore::PAGE_SIZE);
+    }
+}
+
+void PagedSnapshot::capture(const uint8_t * memory, uint64_t memoryDirty, const uint8_t * gfx, uint64_t gfxDirty) {
+    capturePages(*page_store, memory_pages, MEMORY_PAGES, memory, memoryDirty);
+    capturePages(*page_store, gfx_pages, GFX_PAGES, gfx, gfxDirty);
+}
+
+uint64_t PagedSnapshot::apply(const PagedSnapshot & current, uint64_t memoryDirty, uint64_t gfxDirty,
+                              Memory & memory, uint8_t * gfx) const {
+    if (!page_store) {
+        // Never captured, there is nothing to copy
+        return 0;
+    }
+
+    // Page ids are only comparable within one store
+    if (current.page_store != page_store) {
+        memoryDirty = ~uint64_t(0);
+        gfxDirty = ~uint64_t(0);
+    }
+
+    uint64_t copied = 0;
+    for (unsigned int page = 0; page < MEMORY_PAGES; ++page) {
+        if (memory_pages[page] == current.memory_pages[page] && !(memoryDirty & (uint64_t(1) << page))) {
+            continue;
+        }
+        memory.load(page * PageStore::PAGE_SIZE, page_store->bytes(memory_pages[page]), PageStore::PAGE_SIZE);
+        copied |= uint64_t(1) << page;
+    }
+
+    for (unsigned int page = 0; page < GFX_PAGES; ++page) {
+        if (gfx_pages[page] == current.gfx_pages[page] && !(gfxDirty & (uint64_t(1) << page))) {
+            continue;
+        }
+        std::memcpy(gfx + page * PageStore::PAGE_SIZE, page_store->bytes(gfx_pages[page]), PageStore::PAGE_SIZE);
+    }
+
+    return copied;
+}
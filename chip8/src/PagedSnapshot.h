@@ -0,0 +1,137 @@
+//
+// Created by david on 18-10-26.
+//
+
+#ifndef CHIP8_PAGEDSNAPSHOT_H
+#define CHIP8_PAGEDSNAPSHOT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+#include "Memory.h"
+#include "Snapshot.h"
+
+/**
+ * Pool of immutable, refcounted pages that paged snapshots share.
+ * Pages are referenced by index, which keeps a snapshot's page table small.
+ * Not thread safe, the store must outlive every snapshot and machine that uses it.
+ */
+class PageStore {
+public:
+    static const unsigned int PAGE_SIZE = Memory::PAGE_SIZE;
+
+    typedef uint32_t PageId;
+    static const PageId NONE = 0xFFFFFFFF;
+
+    /**
+     * Add a page with a reference count of one
+     * @param bytes PAGE_SIZE bytes to copy into the page
+     * @return Id of the new page
+     */
+    PageId add(const uint8_t * bytes);
+
+    void retain(PageId id) {
+        ++pages[id].refs;
+    }
+
+    void release(PageId id) {
+        if (--pages[id].refs == 0) {
+            free_pages.push_back(id);
+        }
+    }
+
+    const uint8_t * bytes(PageId id) const {
+        return pages[id].bytes;
+    }
+
+    /**
+     * @return Number of pages referenced by at least one snapshot or machine
+     */
+    size_t pageCount() const {
+        return pages.size() - free_pages.size();
+    }
+
+    /**
+     * @return Bytes allocated for pages, including free ones
+     */
+    size_t bytesAllocated() const {
+        return pages.size() * sizeof(Page) + free_pages.capacity() * sizeof(PageId);
+    }
+
+private:
+    struct Page {
+        uint32_t refs;
+        uint8_t bytes[PAGE_SIZE];
+    };
+
+    std::deque<Page> pages;
+    std::vector<PageId> free_pages;
+};
+
+/**
+ * Machine state with memory and framebuffer split into pages that live in a PageStore.
+ *
+ * Snapshots taken from the same machine share every page that did not change in between, so a
+ * snapshot costs its CPU state, its page table and the pages that were written since the previous one.
+ * Copying a paged snapshot only copies the page table.
+ */
+class PagedSnapshot {
+public:
+    static const unsigned int MEMORY_PAGES = RAM_SIZE / PageStore::PAGE_SIZE;
+    static const unsigned int GFX_PAGES = SCREEN_WIDTH * SCREEN_HEIGHT / PageStore::PAGE_SIZE;
+
+    CpuState cpu;
+
+    /**
+     * A constructor
+     * Creates an empty snapshot that is not attached to a store
+     */
+    PagedSnapshot();
+
+    /**
+     * A constructor
+     * Creates an empty snapshot attached to a store
+     * @param store Store to take pages from
+     */
+    explicit PagedSnapshot(PageStore & store);
+
+    PagedSnapshot(const PagedSnapshot & other);
+    PagedSnapshot & operator=(const PagedSnapshot & other);
+    ~PagedSnapshot();
+
+    PageStore * store() const { return page_store; }
+
+    /**
+     * Replace the pages that changed by new pages
+     * @param memory Memory image, RAM_SIZE bytes
+     * @param memoryDirty Bitmap of memory pages that have been written since this snapshot was taken
+     * @param gfx Framebuffer, SCREEN_WIDTH * SCREEN_HEIGHT bytes
+     * @param gfxDirty Bitmap of framebuffer pages that have been written since this snapshot was taken
+     */
+    void capture(const uint8_t * memory, uint64_t memoryDirty, const uint8_t * gfx, uint64_t gfxDirty);
+
+    /**
+     * Copy the pages of this snapshot into a machine's memory and framebuffer, skipping pages that are
+     * known to be in there already
+     * @param current Snapshot that memory and gfx were restored from or captured into last
+     * @param memoryDirty Bitmap of memory pages that have been written since current
+     * @param gfxDirty Bitmap of framebuffer pages that have been written since current
+     * @param memory Memory to copy into
+     * @param gfx Framebuffer to copy into
+     * @return Bitmap of memory pages that were copied
+     */
+    uint64_t apply(const PagedSnapshot & current, uint64_t memoryDirty, uint64_t gfxDirty,
+                   Memory & memory, uint8_t * gfx) const;
+
+private:
+    PageStore * page_store;
+    PageStore::PageId memory_pages[MEMORY_PAGES];
+    PageStore::PageId gfx_pages[GFX_PAGES];
+
+    void retainAll();
+    void releaseAll();
+};
+
+
+#endif //CHIP8_PAGEDSNAPSHOT_H
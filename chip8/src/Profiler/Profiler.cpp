@@ -0,0 +1,175 @@
+//
+// Created by david on 18-10-26.
+//
+
+#include <cstring>
+#include <fstream>
+#include "Profiler.h"
+
+volatile std::sig_atomic_t Profiler::dump_requested = 0;
+
+static const char * const OPCODE_NAMES[Profiler::OPCODE_CLASSES] = {
+        "0nnn SYS", "00E0 CLS", "00EE RET", "1nnn JP", "2nnn CALL", "3xkk SE", "4xkk SNE", "5xy0 SE",
+        "6xkk LD", "7xkk ADD", "8xy0 LD", "8xy1 OR", "8xy2 AND", "8xy3 XOR", "8xy4 ADD", "8xy5 SUB",
+        "8xy6 SHR", "8xy7 SUBN", "8xyE SHL", "9xy0 SNE", "Annn LD", "Bnnn JP", "Cxkk RND", "Dxyn DRW",
+        "Ex9E SKP", "ExA1 SKNP", "Fx07 LD", "Fx0A LD", "Fx15 LD", "Fx18 LD", "Fx1E ADD", "Fx29 LD",
+        "Fx33 LD", "Fx55 LD", "Fx65 LD", "unknown",
+};
+
+Profiler::Profiler(): counters() {}
+
+void Profiler::reset() {
+    std::memset(&counters, 0, sizeof(counters));
+}
+
+void Profiler::sprite(const Memory & memory, unsigned short address, unsigned int rows) {
+    ++counters.sprites;
+    for (unsigned int row = 0; row < rows; ++row) {
+        uint8_t bits = memory.read((unsigned short) (address + row));
+        while (bits) {
+            bits &= bits - 1;
+            ++counters.pixels;
+        }
+    }
+}
+
+Profiler::OpcodeClass Profiler::classify(unsigned short opcode) {
+    switch (opcode & 0xF000) {
+        case 0x0000:
+            if (opcode == 0x00E0) {
+                return OP_CLS;
+            }
+            if (opcode == 0x00EE) {
+                return OP_RET;
+            }
+            // The interpreter decodes all of 00Ex and faults on the others
+            return (opcode & 0x0FF0) == 0x00E0 ? OP_UNKNOWN : OP_SYS;
+        case 0x1000:
+            return OP_JP;
+        case 0x2000:
+            return OP_CALL;
+        case 0x3000:
+            return OP_SE_BYTE;
+        case 0x4000:
+            return OP_SNE_BYTE;
+        case 0x5000:
+            return (opcode & 0x000F) == 0 ? OP_SE_REG : OP_UNKNOWN;
+        case 0x6000:
+            return OP_LD_BYTE;
+        case 0x7000:
+            return OP_ADD_BYTE;
+        case 0x8000:
+            switch (opcode & 0x000F) {
+                case 0x0: return OP_LD_REG;
+                case 0x1: return OP_OR;
+                case 0x2: return OP_AND;
+                case 0x3: return OP_XOR;
+                case 0x4: return OP_ADD_REG;
+                case 0x5: return OP_SUB;
+                case 0x6: return OP_SHR;
+                case 0x7: return OP_SUBN;
+                case 0xE: return OP_SHL;
+                default: return OP_UNKNOWN;
+            }
+        case 0x9000:
+            return (opcode & 0x000F) == 0 ? OP_SNE_REG : OP_UNKNOWN;
+        case 0xA000:
+            return OP_LD_I;
+        case 0xB000:
+            return OP_JP_V0;
+        case 0xC000:
+            return OP_RND;
+        case 0xD000:
+            return OP_DRW;
+        case 0xE000:
+            switch (opcode & 0x00FF) {
+                case 0x9E: return OP_SKP;
+                case 0xA1: return OP_SKNP;
+                default: return OP_UNKNOWN;
+            }
+        default:
+            switch (opcode & 0x00FF) {
+                case 0x07: return OP_LD_VX_DT;
+                case 0x0A: return OP_LD_VX_K;
+                case 0x15: return OP_LD_DT_VX;
+                case 0x18: return OP_LD_ST_VX;
+                case 0x1E: return OP_ADD_I;
+                case 0x29: return OP_LD_F;
+                case 0x33: return OP_LD_B;
+                case 0x55: return OP_LD_MEM_VX;
+                case 0x65: return OP_LD_VX_MEM;
+                default: return OP_UNKNOWN;
+            }
+    }
+}
+
+const char * Profiler::name(OpcodeClass opcodeClass) {
+    return opcodeClass < OPCODE_CLASSES ? OPCODE_NAMES[opcodeClass] : "";
+}
+
+void Profiler::writeJson(std::ostream & out) const {
+    out << "{\n  \"instructions\": " << counters.instructions
+        << ",\n  \"sprites\": " << counters.sprites
+        << ",\n  \"pixels\": " << counters.pixels
+        << ",\n  \"timer_polls\": " << counters.timer_polls
+        << ",\n  \"opcodes\": {";
+
+    for (unsigned int i = 0; i < OPCODE_CLASSES; ++i) {
+        out << (i ? ",\n    \"" : "\n    \"") << OPCODE_NAMES[i] << "\": " << counters.opcodes[i];
+    }
+
+    out << "\n  },\n  \"pcs\": {";
+    bool first = true;
+    for (unsigned int pc = 0; pc < RAM_SIZE; ++pc) {
+        if (counters.pcs[pc] == 0) {
+            continue;
+        }
+        out << (first ? "\n    \"0x" : ",\n    \"0x") << std::hex << pc << std::dec << "\": " << counters.pcs[pc];
+        first = false;
+    }
+    out << "\n  }\n}\n";
+}
+
+void Profiler::writeCsv(std::ostream & out) const {
+    out << "kind,key,count\n"
+        << "total,instructions," << counters.instructions << "\n"
+        << "total,sprites," << counters.sprites << "\n"
+        << "total,pixels," << counters.pixels << "\n"
+        << "total,timer_polls," << counters.timer_polls << "\n";
+
+    for (unsigned int i = 0; i < OPCODE_CLASSES; ++i) {
+        out << "opcode," << OPCODE_NAMES[i] << "," << counters.opcodes[i] << "\n";
+    }
+    for (unsigned int pc = 0; pc < RAM_SIZE; ++pc) {
+        if (counters.pcs[pc] != 0) {
+            out << "pc,0x" << std::hex << pc << std::dec << "," << counters.pcs[pc] << "\n";
+        }
+    }
+}
+
+bool Profiler::writeFile(const std::string & path) const {
+    std::ofstream out(path, std::ios::out | std::ios::trunc);
+    if (!out) {
+        return false;
+    }
+
+    bool csv = path.size() >= 4 && path.compare(path.size() - 4, 4, ".csv") == 0;
+    if (csv) {
+        writeCsv(out);
+    } else {
+        writeJson(out);
+    }
+    return (bool) out;
+}
+
+bool Profiler::dump() const {
+    return output.empty() || writeFile(output);
+}
+
+bool Profiler::takeDumpRequest() {
+    if (!dump_requested) {
+        return false;
+    }
+    dump_requested = 0;
+    return true;
+}
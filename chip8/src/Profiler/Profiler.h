@@ -0,0 +1,158 @@
+//
+// Created by david on 18-10-26.
+//
+
+#ifndef CHIP8_PROFILER_H
+#define CHIP8_PROFILER_H
+
+#include <csignal>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include "../Memory.h"
+
+/**
+ * Execution counters of one machine: instructions per opcode class, a histogram of executed addresses,
+ * sprites and pixels drawn and timer loop iterations.
+ *
+ * The interpreter only updates the counters when built with CHIP8_PROFILE defined (the CHIP8_PROFILE
+ * CMake option), otherwise the profiler isn't even part of the machine.
+ */
+class Profiler {
+public:
+    /**
+     * The 35 CHIP-8 instructions, plus everything that doesn't decode
+     */
+    enum OpcodeClass : uint8_t {
+        OP_SYS, // 0nnn
+        OP_CLS, // 00E0
+        OP_RET, // 00EE
+        OP_JP, // 1nnn
+        OP_CALL, // 2nnn
+        OP_SE_BYTE, // 3xkk
+        OP_SNE_BYTE, // 4xkk
+        OP_SE_REG, // 5xy0
+        OP_LD_BYTE, // 6xkk
+        OP_ADD_BYTE, // 7xkk
+        OP_LD_REG, // 8xy0
+        OP_OR, // 8xy1
+        OP_AND, // 8xy2
+        OP_XOR, // 8xy3
+        OP_ADD_REG, // 8xy4
+        OP_SUB, // 8xy5
+        OP_SHR, // 8xy6
+        OP_SUBN, // 8xy7
+        OP_SHL, // 8xyE
+        OP_SNE_REG, // 9xy0
+        OP_LD_I, // Annn
+        OP_JP_V0, // Bnnn
+        OP_RND, // Cxkk
+        OP_DRW, // Dxyn
+        OP_SKP, // Ex9E
+        OP_SKNP, // ExA1
+        OP_LD_VX_DT, // Fx07
+        OP_LD_VX_K, // Fx0A
+        OP_LD_DT_VX, // Fx15
+        OP_LD_ST_VX, // Fx18
+        OP_ADD_I, // Fx1E
+        OP_LD_F, // Fx29
+        OP_LD_B, // Fx33
+        OP_LD_MEM_VX, // Fx55
+        OP_LD_VX_MEM, // Fx65
+        OP_UNKNOWN,
+        OPCODE_CLASSES
+    };
+
+    struct Counters {
+        uint64_t instructions;
+        uint64_t opcodes[OPCODE_CLASSES];
+        uint64_t pcs[RAM_SIZE]; // Executions per address
+        uint64_t sprites; // Dxyn executed
+        uint64_t pixels; // Sprite pixels drawn, i.e. set bits in the sprites
+        uint64_t timer_polls; // Iterations of the timer loop
+    };
+
+    Profiler();
+
+    void reset();
+
+    /**
+     * Count an instruction about to be executed
+     */
+    inline void instruction(unsigned short pc, unsigned short opcode) {
+        ++counters.instructions;
+        ++counters.pcs[pc & 0x0FFF];
+        ++counters.opcodes[classify(opcode)];
+    }
+
+    /**
+     * Count a Dxyn
+     * @param memory Memory the sprite is read from
+     * @param address Address of the sprite
+     * @param rows Height of the sprite
+     */
+    void sprite(const Memory & memory, unsigned short address, unsigned int rows);
+
+    inline void timerPoll() {
+        ++counters.timer_polls;
+    }
+
+    const Counters & statistics() const { return counters; }
+
+    /**
+     * Replace all counters, e.g. by ones taken with statistics() before a run that didn't really happen
+     */
+    void load(const Counters & saved) { counters = saved; }
+
+    static OpcodeClass classify(unsigned short opcode);
+
+    static const char * name(OpcodeClass opcodeClass);
+
+    /**
+     * Write all counters as one JSON object, only addresses that were executed are listed
+     */
+    void writeJson(std::ostream & out) const;
+
+    /**
+     * Write all counters as CSV with the columns kind, key and count
+     */
+    void writeCsv(std::ostream & out) const;
+
+    /**
+     * Write the counters to a file, as CSV if the path ends in .csv and as JSON otherwise
+     * @return False if the file couldn't be written
+     */
+    bool writeFile(const std::string & path) const;
+
+    /**
+     * Set the file dump() writes to, see writeFile()
+     */
+    void setOutput(const std::string & path) { output = path; }
+
+    /**
+     * Write the counters to the output file, if there is one
+     * @return False if the output file couldn't be written
+     */
+    bool dump() const;
+
+    /**
+     * Ask for a dump of the counters, safe to call from a signal handler
+     */
+    static void requestDump() {
+        dump_requested = 1;
+    }
+
+    /**
+     * @return Whether a dump was requested since the last call
+     */
+    static bool takeDumpRequest();
+
+private:
+    Counters counters;
+    std::string output;
+
+    static volatile std::sig_atomic_t dump_requested;
+};
+
+
+#endif //CHIP8_PROFILER_H
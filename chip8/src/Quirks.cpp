@@ -0,0 +1,21 @@
+//
+// Created by david on 18-10-26.
+//
+
+#include "Quirks.h"
+
+static const char * const NAMES[] = {"modern", "vip", "schip", "xochip"};
+
+const char * quirksName(QuirkProfile profile) {
+    return profile <= QUIRKS_XOCHIP ? NAMES[profile] : "unknown";
+}
+
+bool parseQuirks(const std::string & name, QuirkProfile & profile) {
+    for (unsigned int i = 0; i <= QUIRKS_XOCHIP; ++i) {
+        if (name == NAMES[i]) {
+            profile = (QuirkProfile) i;
+            return true;
+        }
+    }
+    return false;
+}
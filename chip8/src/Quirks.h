@@ -0,0 +1,77 @@
+//
+// Created by david on 18-10-26.
+//
+
+#ifndef CHIP8_QUIRKS_H
+#define CHIP8_QUIRKS_H
+
+#include <cstdint>
+#include <string>
+
+/**
+ * Behaviour the CHIP-8 variants disagree on.
+ *
+ * Every profile is a type with constexpr flags, the interpreter is instantiated once per profile so the
+ * handlers of a profile contain only its own behaviour and no quirk checks. The profile of a machine is
+ * picked at load time with chip8::setQuirks().
+ */
+enum QuirkProfile : uint8_t {
+    QUIRKS_MODERN, // What most current interpreters and Cowgod's reference do
+    QUIRKS_VIP, // The original COSMAC VIP interpreter
+    QUIRKS_SCHIP, // SUPER-CHIP 1.1
+    QUIRKS_XOCHIP, // XO-CHIP
+};
+
+struct ModernQuirks {
+    static constexpr QuirkProfile PROFILE = QUIRKS_MODERN;
+    static constexpr bool SHIFT_VY = false; // 8xy6/8xyE shift Vy into Vx instead of shifting Vx itself
+    static constexpr bool LOAD_STORE_INCREMENTS_I = false; // Fx55/Fx65 leave I pointing past the last register
+    static constexpr bool JUMP_VX = false; // Bxnn jumps to xnn + Vx instead of nnn + V0
+    static constexpr bool LOGIC_RESETS_VF = false; // 8xy1/8xy2/8xy3 set VF to 0
+    static constexpr bool CLIP_SPRITES = false; // Dxyn clips at the screen edges instead of wrapping around
+    static constexpr bool DISPLAY_WAIT = false; // Dxyn waits for the next frame before drawing
+};
+
+struct VipQuirks {
+    static constexpr QuirkProfile PROFILE = QUIRKS_VIP;
+    static constexpr bool SHIFT_VY = true;
+    static constexpr bool LOAD_STORE_INCREMENTS_I = true;
+    static constexpr bool JUMP_VX = false;
+    static constexpr bool LOGIC_RESETS_VF = true;
+    static constexpr bool CLIP_SPRITES = true;
+    static constexpr bool DISPLAY_WAIT = true;
+};
+
+struct SchipQuirks {
+    static constexpr QuirkProfile PROFILE = QUIRKS_SCHIP;
+    static constexpr bool SHIFT_VY = false;
+    static constexpr bool LOAD_STORE_INCREMENTS_I = false;
+    static constexpr bool JUMP_VX = true;
+    static constexpr bool LOGIC_RESETS_VF = false;
+    static constexpr bool CLIP_SPRITES = true;
+    static constexpr bool DISPLAY_WAIT = false;
+};
+
+struct XochipQuirks {
+    static constexpr QuirkProfile PROFILE = QUIRKS_XOCHIP;
+    static constexpr bool SHIFT_VY = true;
+    static constexpr bool LOAD_STORE_INCREMENTS_I = true;
+    static constexpr bool JUMP_VX = false;
+    static constexpr bool LOGIC_RESETS_VF = false;
+    static constexpr bool CLIP_SPRITES = false;
+    static constexpr bool DISPLAY_WAIT = false;
+};
+
+/**
+ * @return Name of a profile as parseQuirks() accepts it
+ */
+const char * quirksName(QuirkProfile profile);
+
+/**
+ * @param name modern, vip, schip or xochip
+ * @param profile Set to the named profile
+ * @return False if there is no profile by that name
+ */
+bool parseQuirks(const std::string & name, QuirkProfile & profile);
+
+#endif //CHIP8_QUIRKS_H
@@ -0,0 +1,45 @@
+//
+// Created by david on 18-10-26.
+//
+
+#include <type_traits>
+#include "InputLog.h"
+
+static_assert(std::is_trivially_copyable<InputEvent>::value && sizeof(InputEvent) == 16,
+              "InputEvent is written to disk as is");
+
+namespace {
+    struct Header {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t seed;
+        uint32_t reserved;
+        uint64_t rom_hash;
+        uint64_t end_cycle;
+        uint64_t event_count;
+    };
+}
+
+InputLog::InputLog(): seed(), rom_hash(), end_cycle() {}
+
+bool InputLog::write(std::ostream & out) const {
+    Header header = {MAGIC, VERSION, seed, 0, rom_hash, end_cycle, events.size()};
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char *>(events.data()), events.size() * sizeof(InputEvent));
+    return out.good();
+}
+
+bool InputLog::read(std::istream & in, InputLog & log) {
+    Header header;
+    in.read(reinterpret_cast<char *>(&header), sizeof(header));
+    if (!in.good() || header.magic != MAGIC || header.version != VERSION) {
+        return false;
+    }
+
+    log.seed = header.seed;
+    log.rom_hash = header.rom_hash;
+    log.end_cycle = header.end_cycle;
+    log.events.resize(header.event_count);
+    in.read(reinterpret_cast<char *>(log.events.data()), header.event_count * sizeof(InputEvent));
+    return (size_t) in.gcount() == header.event_count * sizeof(InputEvent);
+}
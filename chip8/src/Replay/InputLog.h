@@ -0,0 +1,55 @@
+//
+// Created by david on 18-10-26.
+//
+
+#ifndef CHIP8_INPUTLOG_H
+#define CHIP8_INPUTLOG_H
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <vector>
+
+/**
+ * A key press or release, stamped with the cycle count before which it takes effect
+ */
+struct InputEvent {
+    uint64_t cycle;
+    uint8_t key;
+    uint8_t pressed;
+    uint8_t reserved[6];
+};
+
+/**
+ * Everything needed on top of the program to reproduce a run: the RNG seed and every key event.
+ * Events are ordered by cycle.
+ */
+struct InputLog {
+    static const uint32_t MAGIC = 0x4C493843; // "C8IL"
+    static const uint32_t VERSION = 1;
+
+    uint32_t seed;
+    uint64_t rom_hash; // fnv1a() of the program the log was recorded with
+    uint64_t end_cycle; // Cycle count at the end of the recording
+    std::vector<InputEvent> events;
+
+    InputLog();
+
+    /**
+     * Write the log to a binary stream
+     * @param out Stream to write to
+     * @return true if the stream is still good
+     */
+    bool write(std::ostream & out) const;
+
+    /**
+     * Read a log from a binary stream
+     * @param in Stream to read from
+     * @param log Destination
+     * @return false on a read error or on an unknown magic or version
+     */
+    static bool read(std::istream & in, InputLog & log);
+};
+
+
+#endif //CHIP8_INPUTLOG_H
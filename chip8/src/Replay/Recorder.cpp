@@ -0,0 +1,66 @@
+//
+// Created by david on 18-10-26.
+//
+
+#include "Recorder.h"
+#include "ReplayFile.h"
+#include "../chip8.h"
+
+Recorder::Recorder(chip8 & machine, uint32_t seed, uint64_t romHash, ReplayWriter * writer):
+        machine( machine ), writer( writer ), next_keyframe() {
+    input_log.seed = seed;
+    input_log.rom_hash = romHash;
+    machine.seed(seed);
+
+    // The first keyframe makes the replay file self-contained
+    frame();
+}
+
+void Recorder::setKey(uint8_t key, bool pressed) {
+    machine.setKey(key, pressed);
+
+    InputEvent event = {machine.cycleCount(), key, (uint8_t) pressed, {}};
+    input_log.events.push_back(event);
+    if (writer) {
+        writer->event(event);
+    }
+}
+
+void Recorder::frame() {
+    if (!writer || machine.cycleCount() < next_keyframe) {
+        return;
+    }
+
+    Snapshot snapshot;
+    machine.snapshot(snapshot);
+    writer->keyframe(snapshot);
+    next_keyframe = machine.cycleCount() + writer->keyframeInterval();
+}
+
+const InputLog & Recorder::finish() {
+    input_log.end_cycle = machine.cycleCount();
+    if (writer) {
+        writer->close(input_log.end_cycle);
+    }
+    return input_log;
+}
+
+Replayer::Replayer(const InputLog & log): input_log( log ), next_event() {}
+
+void Replayer::start(chip8 & machine) {
+    machine.seed(input_log.seed);
+    next_event = 0;
+}
+
+void Replayer::runUntil(chip8 & machine, uint64_t cycle) {
+    while (next_event < input_log.events.size() && input_log.events[next_event].cycle <= cycle) {
+        const InputEvent & event = input_log.events[next_event++];
+        machine.runUntil(event.cycle);
+        machine.setKey(event.key, event.pressed != 0);
+    }
+    machine.runUntil(cycle);
+}
+
+bool Replayer::finished(const chip8 & machine) const {
+    return machine.cycleCount() >= input_log.end_cycle;
+}
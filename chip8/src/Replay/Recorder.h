@@ -0,0 +1,81 @@
+//
+// Created by david on 18-10-26.
+//
+
+#ifndef CHIP8_RECORDER_H
+#define CHIP8_RECORDER_H
+
+#include "InputLog.h"
+
+class chip8;
+class ReplayWriter;
+
+/**
+ * Records a run into an InputLog, and optionally into a replay file.
+ * Key events have to go through the recorder instead of straight to the machine.
+ */
+class Recorder {
+public:
+    /**
+     * A constructor
+     * Seeds the machine, which must have just been initialized and had its program loaded
+     * @param machine Machine to record
+     * @param seed RNG seed for the run
+     * @param romHash fnv1a() of the loaded program
+     * @param writer Replay file to write events and keyframes to as well, may be null
+     */
+    Recorder(chip8 & machine, uint32_t seed, uint64_t romHash, ReplayWriter * writer = nullptr);
+
+    void setKey(uint8_t key, bool pressed);
+
+    /**
+     * Call at every frame boundary, writes a keyframe to the replay file when one is due
+     */
+    void frame();
+
+    /**
+     * Stamp the log with the current cycle count as its end
+     * @return The complete log
+     */
+    const InputLog & finish();
+
+    const InputLog & log() const { return input_log; }
+
+private:
+    chip8 & machine;
+    InputLog input_log;
+    ReplayWriter * writer;
+    uint64_t next_keyframe;
+};
+
+/**
+ * Plays an InputLog back into a machine, applying every key event before the cycle it was recorded at.
+ * Nothing is throttled, the replay runs as fast as the interpreter does.
+ */
+class Replayer {
+public:
+    explicit Replayer(const InputLog & log);
+
+    /**
+     * Seed the machine, which must have just been initialized and had the recorded program loaded
+     */
+    void start(chip8 & machine);
+
+    /**
+     * Run the machine up to a cycle count, applying the events on the way
+     */
+    void runUntil(chip8 & machine, uint64_t cycle);
+
+    void runToEnd(chip8 & machine) {
+        runUntil(machine, input_log.end_cycle);
+    }
+
+    bool finished(const chip8 & machine) const;
+
+private:
+    const InputLog & input_log;
+    size_t next_event;
+};
+
+
+#endif //CHIP8_RECORDER_H
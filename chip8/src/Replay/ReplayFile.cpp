@@ -0,0 +1,235 @@
+//
+// Created by david on 18-10-26.
+//
+
+#include <algorithm>
+#include <cstring>
+#include "ReplayFile.h"
+#include "../chip8.h"
+
+using namespace replay;
+
+static const size_t EVENTS_PER_CHUNK = 4096;
+static const size_t FILE_BUFFER_SIZE = 1 << 20;
+
+ReplayWriter::ReplayWriter(const std::string & path, uint32_t seed, uint64_t romHash, QuirkProfile quirks,
+                           TimingMode timing, uint64_t keyframeInterval):
+        header{MAGIC, VERSION, seed, quirks, timing, {}, romHash, keyframeInterval}, offset( sizeof(Header) ), closed(),
+        file_buffer( FILE_BUFFER_SIZE ), stopping(), failed() {
+    // Large buffer, so the writer thread hits the disk in big blocks
+    out.rdbuf()->pubsetbuf(file_buffer.data(), file_buffer.size());
+    out.open(path, std::ios::out | std::ios::binary | std::ios::trunc);
+    failed = !out.good();
+
+    staging.reserve(sizeof(Snapshot) * 2);
+    staging.insert(staging.end(), reinterpret_cast<const uint8_t *>(&header),
+                   reinterpret_cast<const uint8_t *>(&header) + sizeof(header));
+
+    thread = std::thread(&ReplayWriter::writerLoop, this);
+}
+
+ReplayWriter::~ReplayWriter() {
+    if (!closed) {
+        close(index.empty() ? 0 : index.back().cycle);
+    }
+}
+
+bool ReplayWriter::good() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return !failed;
+}
+
+void ReplayWriter::event(const InputEvent & event) {
+    events.push_back(event);
+    if (events.size() >= EVENTS_PER_CHUNK) {
+        flushEvents();
+    }
+}
+
+void ReplayWriter::keyframe(const Snapshot & snapshot) {
+    // Events before the keyframe are part of its state
+    flushEvents();
+
+    index.push_back(IndexEntry{snapshot.cpu.cycles, offset});
+    append(CHUNK_KEYFRAME, &snapshot, sizeof(snapshot));
+    submit();
+}
+
+void ReplayWriter::close(uint64_t endCycle) {
+    if (closed) {
+        return;
+    }
+    closed = true;
+
+    flushEvents();
+
+    Footer footer = {offset, endCycle, FOOTER_MAGIC, 0};
+    append(CHUNK_INDEX, index.data(), index.size() * sizeof(IndexEntry));
+    staging.insert(staging.end(), reinterpret_cast<const uint8_t *>(&footer),
+                   reinterpret_cast<const uint8_t *>(&footer) + sizeof(footer));
+    offset += sizeof(footer);
+    submit();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeup.notify_one();
+    thread.join();
+    out.close();
+}
+
+void ReplayWriter::append(uint32_t type, const void * data, size_t size) {
+    ChunkHeader chunk = {type, (uint32_t) size};
+    const uint8_t * bytes = static_cast<const uint8_t *>(data);
+
+    staging.insert(staging.end(), reinterpret_cast<const uint8_t *>(&chunk),
+                   reinterpret_cast<const uint8_t *>(&chunk) + sizeof(chunk));
+    staging.insert(staging.end(), bytes, bytes + size);
+    offset += sizeof(chunk) + size;
+}
+
+void ReplayWriter::flushEvents() {
+    if (events.empty()) {
+        return;
+    }
+    append(CHUNK_EVENTS, events.data(), events.size() * sizeof(InputEvent));
+    events.clear();
+}
+
+void ReplayWriter::submit() {
+    if (staging.empty()) {
+        return;
+    }
+
+    std::vector<uint8_t> next;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        queue.push_back(std::move(staging));
+        if (!spare_buffers.empty()) {
+            next = std::move(spare_buffers.back());
+            spare_buffers.pop_back();
+        }
+    }
+    wakeup.notify_one();
+
+    // Reuse buffers the writer thread is done with, so recording doesn't allocate
+    staging = std::move(next);
+    staging.clear();
+}
+
+void ReplayWriter::writerLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+        wakeup.wait(lock, [this]() { return stopping || !queue.empty(); });
+        if (queue.empty()) {
+            break;
+        }
+
+        std::vector<uint8_t> buffer = std::move(queue.front());
+        queue.pop_front();
+
+        lock.unlock();
+        out.write(reinterpret_cast<const char *>(buffer.data()), buffer.size());
+        bool ok = out.good();
+        lock.lock();
+
+        failed = failed || !ok;
+        spare_buffers.push_back(std::move(buffer));
+    }
+    out.flush();
+    failed = failed || !out.good();
+}
+
+ReplayReader::ReplayReader(const std::string & path):
+        in( path, std::ios::in | std::ios::binary ), valid(), header(), footer(), cursor(), next_pending() {
+    in.read(reinterpret_cast<char *>(&header), sizeof(header));
+    if (!in.good() || header.magic != MAGIC || header.version != VERSION) {
+        return;
+    }
+
+    in.seekg(-(std::streamoff) sizeof(Footer), std::ios::end);
+    in.read(reinterpret_cast<char *>(&footer), sizeof(footer));
+    if (!in.good() || footer.magic != FOOTER_MAGIC) {
+        return;
+    }
+
+    ChunkHeader chunk;
+    in.seekg((std::streamoff) footer.index_offset);
+    in.read(reinterpret_cast<char *>(&chunk), sizeof(chunk));
+    if (!in.good() || chunk.type != CHUNK_INDEX || chunk.size % sizeof(IndexEntry) != 0) {
+        return;
+    }
+    index.resize(chunk.size / sizeof(IndexEntry));
+    in.read(reinterpret_cast<char *>(index.data()), chunk.size);
+
+    valid = in.good();
+    cursor = sizeof(Header);
+}
+
+bool ReplayReader::seek(chip8 & machine, uint64_t cycle) {
+    if (!valid) {
+        return false;
+    }
+
+    auto keyframe = std::upper_bound(index.begin(), index.end(), cycle,
+                                     [](uint64_t value, const IndexEntry & entry) { return value < entry.cycle; });
+    if (keyframe == index.begin()) {
+        return false;
+    }
+    --keyframe;
+
+    ChunkHeader chunk;
+    Snapshot snapshot;
+    in.clear();
+    in.seekg((std::streamoff) keyframe->offset);
+    in.read(reinterpret_cast<char *>(&chunk), sizeof(chunk));
+    in.read(reinterpret_cast<char *>(&snapshot), sizeof(snapshot));
+    if (!in.good() || chunk.type != CHUNK_KEYFRAME || snapshot.magic != Snapshot::MAGIC
+        || snapshot.version != Snapshot::VERSION || snapshot.cpu.quirks != header.quirks
+        || snapshot.cpu.timing != header.timing) {
+        return false;
+    }
+    machine.restore(snapshot);
+
+    cursor = keyframe->offset + sizeof(chunk) + chunk.size;
+    pending.clear();
+    next_pending = 0;
+
+    runUntil(machine, cycle);
+    return true;
+}
+
+void ReplayReader::runUntil(chip8 & machine, uint64_t cycle) {
+    while (fillPending() && pending[next_pending].cycle <= cycle) {
+        const InputEvent & event = pending[next_pending++];
+        machine.runUntil(event.cycle);
+        machine.setKey(event.key, event.pressed != 0);
+    }
+    machine.runUntil(cycle);
+}
+
+bool ReplayReader::fillPending() {
+    while (next_pending >= pending.size()) {
+        if (!valid || cursor >= footer.index_offset) {
+            return false;
+        }
+
+        ChunkHeader chunk;
+        in.clear();
+        in.seekg((std::streamoff) cursor);
+        in.read(reinterpret_cast<char *>(&chunk), sizeof(chunk));
+        if (!in.good()) {
+            return false;
+        }
+        cursor += sizeof(chunk) + chunk.size;
+
+        // Keyframes are skipped, playing on is cheaper than restoring
+        if (chunk.type == CHUNK_EVENTS) {
+            pending.resize(chunk.size / sizeof(InputEvent));
+            in.read(reinterpret_cast<char *>(pending.data()), chunk.size);
+            next_pending = 0;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,191 @@
+//
+// Created by david on 18-10-26.
+//
+
+#ifndef CHIP8_REPLAYFILE_H
+#define CHIP8_REPLAYFILE_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "InputLog.h"
+#include "../Quirks.h"
+#include "../Snapshot.h"
+#include "../Timing.h"
+
+class chip8;
+
+/**
+ * Replay container with random access.
+ *
+ * Layout: a header, then a sequence of chunks (key events, or a keyframe snapshot), then an index chunk
+ * listing the cycle and file offset of every keyframe, then a fixed size footer pointing at the index.
+ * The first keyframe is taken at the start of the recording, so a replay file contains the program too.
+ * Seeking restores the last keyframe at or before the target and replays the events from there.
+ * The header records the quirk profile and timing model, a replay only plays back with the ones it was
+ * recorded with.
+ */
+namespace replay {
+    static const uint32_t MAGIC = 0x50523843; // "C8RP"
+    static const uint32_t FOOTER_MAGIC = 0x49523843; // "C8RI"
+    static const uint32_t VERSION = 3;
+
+    enum ChunkType : uint32_t {
+        CHUNK_EVENTS = 1,
+        CHUNK_KEYFRAME = 2,
+        CHUNK_INDEX = 3,
+    };
+
+    struct Header {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t seed;
+        uint8_t quirks; // QuirkProfile of the recorded run
+        uint8_t timing; // TimingMode of the recorded run, the unit of every cycle count in the file
+        uint8_t reserved[2];
+        uint64_t rom_hash;
+        uint64_t keyframe_interval; // Cycles between keyframes
+    };
+
+    struct ChunkHeader {
+        uint32_t type;
+        uint32_t size; // Payload size in bytes
+    };
+
+    struct IndexEntry {
+        uint64_t cycle;
+        uint64_t offset; // File offset of the keyframe's chunk header
+    };
+
+    struct Footer {
+        uint64_t index_offset;
+        uint64_t end_cycle;
+        uint32_t magic;
+        uint32_t reserved;
+    };
+}
+
+/**
+ * Writes a replay file on a background thread.
+ * The emulation thread only appends to an in-memory buffer, which is handed to the writer thread at
+ * every keyframe, so recording never waits for the disk.
+ */
+class ReplayWriter {
+public:
+    /**
+     * A constructor
+     * @param path File to create
+     * @param seed RNG seed of the recorded run
+     * @param romHash fnv1a() of the recorded program
+     * @param quirks Quirk profile the program runs with
+     * @param timing Timing model the program runs with
+     * @param keyframeInterval Cycles of the timing model between keyframes
+     */
+    ReplayWriter(const std::string & path, uint32_t seed, uint64_t romHash, QuirkProfile quirks, TimingMode timing,
+                 uint64_t keyframeInterval);
+    ~ReplayWriter();
+
+    ReplayWriter(const ReplayWriter &) = delete;
+    ReplayWriter & operator=(const ReplayWriter &) = delete;
+
+    /**
+     * @return false if the file could not be opened or a write failed
+     */
+    bool good() const;
+
+    uint64_t keyframeInterval() const { return header.keyframe_interval; }
+
+    void event(const InputEvent & event);
+    void keyframe(const Snapshot & snapshot);
+
+    /**
+     * Write the index and footer and wait for the writer thread to finish
+     * @param endCycle Cycle count at the end of the recording
+     */
+    void close(uint64_t endCycle);
+
+private:
+    replay::Header header;
+    std::vector<InputEvent> events; // Events since the last chunk
+    std::vector<replay::IndexEntry> index;
+    std::vector<uint8_t> staging; // Chunks not yet handed to the writer thread
+    uint64_t offset; // File offset of the end of staging
+    bool closed;
+
+    std::ofstream out;
+    std::vector<char> file_buffer;
+    std::thread thread;
+    mutable std::mutex mutex;
+    std::condition_variable wakeup;
+    std::deque<std::vector<uint8_t>> queue;
+    std::vector<std::vector<uint8_t>> spare_buffers;
+    bool stopping;
+    bool failed;
+
+    void append(uint32_t type, const void * data, size_t size);
+    void flushEvents();
+    void submit();
+    void writerLoop();
+};
+
+/**
+ * Plays back a replay file, from the start or from any cycle
+ */
+class ReplayReader {
+public:
+    explicit ReplayReader(const std::string & path);
+
+    /**
+     * @return false if the file could not be read or is not a complete replay file
+     */
+    bool good() const { return valid; }
+
+    uint32_t seed() const { return header.seed; }
+    uint64_t romHash() const { return header.rom_hash; }
+    QuirkProfile quirks() const { return (QuirkProfile) header.quirks; }
+    TimingMode timing() const { return (TimingMode) header.timing; }
+    uint64_t endCycle() const { return footer.end_cycle; }
+    const std::vector<replay::IndexEntry> & keyframes() const { return index; }
+
+    /**
+     * Restore the machine to the last keyframe at or before a cycle and replay the events up to it
+     * @param machine Machine to restore into
+     * @param cycle Cycle to seek to
+     * @return false if there is no keyframe before the cycle or the file is damaged
+     */
+    bool seek(chip8 & machine, uint64_t cycle);
+
+    /**
+     * Continue playing up to a cycle count
+     */
+    void runUntil(chip8 & machine, uint64_t cycle);
+
+    void runToEnd(chip8 & machine) {
+        runUntil(machine, footer.end_cycle);
+    }
+
+private:
+    std::ifstream in;
+    bool valid;
+    replay::Header header;
+    replay::Footer footer;
+    std::vector<replay::IndexEntry> index;
+
+    uint64_t cursor; // File offset of the next chunk to read events from
+    std::vector<InputEvent> pending;
+    size_t next_pending;
+
+    /**
+     * Make sure pending has an unread event
+     * @return false at the end of the recording
+     */
+    bool fillPending();
+};
+
+
+#endif //CHIP8_REPLAYFILE_H
@@ -0,0 +1,219 @@
+//
+// Created by david on 18-10-26.
+//
+
+#include <cstring>
+#include <stdexcept>
+#include "RewindBuffer.h"
+#include "../chip8.h"
+
+static_assert(sizeof(Snapshot) <= 0xFFFF, "Delta runs are encoded as 16-bit lengths");
+
+RewindBuffer::RewindBuffer(double budgetMegabytes, unsigned int keyframeInterval):
+        keyframe_interval( keyframeInterval == 0 ? 1 : keyframeInterval ), next_frame(), last_keyframe(),
+        previous(), current() {
+    size_t capacity = (size_t) (budgetMegabytes * 1024 * 1024);
+    if (capacity < 2 * sizeof(Snapshot)) {
+        throw std::invalid_argument("Rewind budget is too small to hold a keyframe");
+    }
+
+    ring.resize(capacity);
+    encoded.reserve(sizeof(Snapshot) + 64);
+}
+
+void RewindBuffer::clear() {
+    records.clear();
+    next_frame = 0;
+}
+
+size_t RewindBuffer::bytesUsed() const {
+    size_t used = 0;
+    for (const Record & record : records) {
+        used += record.size;
+    }
+    return used;
+}
+
+void RewindBuffer::capture(const chip8 & machine) {
+    machine.snapshot(current);
+
+    uint64_t frame = next_frame++;
+    bool stored = false;
+    if (!records.empty() && frame - last_keyframe < keyframe_interval) {
+        encodeDelta(previous, current, encoded);
+        stored = store(frame, false, encoded.data(), encoded.size());
+    }
+    if (!stored) {
+        store(frame, true, reinterpret_cast<const uint8_t *>(&current), sizeof(Snapshot));
+        last_keyframe = frame;
+    }
+
+    std::swap(previous, current);
+}
+
+bool RewindBuffer::decode(uint64_t frame, Snapshot & snapshot) const {
+    if (records.empty() || frame < oldestFrame() || frame > newestFrame()) {
+        return false;
+    }
+
+    // Frames are contiguous, so the record index follows from the frame number
+    size_t index = (size_t) (frame - oldestFrame());
+    size_t keyframe = index;
+    while (!records[keyframe].keyframe) {
+        --keyframe;
+    }
+
+    std::memcpy(&snapshot, ring.data() + records[keyframe].offset, sizeof(Snapshot));
+    for (size_t i = keyframe + 1; i <= index; ++i) {
+        applyDelta(ring.data() + records[i].offset, records[i].size, snapshot);
+    }
+    return true;
+}
+
+bool RewindBuffer::restore(uint64_t frame, chip8 & machine) {
+    if (!decode(frame, current)) {
+        return false;
+    }
+
+    machine.restore(current);
+
+    // Continue the history from the restored frame
+    records.resize((size_t) (frame - oldestFrame()) + 1);
+    previous = current;
+    next_frame = frame + 1;
+
+    size_t keyframe = records.size() - 1;
+    while (!records[keyframe].keyframe) {
+        --keyframe;
+    }
+    last_keyframe = records[keyframe].frame;
+    return true;
+}
+
+bool RewindBuffer::rewind(uint64_t frames, chip8 & machine) {
+    if (records.empty() || frames > newestFrame() - oldestFrame()) {
+        return false;
+    }
+    return restore(newestFrame() - frames, machine);
+}
+
+bool RewindBuffer::store(uint64_t frame, bool keyframe, const uint8_t * data, size_t size) {
+    size_t offset;
+    for (;;) {
+        if (records.empty()) {
+            offset = 0;
+            break;
+        }
+
+        size_t head = records.back().offset + records.back().size;
+        size_t tail = records.front().offset;
+        if (tail <= records.back().offset) {
+            // Free space at the end of the ring and in front of the oldest record
+            if (head + size <= ring.size()) {
+                offset = head;
+                break;
+            }
+            if (size <= tail) {
+                offset = 0;
+                break;
+            }
+        } else if (head + size <= tail) {
+            // Wrapped around, free space between the newest and the oldest record
+            offset = head;
+            break;
+        }
+
+        // Evict the oldest keyframe group
+        records.pop_front();
+        dropOrphanedDeltas();
+        if (records.empty() && !keyframe) {
+            return false;
+        }
+    }
+
+    std::memcpy(ring.data() + offset, data, size);
+    records.push_back(Record{frame, offset, size, keyframe});
+    return true;
+}
+
+void RewindBuffer::dropOrphanedDeltas() {
+    while (!records.empty() && !records.front().keyframe) {
+        records.pop_front();
+    }
+}
+
+/**
+ * Append a 16-bit value in little endian order
+ */
+static inline void put16(std::vector<uint8_t> & out, size_t value) {
+    out.push_back((uint8_t) (value & 0xFF));
+    out.push_back((uint8_t) (value >> 8));
+}
+
+void RewindBuffer::encodeDelta(const Snapshot & from, const Snapshot & to, std::vector<uint8_t> & out) {
+    // Runs of [zero run length][literal length][literal XOR bytes]
+    const uint8_t * a = reinterpret_cast<const uint8_t *>(&from);
+    const uint8_t * b = reinterpret_cast<const uint8_t *>(&to);
+    const size_t size = sizeof(Snapshot);
+
+    out.clear();
+    size_t i = 0;
+    while (i < size) {
+        size_t zeroes = i;
+        // Skip equal bytes a word at a time
+        while (i + 8 <= size) {
+            uint64_t wa, wb;
+            std::memcpy(&wa, a + i, 8);
+            std::memcpy(&wb, b + i, 8);
+            if (wa != wb) {
+                break;
+            }
+            i += 8;
+        }
+        while (i < size && a[i] == b[i]) {
+            ++i;
+        }
+        zeroes = i - zeroes;
+
+        // Short runs of equal bytes are cheaper as part of the literal than as a new run
+        size_t literal = i;
+        while (i < size) {
+            if (a[i] == b[i]) {
+                size_t equal = 0;
+                while (i + equal < size && a[i + equal] == b[i + equal] && equal < 4) {
+                    ++equal;
+                }
+                if (equal >= 4 || i + equal == size) {
+                    break;
+                }
+                i += equal;
+            } else {
+                ++i;
+            }
+        }
+
+        put16(out, zeroes);
+        put16(out, i - literal);
+        for (size_t j = literal; j < i; ++j) {
+            out.push_back(a[j] ^ b[j]);
+        }
+    }
+}
+
+void RewindBuffer::applyDelta(const uint8_t * delta, size_t size, Snapshot & state) {
+    uint8_t * bytes = reinterpret_cast<uint8_t *>(&state);
+    size_t position = 0;
+    size_t i = 0;
+    while (i + 4 <= size) {
+        size_t zeroes = delta[i] | delta[i + 1] << 8;
+        size_t literal = delta[i + 2] | delta[i + 3] << 8;
+        i += 4;
+
+        position += zeroes;
+        for (size_t j = 0; j < literal; ++j) {
+            bytes[position + j] ^= delta[i + j];
+        }
+        position += literal;
+        i += literal;
+    }
+}
@@ -0,0 +1,107 @@
+//
+// Created by david on 18-10-26.
+//
+
+#ifndef CHIP8_REWINDBUFFER_H
+#define CHIP8_REWINDBUFFER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+#include "../Snapshot.h"
+
+class chip8;
+
+/**
+ * Rewind history of recent frames in a fixed-size ring.
+ *
+ * Every keyframe_interval frames a full snapshot is stored, the frames in between are stored as the
+ * XOR with the previous frame, run-length encoded. Most of a frame's state does not change, so a delta
+ * is mostly one long run of zeroes. Restoring a frame decodes at most keyframe_interval - 1 deltas on
+ * top of its keyframe. When the ring is full the oldest frames are dropped, a whole keyframe group at a time.
+ */
+class RewindBuffer {
+public:
+    /**
+     * A constructor
+     * @param budgetMegabytes Size of the ring in megabytes
+     * @param keyframeInterval Frames from one keyframe to the next
+     */
+    explicit RewindBuffer(double budgetMegabytes, unsigned int keyframeInterval = 60);
+
+    /**
+     * Store the current state of a machine as the next frame
+     * @param machine Machine to capture
+     */
+    void capture(const chip8 & machine);
+
+    /**
+     * Restore a frame. Newer frames are dropped, the next capture continues from the restored frame.
+     * @param frame Frame number, between oldestFrame() and newestFrame()
+     * @param machine Machine to restore into
+     * @return false if the frame is no longer (or not yet) in the buffer
+     */
+    bool restore(uint64_t frame, chip8 & machine);
+
+    /**
+     * Decode a frame without changing the history, e.g. to show it while scrubbing
+     * @param frame Frame number, between oldestFrame() and newestFrame()
+     * @param snapshot Destination
+     * @return false if the frame is not in the buffer
+     */
+    bool decode(uint64_t frame, Snapshot & snapshot) const;
+
+    /**
+     * Restore the frame a number of frames back from the newest one
+     * @param frames Number of frames to go back, 0 restores the newest frame
+     * @param machine Machine to restore into
+     * @return false if the buffer doesn't reach back that far
+     */
+    bool rewind(uint64_t frames, chip8 & machine);
+
+    bool empty() const { return records.empty(); }
+    uint64_t oldestFrame() const { return records.empty() ? 0 : records.front().frame; }
+    uint64_t newestFrame() const { return records.empty() ? 0 : records.back().frame; }
+    size_t frameCount() const { return records.size(); }
+
+    size_t capacity() const { return ring.size(); }
+    size_t bytesUsed() const;
+
+    void clear();
+
+private:
+    struct Record {
+        uint64_t frame;
+        size_t offset;
+        size_t size;
+        bool keyframe;
+    };
+
+    std::vector<uint8_t> ring;
+    std::deque<Record> records;
+    unsigned int keyframe_interval;
+    uint64_t next_frame;
+    uint64_t last_keyframe;
+
+    Snapshot previous; // State of the newest frame, deltas are taken against it
+    Snapshot current;
+    std::vector<uint8_t> encoded; // Scratch buffer for the delta of the frame being captured
+
+    /**
+     * Make room for and copy a record into the ring, evicting the oldest frames as needed
+     * @return false if a delta could not be stored because its keyframe had to be evicted
+     */
+    bool store(uint64_t frame, bool keyframe, const uint8_t * data, size_t size);
+
+    /**
+     * Drop records from the front until the oldest one is a keyframe
+     */
+    void dropOrphanedDeltas();
+
+    static void encodeDelta(const Snapshot & from, const Snapshot & to, std::vector<uint8_t> & out);
+    static void applyDelta(const uint8_t * delta, size_t size, Snapshot & state);
+};
+
+
+#endif //CHIP8_REWINDBUFFER_H
@@ -0,0 +1,32 @@
+//
+// Created by david on 18-10-26.
+//
+
+#include <cstring>
+#include "RunAhead.h"
+#include "../Trace/Trace.h"
+
+RunAhead::RunAhead(unsigned int frames): ahead_frames( frames ), saved(), saved_counters(), ahead_gfx() {}
+
+const unsigned char * RunAhead::frame(chip8 & machine) {
+    machine.runFrame();
+    return ahead(machine);
+}
+
+const unsigned char * RunAhead::ahead(chip8 & machine) {
+    if (ahead_frames == 0) {
+        return machine.framebuffer();
+    }
+
+    TRACE_SPAN("run_ahead");
+    machine.snapshot(saved);
+    machine.saveCounters(saved_counters);
+    for (unsigned int i = 0; i < ahead_frames; ++i) {
+        machine.runFrame();
+    }
+    std::memcpy(ahead_gfx, machine.framebuffer(), sizeof(ahead_gfx));
+    machine.restore(saved);
+    machine.loadCounters(saved_counters);
+
+    return ahead_gfx;
+}
@@ -0,0 +1,53 @@
+//
+// Created by david on 18-10-26.
+//
+
+#ifndef CHIP8_RUNAHEAD_H
+#define CHIP8_RUNAHEAD_H
+
+#include "../chip8.h"
+#include "../Snapshot.h"
+#include "../includes/globals.h"
+
+/**
+ * Run-ahead input latency reduction.
+ *
+ * Every host frame the machine runs its real frame, is snapshotted, runs a number of frames further with
+ * the current input and is restored again. The frame shown is the one from the future, which hides that
+ * many frames of the program's own input lag. The machine's counters are put back as well, so statistics and
+ * profiles only count the frames that really happened.
+ */
+class RunAhead {
+public:
+    /**
+     * A constructor
+     * @param frames Frames to run ahead, 0 disables run-ahead
+     */
+    explicit RunAhead(unsigned int frames = 0);
+
+    void setFrames(unsigned int frames) { ahead_frames = frames; }
+    unsigned int frames() const { return ahead_frames; }
+
+    /**
+     * Emulate one host frame
+     * @param machine Machine to run, left in the state after its real frame
+     * @return Framebuffer to present, valid until the next call
+     */
+    const unsigned char * frame(chip8 & machine);
+
+    /**
+     * Run ahead from the machine's current state, for hosts that run the real frame themselves
+     * @param machine Machine at a frame boundary, left in the state it was in
+     * @return Framebuffer to present, valid until the next call
+     */
+    const unsigned char * ahead(chip8 & machine);
+
+private:
+    unsigned int ahead_frames;
+    Snapshot saved;
+    chip8::Counters saved_counters;
+    unsigned char ahead_gfx[SCREEN_WIDTH * SCREEN_HEIGHT];
+};
+
+
+#endif //CHIP8_RUNAHEAD_H
@@ -0,0 +1,64 @@
+//
+// Created by david on 18-10-26.
+//
+
+#include <algorithm>
+#include "Scheduler.h"
+
+/**
+ * Heap order, the event due first at the top
+ */
+static bool later(const Scheduler::Event & a, const Scheduler::Event & b) {
+    if (a.cycle != b.cycle) {
+        return a.cycle > b.cycle;
+    }
+    return a.sequence > b.sequence;
+}
+
+Scheduler::Scheduler(): next_sequence( 0 ) {}
+
+void Scheduler::schedule(unsigned int id, uint64_t cycle, uint64_t period) {
+    push(Event{cycle, period, next_sequence++, id});
+}
+
+void Scheduler::cancel(unsigned int id) {
+    events.erase(std::remove_if(events.begin(), events.end(), [id](const Event & event) {
+        return event.id == id;
+    }), events.end());
+    std::make_heap(events.begin(), events.end(), later);
+}
+
+void Scheduler::clear() {
+    events.clear();
+}
+
+void Scheduler::delay(uint64_t cycles) {
+    // Moving every event by the same amount keeps the heap order
+    for (Event & event : events) {
+        event.cycle += cycles;
+    }
+}
+
+bool Scheduler::take(uint64_t cycle, Event & event) {
+    if (events.empty() || events.front().cycle > cycle) {
+        return false;
+    }
+
+    std::pop_heap(events.begin(), events.end(), later);
+    event = events.back();
+    events.pop_back();
+
+    if (event.period != 0) {
+        // From the due cycle, not the current one, so repeats never drift. The sequence is kept, events
+        // due together keep firing in the order they were first scheduled
+        Event repeat = event;
+        repeat.cycle += event.period;
+        push(repeat);
+    }
+    return true;
+}
+
+void Scheduler::push(const Event & event) {
+    events.push_back(event);
+    std::push_heap(events.begin(), events.end(), later);
+}
@@ -0,0 +1,107 @@
+//
+// Created by david on 18-10-26.
+//
+
+#ifndef CHIP8_SCHEDULER_H
+#define CHIP8_SCHEDULER_H
+
+#include <cstdint>
+#include <vector>
+#include "../Trace/Trace.h"
+
+/**
+ * Cycle based event scheduler.
+ *
+ * Events are kept in a min-heap on the cycle they are due at, events due at the same cycle fire in the
+ * order they were first scheduled. run() lets the machine execute uninterrupted batches up to the next event
+ * instead of checking for work after every instruction, so the interpreter loop stays free of timers,
+ * vblank and polling.
+ */
+class Scheduler {
+public:
+    static constexpr uint64_t NEVER = UINT64_MAX;
+
+    struct Event {
+        uint64_t cycle; // Cycle the event is due at
+        uint64_t period; // Cycles between repeats, 0 for a one-shot event
+        uint64_t sequence; // Order of the schedule() call, orders events due at the same cycle
+        unsigned int id; // Chosen by the owner of the event
+    };
+
+    Scheduler();
+
+    /**
+     * Schedule an event
+     * @param id Passed back with the event
+     * @param cycle Cycle count the event is due at
+     * @param period Cycles between repeats, 0 fires the event once
+     */
+    void schedule(unsigned int id, uint64_t cycle, uint64_t period = 0);
+
+    /**
+     * Remove every pending event with an id
+     * @param id Event id
+     */
+    void cancel(unsigned int id);
+
+    void clear();
+
+    /**
+     * Postpone every pending event, for a host that moved the machine past a stretch of time without
+     * handling events, e.g. while it slept waiting for input
+     * @param cycles Cycles to add to every due cycle
+     */
+    void delay(uint64_t cycles);
+
+    bool empty() const { return events.empty(); }
+    size_t size() const { return events.size(); }
+
+    /**
+     * @return Cycle the first event is due at, NEVER without events
+     */
+    uint64_t nextCycle() const { return events.empty() ? NEVER : events.front().cycle; }
+
+    /**
+     * Remove the first event if it is due, a periodic event is scheduled again one period later
+     * @param cycle Current cycle count
+     * @param event Destination for the event
+     * @return False if no event is due at cycle
+     */
+    bool take(uint64_t cycle, Event & event);
+
+    /**
+     * Run a machine up to a cycle count, stopping at every due event to hand it to handler
+     * @param machine Machine to run, anything with runUntil(cycle) and cycleCount()
+     * @param cycle Cycle count to stop at, NEVER runs until a handler stops the run
+     * @param handler Called as bool handler(const Event &) at the cycle the event is due, false stops
+     * the run
+     * @return False if a handler stopped the run
+     */
+    template<typename Machine, typename Handler>
+    bool run(Machine & machine, uint64_t cycle, Handler && handler) {
+        while (machine.cycleCount() < cycle) {
+            uint64_t next = nextCycle();
+            {
+                TRACE_SPAN("execute");
+                machine.runUntil(next < cycle ? next : cycle);
+            }
+
+            Event event;
+            while (take(machine.cycleCount(), event)) {
+                if (!handler(event)) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+private:
+    std::vector<Event> events; // Min-heap on cycle and sequence
+    uint64_t next_sequence;
+
+    void push(const Event & event);
+};
+
+
+#endif //CHIP8_SCHEDULER_H
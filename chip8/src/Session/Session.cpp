@@ -0,0 +1,32 @@
+//
+// Created by david on 18-10-26.
+//
+
+#include "Session.h"
+#include "../chip8.h"
+
+Session::~Session() {
+    if (handle) {
+        handle.destroy();
+    }
+}
+
+Session & Session::operator=(Session && other) noexcept {
+    if (this != &other) {
+        if (handle) {
+            handle.destroy();
+        }
+        handle = std::exchange(other.handle, nullptr);
+    }
+    return *this;
+}
+
+Session play(chip8 & machine, uint64_t frames) {
+    // Counted in timer ticks, so frames the machine was moved through while the session was suspended count
+    uint64_t end = frames == UINT64_MAX ? UINT64_MAX : machine.timerTicks() + frames;
+    while (machine.timerTicks() < end) {
+        machine.runFrame();
+        // A machine blocked on Fx0A has nothing to do until a key arrives, tell the owner so it can park it
+        co_yield machine.waitingForKey() ? Session::SESSION_KEY_WAIT : Session::SESSION_FRAME;
+    }
+}
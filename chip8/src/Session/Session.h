@@ -0,0 +1,92 @@
+//
+// Created by david on 18-10-26.
+//
+
+#ifndef CHIP8_SESSION_H
+#define CHIP8_SESSION_H
+
+#include <coroutine>
+#include <cstdint>
+#include <exception>
+#include <utility>
+
+class chip8;
+
+/**
+ * A machine's run loop as a C++20 coroutine, suspended at every frame boundary.
+ *
+ * The loop keeps its place in the coroutine frame instead of owning a thread, so one thread can take turns
+ * running thousands of machines a frame at a time (see SessionExecutor). A session created by play() starts
+ * suspended and runs one frame per resume().
+ */
+class Session {
+public:
+    /**
+     * Where the session suspended
+     */
+    enum State : uint8_t {
+        SESSION_FRAME, // At a frame boundary, ready to run the next frame
+        SESSION_KEY_WAIT, // At a frame boundary, blocked on Fx0A until a key is pressed
+        SESSION_DONE, // The run loop returned
+    };
+
+    struct promise_type {
+        State state = SESSION_FRAME;
+
+        Session get_return_object() {
+            return Session(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+
+        // Created suspended, the owner decides when it runs
+        std::suspend_always initial_suspend() noexcept { return {}; }
+
+        std::suspend_always yield_value(State reason) noexcept {
+            state = reason;
+            return {};
+        }
+
+        void return_void() noexcept { state = SESSION_DONE; }
+
+        // Stays suspended after returning so the state can still be read, ~Session() destroys the frame
+        std::suspend_always final_suspend() noexcept { return {}; }
+
+        void unhandled_exception() { std::terminate(); }
+    };
+
+    Session(): handle() {}
+    Session(Session && other) noexcept: handle( std::exchange(other.handle, nullptr) ) {}
+    Session(const Session &) = delete;
+    ~Session();
+
+    Session & operator=(Session && other) noexcept;
+    Session & operator=(const Session &) = delete;
+
+    /**
+     * Run the session to its next suspension point. Must not be done().
+     * @return Where it suspended
+     */
+    State resume() {
+        handle.resume();
+        return handle.promise().state;
+    }
+
+    State state() const { return handle.promise().state; }
+    bool done() const { return !handle || handle.done(); }
+
+private:
+    std::coroutine_handle<promise_type> handle;
+
+    explicit Session(std::coroutine_handle<promise_type> handle): handle( handle ) {}
+};
+
+/**
+ * Run a machine frame by frame, suspending after every frame
+ * @param machine Initialized machine with a program loaded, must outlive the session
+ * @param frames Timer ticks to run from the first resume() before the session is done, UINT64_MAX to run
+ * forever. Frames someone else runs the machine through while the session is suspended count too.
+ * @return Suspended session, the first resume() runs the first frame
+ */
+Session play(chip8 & machine, uint64_t frames = UINT64_MAX);
+
+
+#endif //CHIP8_SESSION_H
@@ -0,0 +1,72 @@
+//
+// Created by david on 18-10-26.
+//
+
+#include "SessionExecutor.h"
+#include "../chip8.h"
+#include "../Timer.h"
+
+SessionExecutor::SessionExecutor(): frames( 0 ), parked_count( 0 ) {}
+
+SessionExecutor::Id SessionExecutor::add(chip8 & machine, uint64_t frames) {
+    Id id = slots.size();
+    uint64_t end = frames == UINT64_MAX ? UINT64_MAX : machine.timerTicks() + frames;
+    slots.push_back(Slot{&machine, play(machine, frames), NOT_PARKED, end});
+    ready_ids.push_back(id);
+    return id;
+}
+
+size_t SessionExecutor::runFrame() {
+    next_ids.clear();
+    for (Id id : ready_ids) {
+        Slot & slot = slots[id];
+        switch (slot.session.resume()) {
+            case Session::SESSION_FRAME:
+                next_ids.push_back(id);
+                break;
+            case Session::SESSION_KEY_WAIT:
+                slot.parked_at = frames + 1;
+                ++parked_count;
+                break;
+            case Session::SESSION_DONE:
+                break;
+        }
+    }
+
+    size_t resumed = ready_ids.size();
+    ready_ids.swap(next_ids);
+    ++frames;
+    return resumed;
+}
+
+void SessionExecutor::run(uint64_t frames, Timer & timer) {
+    for (uint64_t frame = 0; frame < frames; ++frame) {
+        runFrame();
+        timer.wait();
+    }
+}
+
+void SessionExecutor::setKey(Id id, uint8_t key, bool pressed) {
+    Slot & slot = slots[id];
+    if (slot.parked_at == NOT_PARKED) {
+        slot.machine->setKey(key, pressed);
+        return;
+    }
+
+    // Run the frames the session sat out first, the key arrives now and not when it parked. They count as
+    // frames of the session, which then may be done. Blocked, the machine only moves its cycle count
+    chip8 & machine = *slot.machine;
+    uint64_t tick = machine.timerTicks() + frames - slot.parked_at;
+    if (tick > slot.end_tick) {
+        tick = slot.end_tick;
+    }
+    machine.runUntil(tick * machine.cyclesPerFrame());
+    slot.parked_at = frames;
+
+    machine.setKey(key, pressed);
+    if (!machine.waitingForKey()) {
+        slot.parked_at = NOT_PARKED;
+        --parked_count;
+        ready_ids.push_back(id);
+    }
+}
@@ -0,0 +1,97 @@
+//
+// Created by david on 18-10-26.
+//
+
+#ifndef CHIP8_SESSIONEXECUTOR_H
+#define CHIP8_SESSIONEXECUTOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Session.h"
+
+class chip8;
+class Timer;
+
+/**
+ * Runs many sessions on the calling thread, a frame of each in turn.
+ *
+ * runFrame() resumes every ready session once, so all machines advance in lockstep one frame per call.
+ * A session that suspends blocked on Fx0A is parked and not resumed again until setKey() ends its wait,
+ * it then catches up on the frames it sat out at once, which costs nothing for a waiting machine. Parked
+ * sessions cost nothing per frame either, so a host mostly waiting on players can keep a lot of them.
+ * For more cores, run one executor per thread.
+ */
+class SessionExecutor {
+public:
+    typedef size_t Id;
+
+    SessionExecutor();
+
+    /**
+     * Add a machine, it runs its first frame in the next runFrame()
+     * @param machine Initialized machine with a program loaded, must outlive the executor
+     * @param frames Frames to run before the session is done, UINT64_MAX to run forever. Frames the session
+     * sits out parked count, a key press doesn't catch it up past its last frame.
+     * @return Id of the session
+     */
+    Id add(chip8 & machine, uint64_t frames = UINT64_MAX);
+
+    /**
+     * Run one frame of every ready session
+     * @return Number of sessions resumed
+     */
+    size_t runFrame();
+
+    /**
+     * runFrame() at the period of a timer, e.g. Timer(FRAMES_PER_SECOND) for real time
+     * @param frames Number of frames to run
+     * @param timer Started timer to wait on after every frame
+     */
+    void run(uint64_t frames, Timer & timer);
+
+    /**
+     * Press or release a key of a session's machine. Use this instead of the machine's setKey(), a press
+     * that ends an Fx0A wait wakes the session.
+     * @param id Session id
+     * @param key Key 0 to F
+     * @param pressed True when the key goes down
+     */
+    void setKey(Id id, uint8_t key, bool pressed);
+
+    /**
+     * @return Number of runFrame() calls
+     */
+    uint64_t frame() const { return frames; }
+
+    size_t size() const { return slots.size(); }
+
+    /**
+     * @return Sessions runFrame() resumes, neither parked nor done
+     */
+    size_t ready() const { return ready_ids.size(); }
+
+    /**
+     * @return Sessions parked on Fx0A
+     */
+    size_t parked() const { return parked_count; }
+
+private:
+    static const uint64_t NOT_PARKED = UINT64_MAX;
+
+    struct Slot {
+        chip8 * machine;
+        Session session;
+        uint64_t parked_at; // Frame count the session last ran at while parked, NOT_PARKED otherwise
+        uint64_t end_tick; // Timer tick of the machine the session is done at, UINT64_MAX if never
+    };
+
+    std::vector<Slot> slots; // Indexed by id
+    std::vector<Id> ready_ids; // Sessions to resume in the next runFrame()
+    std::vector<Id> next_ids; // Ready sessions after the running runFrame(), swapped with ready_ids
+    uint64_t frames;
+    size_t parked_count;
+};
+
+
+#endif //CHIP8_SESSIONEXECUTOR_H
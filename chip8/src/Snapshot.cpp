@@ -0,0 +1,27 @@
+//
+// Created by david on 18-10-26.
+//
+
+#include <type_traits>
+#include "Snapshot.h"
+
+static_assert(std::is_trivially_copyable<Snapshot>::value, "Snapshot must stay a flat POD blob");
+static_assert(sizeof(CpuState) == 80, "CpuState must not contain implicit padding");
+
+bool Snapshot::write(std::ostream & out) const {
+    out.write(reinterpret_cast<const char *>(this), sizeof(Snapshot));
+    return out.good();
+}
+
+bool Snapshot::read(std::istream & in, Snapshot & snapshot) {
+    in.read(reinterpret_cast<char *>(&snapshot), sizeof(Snapshot));
+    if (!in.good()) {
+        return false;
+    }
+
+    return snapshot.magic == MAGIC && snapshot.version == VERSION;
+}
+
+uint64_t Snapshot::hash() const {
+    return fnv1a(this, sizeof(Snapshot));
+}
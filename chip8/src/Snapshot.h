@@ -0,0 +1,81 @@
+//
+// Created by david on 18-10-26.
+//
+
+#ifndef CHIP8_SNAPSHOT_H
+#define CHIP8_SNAPSHOT_H
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include "includes/globals.h"
+#include "includes/hash.h"
+
+/**
+ * Registers, stack, timers and RNG state, everything but the framebuffer and memory
+ */
+struct CpuState {
+    uint16_t pc;
+    uint16_t opcode;
+    uint16_t I;
+    uint16_t sp;
+    uint16_t stack[16];
+
+    uint8_t V[16];
+    uint8_t delay_timer;
+    uint8_t sound_timer;
+    uint8_t draw_flag;
+    uint8_t fault; // chip8::Fault
+
+    uint32_t rng_state;
+    uint16_t keys; // Keypad state, bit n is key n
+    uint8_t key_wait; // Register + 1 Fx0A waits to store a key press in, 0 when not waiting
+    uint8_t quirks; // QuirkProfile the machine ran with
+    uint8_t timing; // TimingMode, the unit of cycles
+    uint8_t padding[3];
+
+    uint64_t cycles; // Cycle count of the machine's timing model since initialize()
+};
+
+/**
+ * Complete machine state as one flat, plain old data blob.
+ *
+ * Taking or restoring a snapshot is a few memcpys, the largest being the 4 KB memory image.
+ * The word view of memory is not stored, it is rebuilt from the bytes on restore.
+ * The blob is written to disk as is (host byte order), magic and version are checked when reading it back.
+ */
+struct Snapshot {
+    static const uint32_t MAGIC = 0x53533843; // "C8SS"
+    static const uint32_t VERSION = 4;
+
+    uint32_t magic;
+    uint32_t version;
+
+    CpuState cpu;
+
+    uint8_t gfx[SCREEN_WIDTH * SCREEN_HEIGHT];
+    uint8_t memory[RAM_SIZE];
+
+    /**
+     * Write the snapshot to a binary stream
+     * @param out Stream to write to
+     * @return true if the stream is still good
+     */
+    bool write(std::ostream & out) const;
+
+    /**
+     * Read a snapshot from a binary stream
+     * @param in Stream to read from
+     * @param snapshot Destination, only fully valid if true is returned
+     * @return false on a read error or on an unknown magic or version
+     */
+    static bool read(std::istream & in, Snapshot & snapshot);
+
+    /**
+     * @return FNV-1a hash of the complete state, equal states give equal hashes
+     */
+    uint64_t hash() const;
+};
+
+
+#endif //CHIP8_SNAPSHOT_H
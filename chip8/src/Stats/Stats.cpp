@@ -0,0 +1,153 @@
+//
+// Created by david on 18-10-26.
+//
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iterator>
+#include <vector>
+#include "Stats.h"
+
+static const double FRAME_PERIOD_MS = 1000.0 / FRAMES_PER_SECOND;
+
+// 17 and 34 ms are just above one and two 60 Hz frame periods
+const double Stats::BUCKET_BOUNDS[Stats::BUCKETS] = {
+        4.0, 8.0, 12.0, 17.0, 20.0, 34.0, 50.0, HUGE_VAL
+};
+
+Stats::Stats(): cycles_per_frame( CYCLES_PER_FRAME ) {
+    reset();
+}
+
+void Stats::reset() {
+    frames = 0;
+    first_time = first_cycles = 0;
+    last_time = last_cycles = last_instructions = 0;
+    std::memset(times, 0, sizeof(times));
+    std::memset(cycle_counts, 0, sizeof(cycle_counts));
+    std::memset(instruction_counts, 0, sizeof(instruction_counts));
+    std::fill(std::begin(frame_times), std::end(frame_times), 0.0);
+    std::memset(histogram, 0, sizeof(histogram));
+    frame_time_sum = 0;
+    dropped = 0;
+    duplicated = 0;
+    missed = 0;
+}
+
+void Stats::frame(uint64_t cycles, uint64_t instructions, uint64_t now) {
+    double frameTime = 0;
+    if (frames == 0) {
+        first_time = now;
+        first_cycles = cycles;
+    } else {
+        frameTime = (now - last_time) / 1e6;
+        frame_time_sum += frameTime;
+
+        unsigned int bucket = 0;
+        while (frameTime > BUCKET_BOUNDS[bucket]) {
+            ++bucket;
+        }
+        ++histogram[bucket];
+
+        // A late frame took the place of the frames that should have been shown meanwhile
+        if (frameTime > 1.5 * FRAME_PERIOD_MS) {
+            dropped += (uint64_t) (frameTime / FRAME_PERIOD_MS + 0.5) - 1;
+        }
+        if (cycles == last_cycles) {
+            ++duplicated;
+        }
+    }
+
+    times[frames % WINDOW] = now;
+    cycle_counts[frames % WINDOW] = cycles;
+    instruction_counts[frames % WINDOW] = instructions;
+    frame_times[frames % WINDOW] = frameTime;
+    last_time = now;
+    last_cycles = cycles;
+    last_instructions = instructions;
+    ++frames;
+}
+
+double Stats::frameTime(unsigned int age) const {
+    if (age + 1 >= frames || age + 1 >= WINDOW) {
+        return 0;
+    }
+    return frame_times[(frames - 1 - age) % WINDOW];
+}
+
+Stats::Summary Stats::summary() const {
+    Summary summary = {};
+    summary.frames = frames;
+    summary.cycles = last_cycles;
+    summary.instructions = last_instructions;
+    summary.dropped = dropped;
+    summary.duplicated = duplicated;
+    summary.missed = missed;
+    if (frames < 2) {
+        return summary;
+    }
+
+    uint64_t span = std::min<uint64_t>(frames, WINDOW) - 1;
+    uint64_t oldest = frames - 1 - span;
+    double seconds = (last_time - times[oldest % WINDOW]) / 1e9;
+    if (seconds > 0) {
+        summary.ips = (last_instructions - instruction_counts[oldest % WINDOW]) / seconds;
+    }
+
+    std::vector<double> window;
+    window.reserve(span);
+    for (unsigned int age = 0; age < span; ++age) {
+        window.push_back(frameTime(age));
+    }
+    std::sort(window.begin(), window.end());
+    summary.frame_p50 = window[(window.size() - 1) * 50 / 100];
+    summary.frame_p95 = window[(window.size() - 1) * 95 / 100];
+    summary.frame_p99 = window[(window.size() - 1) * 99 / 100];
+
+    double emulated = (last_cycles - first_cycles) / (double) (cycles_per_frame * FRAMES_PER_SECOND);
+    double wall = (last_time - first_time) / 1e9;
+    summary.drift_ms = (emulated - wall) * 1000.0;
+    return summary;
+}
+
+void Stats::write(std::ostream & out) const {
+    Summary s = summary();
+
+    out << "# TYPE chip8_frames_total counter\n"
+        << "chip8_frames_total " << s.frames << "\n"
+        << "# TYPE chip8_cycles_total counter\n"
+        << "chip8_cycles_total " << s.cycles << "\n"
+        << "# TYPE chip8_instructions_total counter\n"
+        << "chip8_instructions_total " << s.instructions << "\n"
+        << "# TYPE chip8_instructions_per_second gauge\n"
+        << "chip8_instructions_per_second " << s.ips << "\n"
+        << "# TYPE chip8_frame_time_ms summary\n"
+        << "chip8_frame_time_ms{quantile=\"0.5\"} " << s.frame_p50 << "\n"
+        << "chip8_frame_time_ms{quantile=\"0.95\"} " << s.frame_p95 << "\n"
+        << "chip8_frame_time_ms{quantile=\"0.99\"} " << s.frame_p99 << "\n"
+        << "# TYPE chip8_frame_time_ms_histogram histogram\n";
+
+    uint64_t cumulative = 0;
+    for (unsigned int bucket = 0; bucket < BUCKETS; ++bucket) {
+        cumulative += histogram[bucket];
+        out << "chip8_frame_time_ms_histogram_bucket{le=\"";
+        if (std::isinf(BUCKET_BOUNDS[bucket])) {
+            out << "+Inf";
+        } else {
+            out << BUCKET_BOUNDS[bucket];
+        }
+        out << "\"} " << cumulative << "\n";
+    }
+
+    out << "chip8_frame_time_ms_histogram_sum " << frame_time_sum << "\n"
+        << "chip8_frame_time_ms_histogram_count " << cumulative << "\n"
+        << "# TYPE chip8_timer_drift_ms gauge\n"
+        << "chip8_timer_drift_ms " << s.drift_ms << "\n"
+        << "# TYPE chip8_dropped_frames_total counter\n"
+        << "chip8_dropped_frames_total " << s.dropped << "\n"
+        << "# TYPE chip8_duplicated_frames_total counter\n"
+        << "chip8_duplicated_frames_total " << s.duplicated << "\n"
+        << "# TYPE chip8_missed_deadlines_total counter\n"
+        << "chip8_missed_deadlines_total " << s.missed << "\n";
+}
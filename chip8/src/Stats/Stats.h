@@ -0,0 +1,114 @@
+//
+// Created by david on 18-10-26.
+//
+
+#ifndef CHIP8_STATS_H
+#define CHIP8_STATS_H
+
+#include <cstdint>
+#include <ostream>
+#include "../includes/globals.h"
+
+/**
+ * Live performance statistics of a running machine, fed once per presented frame: instructions per
+ * second, frame times, timer drift against the wall clock, dropped and duplicated frames and missed
+ * pacing deadlines.
+ */
+class Stats {
+public:
+    /**
+     * Frames kept for the rolling figures, ten seconds
+     */
+    static const unsigned int WINDOW = FRAMES_PER_SECOND * 10;
+
+    /**
+     * Frame time histogram bucket upper bounds in milliseconds, the last bucket takes everything above
+     */
+    static const unsigned int BUCKETS = 8;
+    static const double BUCKET_BOUNDS[BUCKETS];
+
+    struct Summary {
+        uint64_t frames; // Frames presented
+        uint64_t cycles; // Cycles of the machine's timing model
+        uint64_t instructions; // Instructions executed
+        double ips; // Instructions per second over the window
+        double frame_p50; // Frame time percentiles over the window, in milliseconds
+        double frame_p95;
+        double frame_p99;
+        double drift_ms; // Emulated time minus wall clock time, negative when falling behind
+        uint64_t dropped; // Refresh periods without a new frame
+        uint64_t duplicated; // Frames presented without the machine having advanced
+        uint64_t missed; // Frame deadlines the host was too late for, see Timer
+    };
+
+    Stats();
+
+    void reset();
+
+    /**
+     * @param cycles Cycles per frame of the machine's timing model, for the emulated time
+     */
+    void setCyclesPerFrame(uint64_t cycles) { cycles_per_frame = cycles; }
+
+    /**
+     * Record a presented frame
+     * @param cycles Cycle count of the machine after the frame
+     * @param instructions Instructions the machine executed so far, only equal to cycles with TIMING_FIXED
+     * @param now Steady clock time in nanoseconds
+     */
+    void frame(uint64_t cycles, uint64_t instructions, uint64_t now);
+
+    uint64_t frameCount() const { return frames; }
+
+    /**
+     * Record that the host slept since the last frame, e.g. while the program waited for a key. The time
+     * slept is not a frame time, the next frame is timed from now and drops no frames.
+     * @param now Steady clock time in nanoseconds
+     */
+    void wake(uint64_t now) { last_time = now; }
+
+    /**
+     * @param count Deadlines the frame pacing has missed so far
+     */
+    void setMissedDeadlines(uint64_t count) { missed = count; }
+
+    /**
+     * Compute the rolling figures, sorts the window so call it at most every few frames
+     */
+    Summary summary() const;
+
+    /**
+     * @param age 0 for the last frame, up to WINDOW - 2
+     * @return Time between a frame and the one before it in milliseconds, 0 if there is no such frame
+     */
+    double frameTime(unsigned int age) const;
+
+    /**
+     * Write all figures in the Prometheus text exposition format
+     */
+    void write(std::ostream & out) const;
+
+private:
+    uint64_t cycles_per_frame;
+    uint64_t frames;
+    uint64_t first_time; // Time and cycle count of the first frame
+    uint64_t first_cycles;
+    uint64_t last_time;
+    uint64_t last_cycles;
+    uint64_t last_instructions;
+
+    // Rolling window, indexed by frames % WINDOW
+    uint64_t times[WINDOW];
+    uint64_t cycle_counts[WINDOW];
+    uint64_t instruction_counts[WINDOW];
+    double frame_times[WINDOW]; // In milliseconds, 0 for the first frame
+
+    uint64_t histogram[BUCKETS]; // Frame times since reset()
+    double frame_time_sum; // In milliseconds
+    uint64_t dropped;
+    uint64_t duplicated;
+    uint64_t missed;
+};
+
+
+#endif //CHIP8_STATS_H
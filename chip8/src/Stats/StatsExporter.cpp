@@ -0,0 +1,150 @@
+//
+// Created by david on 18-10-26.
+//
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include "StatsExporter.h"
+#include "Stats.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#define CHIP8_UNIX_SOCKETS
+#endif
+
+StatsExporter::StatsExporter(): socket_fd( -1 ), has_pending( false ), writing( false ), stopping( false ) {}
+
+StatsExporter::~StatsExporter() {
+    if (thread.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wakeup.notify_one();
+        thread.join();
+    }
+
+#ifdef CHIP8_UNIX_SOCKETS
+    if (socket_fd >= 0) {
+        close(socket_fd);
+        unlink(socket_path.c_str());
+    }
+#endif
+}
+
+void StatsExporter::setFile(const std::string & path) {
+    file_path = path;
+}
+
+bool StatsExporter::listen(const std::string & path) {
+#ifdef CHIP8_UNIX_SOCKETS
+    sockaddr_un address = {};
+    if (path.size() >= sizeof(address.sun_path)) {
+        return false;
+    }
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return false;
+    }
+    unlink(path.c_str());
+    if (bind(fd, (const sockaddr *) &address, sizeof(address)) != 0 || ::listen(fd, 8) != 0
+            || fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK) != 0) {
+        close(fd);
+        return false;
+    }
+
+    if (socket_fd >= 0) {
+        close(socket_fd);
+        unlink(socket_path.c_str());
+    }
+    socket_fd = fd;
+    socket_path = path;
+    return true;
+#else
+    (void) path;
+    return false;
+#endif
+}
+
+void StatsExporter::publish(const Stats & stats) {
+    if (!enabled()) {
+        return;
+    }
+
+    std::ostringstream text;
+    stats.write(text);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending = text.str();
+        has_pending = true;
+    }
+    wakeup.notify_one();
+
+    if (!thread.joinable()) {
+        thread = std::thread(&StatsExporter::writerLoop, this);
+    }
+}
+
+void StatsExporter::flush() {
+    std::unique_lock<std::mutex> lock(mutex);
+    written.wait(lock, [this]() { return !has_pending && !writing; });
+}
+
+void StatsExporter::writerLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+        wakeup.wait(lock, [this]() { return has_pending || stopping; });
+        if (!has_pending) {
+            return;
+        }
+
+        std::string dump;
+        dump.swap(pending);
+        has_pending = false;
+        writing = true;
+        lock.unlock();
+        write(dump);
+        lock.lock();
+        writing = false;
+        written.notify_all();
+    }
+}
+
+void StatsExporter::write(const std::string & dump) {
+    if (!file_path.empty()) {
+        // Readers never see a half written file
+        std::string temporary = file_path + ".tmp";
+        {
+            std::ofstream out(temporary, std::ios::out | std::ios::trunc);
+            out << dump;
+        }
+        std::rename(temporary.c_str(), file_path.c_str());
+    }
+
+#ifdef CHIP8_UNIX_SOCKETS
+    if (socket_fd < 0) {
+        return;
+    }
+    for (;;) {
+        int client = accept(socket_fd, nullptr, nullptr);
+        if (client < 0) {
+            // No more clients waiting
+            return;
+        }
+#ifdef MSG_NOSIGNAL
+        send(client, dump.data(), dump.size(), MSG_NOSIGNAL);
+#else
+        send(client, dump.data(), dump.size(), 0);
+#endif
+        close(client);
+    }
+#endif
+}
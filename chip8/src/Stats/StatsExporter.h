@@ -0,0 +1,79 @@
+//
+// Created by david on 18-10-26.
+//
+
+#ifndef CHIP8_STATSEXPORTER_H
+#define CHIP8_STATSEXPORTER_H
+
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+
+class Stats;
+
+/**
+ * Publishes Stats for local scrapers, to a file that is replaced atomically and/or to a Unix domain
+ * socket that sends every client one dump and closes it.
+ *
+ * publish() only formats the stats, a background thread writes the file and serves the clients, so the
+ * frame loop never waits for the disk. A dump that is still waiting when the next one is published is
+ * replaced by it. Set the file and the socket up before the first publish().
+ */
+class StatsExporter {
+public:
+    StatsExporter();
+    ~StatsExporter();
+
+    StatsExporter(const StatsExporter &) = delete;
+    StatsExporter & operator=(const StatsExporter &) = delete;
+
+    /**
+     * @param path File to write the stats to at every publish(), empty to stop writing it
+     */
+    void setFile(const std::string & path);
+
+    /**
+     * Start serving the stats on a Unix domain socket, an existing socket file at path is replaced
+     * @param path Path of the socket
+     * @return False if the socket couldn't be created
+     */
+    bool listen(const std::string & path);
+
+    bool enabled() const { return !file_path.empty() || socket_fd >= 0; }
+
+    /**
+     * Hand the stats to the writer thread, which writes them to the file and to every client waiting on
+     * the socket
+     */
+    void publish(const Stats & stats);
+
+    /**
+     * Wait until the writer thread has written everything published so far
+     */
+    void flush();
+
+private:
+    std::string file_path;
+    std::string socket_path;
+    int socket_fd;
+
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable wakeup;
+    std::condition_variable written;
+    std::string pending; // Dump waiting for the writer thread
+    bool has_pending;
+    bool writing;
+    bool stopping;
+
+    void writerLoop();
+
+    /**
+     * Write a dump to the file and the waiting clients, on the writer thread
+     */
+    void write(const std::string & dump);
+};
+
+
+#endif //CHIP8_STATSEXPORTER_H
@@ -2,14 +2,57 @@
 // Created by David Strootman on 15-4-2019.
 //
 
+#include <thread>
 #include "Timer.h"
 
-Timer::timer()
+Timer::Timer(unsigned int frequency, Clock::duration spin): frequency( frequency ), spin_time( spin ), next( 1 ), missed_deadlines( 0 ), worst_lateness( Clock::duration::zero() )
 {
+    start();
+}
 
+void Timer::start()
+{
+    origin = Clock::now();
+    next = 1;
+    missed_deadlines = 0;
+    worst_lateness = Clock::duration::zero();
+}
+
+uint64_t Timer::skip()
+{
+    uint64_t last = passed(Clock::now());
+    if (last < next) {
+        return 0;
+    }
 
+    uint64_t skipped = last - next + 1;
+    next = last + 1;
+    return skipped;
+}
 
-Timer::initialize()
+Timer::Clock::duration Timer::wait()
 {
+    Clock::time_point now = Clock::now();
+
+    // Too late for the frames in between, skip to the last deadline that has passed
+    uint64_t last = passed(now);
+    if (last > next) {
+        missed_deadlines += last - next;
+        next = last;
+    }
+
+    Clock::time_point deadline = deadlineAt(next);
+    if (now < deadline - spin_time) {
+        std::this_thread::sleep_until(deadline - spin_time);
+    }
+    while ((now = Clock::now()) < deadline) {
+        // Spin the last stretch, waking up from a sleep takes longer than it
+    }
 
-}
\ No newline at end of file
+    Clock::duration lateness = now - deadline;
+    if (lateness > worst_lateness) {
+        worst_lateness = lateness;
+    }
+    ++next;
+    return lateness;
+}
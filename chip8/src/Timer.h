@@ -5,11 +5,79 @@
 #ifndef CHIP8_TIMER_H
 #define CHIP8_TIMER_H
 
+#include <chrono>
+#include <cstdint>
 
+/**
+ * Paces a loop at a fixed period against absolute steady_clock deadlines.
+ *
+ * Deadline n is start + n / frequency, computed from n and not by adding up rounded periods, so however
+ * late one wait returns the next deadline doesn't move and no drift accumulates.
+ * wait() sleeps until shortly before the deadline and spins the rest, sleeps alone wake up a
+ * millisecond or more late. A deadline that has already passed by a whole period when wait() is called
+ * is missed: it is counted and skipped instead of being caught up with a burst of frames.
+ */
 class Timer {
 public:
+    typedef std::chrono::steady_clock Clock;
+
+    /**
+     * A constructor
+     * @param frequency Deadlines per second
+     * @param spin Time before a deadline to stop sleeping and spin
+     */
+    explicit Timer(unsigned int frequency, Clock::duration spin = std::chrono::microseconds(500));
+
+    /**
+     * Start counting periods from now, the first deadline is a period away
+     */
+    void start();
+
+    /**
+     * Block until the next deadline
+     * @return How late it returned, the jitter of this wait
+     */
+    Clock::duration wait();
+
+    /**
+     * Skip the deadlines that passed while the caller wasn't pacing, e.g. while it slept waiting for
+     * input, without counting them as missed
+     * @return Number of deadlines skipped
+     */
+    uint64_t skip();
+
+    Clock::time_point deadline() const { return deadlineAt(next); }
+
+    /**
+     * @return Deadlines skipped because wait() was called a period or more after them
+     */
+    uint64_t missed() const { return missed_deadlines; }
+
+    /**
+     * @return Largest lateness of a wait since start()
+     */
+    Clock::duration worstLateness() const { return worst_lateness; }
 
 private:
+    unsigned int frequency;
+    Clock::duration spin_time;
+    Clock::time_point origin; // Time of start()
+    uint64_t next; // Index of the next deadline
+    uint64_t missed_deadlines;
+    Clock::duration worst_lateness;
+
+    /**
+     * @return Index of the last deadline at or before now
+     */
+    uint64_t passed(Clock::time_point now) const {
+        return (uint64_t) std::chrono::duration_cast<std::chrono::nanoseconds>(now - origin).count() * frequency
+               / 1000000000;
+    }
+
+    Clock::time_point deadlineAt(uint64_t index) const {
+        return origin + std::chrono::duration_cast<Clock::duration>(
+                std::chrono::nanoseconds(index * 1000000000 / frequency));
+    }
 };
 
 
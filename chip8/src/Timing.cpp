@@ -0,0 +1,21 @@
+//
+// Created by david on 18-10-26.
+//
+
+#include "Timing.h"
+
+static const char * const NAMES[] = {"fixed", "vip"};
+
+const char * timingName(TimingMode mode) {
+    return mode <= TIMING_VIP ? NAMES[mode] : "unknown";
+}
+
+bool parseTiming(const std::string & name, TimingMode & mode) {
+    for (unsigned int i = 0; i <= TIMING_VIP; ++i) {
+        if (name == NAMES[i]) {
+            mode = (TimingMode) i;
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,102 @@
+//
+// Created by david on 18-10-26.
+//
+
+#ifndef CHIP8_TIMING_H
+#define CHIP8_TIMING_H
+
+#include <cstdint>
+#include <string>
+#include "includes/globals.h"
+
+/**
+ * How long instructions take.
+ *
+ * Like the quirk profiles every timing model is a type, the interpreter is instantiated once per model.
+ * The cycle count of a machine is its clock: the timers tick and frames end every CYCLES_PER_FRAME
+ * cycles of the model, and an instruction advances the count by cost(opcode). The model of a machine
+ * is picked at load time with chip8::setTiming().
+ */
+enum TimingMode : uint8_t {
+    TIMING_FIXED, // Every instruction takes one cycle, CYCLES_PER_FRAME instructions per frame
+    TIMING_VIP, // COSMAC VIP machine cycles per instruction
+};
+
+struct FixedTiming {
+    static constexpr TimingMode MODE = TIMING_FIXED;
+    static constexpr uint64_t CYCLES_PER_FRAME = ::CYCLES_PER_FRAME;
+
+    static constexpr unsigned int cost(uint16_t) { return 1; }
+};
+
+/**
+ * Approximate execution times of the VIP interpreter's instructions in 1802 machine cycles, by the
+ * opcode's high nibble. Classes whose instructions differ are refined in VipTiming::cost().
+ */
+static constexpr uint16_t VIP_EXECUTE_CYCLES[16] = {
+        24, // 00E0 and 00EE, 0nnn machine code isn't run
+        23, // 1nnn
+        23, // 2nnn
+        12, // 3xkk
+        12, // 4xkk
+        16, // 5xy0
+        6, // 6xkk
+        10, // 7xkk
+        44, // 8xyn
+        16, // 9xy0
+        12, // Annn
+        23, // Bnnn
+        36, // Cxkk
+        26, // Dxyn, plus VIP_ROW_CYCLES per row
+        16, // Ex9E and ExA1
+        10, // Fx07, Fx0A, Fx15 and Fx18, the others are refined
+};
+
+struct VipTiming {
+    static constexpr TimingMode MODE = TIMING_VIP;
+
+    // 1.7609 MHz, 8 clocks per machine cycle, 60 Hz display interrupt
+    static constexpr uint64_t CYCLES_PER_FRAME = 3668;
+    // Fetching and decoding an instruction
+    static constexpr unsigned int FETCH_CYCLES = 40;
+    // Dxyn per sprite row, Fx55 and Fx65 per register
+    static constexpr unsigned int ROW_CYCLES = 14;
+
+    static constexpr unsigned int cost(uint16_t opcode) {
+        // Most classes cost the same for every instruction, one table load
+        if ((opcode & 0xF000) < 0xD000 || (opcode & 0xF000) == 0xE000) {
+            return FETCH_CYCLES + VIP_EXECUTE_CYCLES[opcode >> 12];
+        }
+        if ((opcode & 0xF000) == 0xD000) {
+            return FETCH_CYCLES + VIP_EXECUTE_CYCLES[0xD] + ROW_CYCLES * (opcode & 0x000F);
+        }
+        switch (opcode & 0xF0FF) {
+            case 0xF01E:
+                return FETCH_CYCLES + 19;
+            case 0xF029:
+                return FETCH_CYCLES + 20;
+            case 0xF033:
+                // Decimal conversion by repeated subtraction
+                return FETCH_CYCLES + 204;
+            case 0xF055:
+            case 0xF065:
+                return FETCH_CYCLES + ROW_CYCLES * (((opcode & 0x0F00) >> 8) + 1);
+            default:
+                return FETCH_CYCLES + VIP_EXECUTE_CYCLES[opcode >> 12];
+        }
+    }
+};
+
+/**
+ * @return Name of a timing model as parseTiming() accepts it
+ */
+const char * timingName(TimingMode mode);
+
+/**
+ * @param name fixed or vip
+ * @param mode Set to the named timing model
+ * @return False if there is no timing model by that name
+ */
+bool parseTiming(const std::string & name, TimingMode & mode);
+
+#endif //CHIP8_TIMING_H
@@ -0,0 +1,124 @@
+//
+// Created by david on 18-10-26.
+//
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "Trace.h"
+
+namespace trace {
+
+    std::atomic<bool> active( false );
+
+    namespace {
+        struct Event {
+            const char * name;
+            uint64_t start;
+            uint64_t duration;
+        };
+
+        /**
+         * Ring of the most recent spans of one thread, only that thread writes to it
+         */
+        struct ThreadBuffer {
+            unsigned int tid;
+            uint64_t recorded; // Spans recorded in total, the ring holds the last EVENTS_PER_THREAD
+            std::vector<Event> events;
+
+            explicit ThreadBuffer(unsigned int tid): tid( tid ), recorded( 0 ), events( EVENTS_PER_THREAD ) {}
+        };
+
+        std::mutex registry_mutex;
+        // Buffers are kept after their thread exits, so its spans still get exported
+        std::vector<std::unique_ptr<ThreadBuffer>> registry;
+        std::atomic<uint64_t> epoch( 0 );
+        volatile std::sig_atomic_t dump_requested = 0;
+        std::string output;
+
+        ThreadBuffer & threadBuffer() {
+            thread_local ThreadBuffer * buffer = nullptr;
+            if (!buffer) {
+                std::lock_guard<std::mutex> lock(registry_mutex);
+                registry.emplace_back(new ThreadBuffer((unsigned int) registry.size() + 1));
+                buffer = registry.back().get();
+            }
+            return *buffer;
+        }
+    }
+
+    void start() {
+        uint64_t unset = 0;
+        epoch.compare_exchange_strong(unset, now());
+        active.store(true, std::memory_order_relaxed);
+    }
+
+    void stop() {
+        active.store(false, std::memory_order_relaxed);
+    }
+
+    uint64_t now() {
+        return (uint64_t) std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    void record(const char * name, uint64_t start, uint64_t end) {
+        ThreadBuffer & buffer = threadBuffer();
+        buffer.events[buffer.recorded % EVENTS_PER_THREAD] = Event{name, start, end - start};
+        ++buffer.recorded;
+    }
+
+    void write(std::ostream & out) {
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        uint64_t base = epoch.load();
+
+        out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+        bool first = true;
+        char line[256];
+        for (const std::unique_ptr<ThreadBuffer> & buffer : registry) {
+            uint64_t count = buffer->recorded < EVENTS_PER_THREAD ? buffer->recorded : EVENTS_PER_THREAD;
+            for (uint64_t i = buffer->recorded - count; i < buffer->recorded; ++i) {
+                const Event & event = buffer->events[i % EVENTS_PER_THREAD];
+                // trace_event timestamps are in microseconds
+                std::snprintf(line, sizeof(line), "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                              first ? "\n" : ",\n", event.name, buffer->tid, (event.start - base) / 1000.0,
+                              event.duration / 1000.0);
+                out << line;
+                first = false;
+            }
+        }
+        out << "\n]}\n";
+    }
+
+    bool writeFile(const std::string & path) {
+        std::ofstream out(path, std::ios::out | std::ios::trunc);
+        if (!out) {
+            return false;
+        }
+        write(out);
+        return (bool) out;
+    }
+
+    void setOutput(const std::string & path) {
+        output = path;
+    }
+
+    bool dump() {
+        return output.empty() || writeFile(output);
+    }
+
+    void requestDump() {
+        dump_requested = 1;
+    }
+
+    bool takeDumpRequest() {
+        if (!dump_requested) {
+            return false;
+        }
+        dump_requested = 0;
+        return true;
+    }
+}
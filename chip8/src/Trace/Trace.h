@@ -0,0 +1,112 @@
+//
+// Created by david on 18-10-26.
+//
+
+#ifndef CHIP8_TRACE_H
+#define CHIP8_TRACE_H
+
+#include <atomic>
+#include <csignal>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+/**
+ * Scoped spans around the stages of a frame, exported as Chrome trace_event JSON (chrome://tracing,
+ * Perfetto).
+ *
+ * Every thread records into its own ring of the most recent EVENTS_PER_THREAD spans, so recording takes
+ * no lock. While tracing is off a span costs one relaxed load and a branch.
+ */
+namespace trace {
+
+    static const size_t EVENTS_PER_THREAD = 1u << 16;
+
+    extern std::atomic<bool> active;
+
+    inline bool enabled() {
+        return active.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Start recording, timestamps are relative to the first start()
+     */
+    void start();
+
+    void stop();
+
+    /**
+     * @return Steady clock time in nanoseconds
+     */
+    uint64_t now();
+
+    /**
+     * Add a complete span to the calling thread's buffer
+     * @param name Name of the span, must be a string literal or otherwise outlive the trace
+     */
+    void record(const char * name, uint64_t start, uint64_t end);
+
+    /**
+     * Write the spans of all threads as a trace_event JSON object.
+     * Threads other than the calling one should not be recording meanwhile.
+     */
+    void write(std::ostream & out);
+
+    /**
+     * Write the spans of all threads to a file
+     * @return False if the file couldn't be written
+     */
+    bool writeFile(const std::string & path);
+
+    /**
+     * Set the file dump() writes to
+     */
+    void setOutput(const std::string & path);
+
+    /**
+     * Write all spans to the output file, if there is one
+     * @return False if the output file couldn't be written
+     */
+    bool dump();
+
+    /**
+     * Ask for the trace to be written, safe to call from a signal handler
+     */
+    void requestDump();
+
+    /**
+     * @return Whether a dump was requested since the last call
+     */
+    bool takeDumpRequest();
+
+    /**
+     * Records the time from its construction to its destruction, if tracing was on when it was constructed
+     */
+    class Span {
+    public:
+        explicit Span(const char * name): name( enabled() ? name : nullptr ), start( this->name ? now() : 0 ) {}
+
+        ~Span() {
+            if (name) {
+                record(name, start, now());
+            }
+        }
+
+        Span(const Span &) = delete;
+        Span & operator=(const Span &) = delete;
+
+    private:
+        const char * name;
+        uint64_t start;
+    };
+}
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+
+/**
+ * Trace the rest of the enclosing scope
+ */
+#define TRACE_SPAN(name) trace::Span TRACE_CONCAT(trace_span_, __LINE__)(name)
+
+#endif //CHIP8_TRACE_H
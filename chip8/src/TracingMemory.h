@@ -0,0 +1,45 @@
+//
+// Created by david on 18-10-26.
+//
+
+#ifndef CHIP8_TRACINGMEMORY_H
+#define CHIP8_TRACINGMEMORY_H
+
+#include <cstring>
+#include "Memory.h"
+
+/**
+ * Memory that counts the instruction fetches, reads and writes of every address, e.g. for a heat map.
+ * Machine calls the memory policy's members directly, so the counting costs no virtual calls.
+ */
+struct TracingMemory : public Memory {
+    // Counted from the const accessors too
+    mutable uint32_t fetches[RAM_SIZE];
+    mutable uint32_t reads[RAM_SIZE];
+    uint32_t writes[RAM_SIZE];
+
+    TracingMemory(): fetches(), reads(), writes() {}
+
+    void resetCounts() {
+        memset(fetches, 0, sizeof(fetches));
+        memset(reads, 0, sizeof(reads));
+        memset(writes, 0, sizeof(writes));
+    }
+
+    inline uint16_t getOpcode(unsigned int index) const {
+        ++fetches[index & (RAM_SIZE - 1)];
+        return Memory::getOpcode(index);
+    }
+
+    inline uint8_t read(unsigned int address) const {
+        ++reads[address & (RAM_SIZE - 1)];
+        return Memory::read(address);
+    }
+
+    inline void write(unsigned int address, uint8_t value) {
+        ++writes[address & (RAM_SIZE - 1)];
+        Memory::write(address, value);
+    }
+};
+
+#endif //CHIP8_TRACINGMEMORY_H
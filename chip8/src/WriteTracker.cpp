@@ -0,0 +1,79 @@
+//
+// Created by david on 18-10-26.
+//
+
+#include <cstring>
+#include "WriteTracker.h"
+
+WriteTracker::WriteTracker(): code_pages(), stats() {}
+
+void WriteTracker::reset() {
+    code_pages = 0;
+    std::memset(&stats, 0, sizeof(stats));
+}
+
+void WriteTracker::discard(uint64_t pages) {
+    pages &= code_pages;
+    code_pages &= ~pages;
+
+    if (!invalidation_handler) {
+        return;
+    }
+    for (unsigned int page = 0; page < PAGE_COUNT; ++page) {
+        if (pages & (uint64_t(1) << page)) {
+            invalidation_handler(page);
+        }
+    }
+}
+
+void WriteTracker::setInvalidationHandler(std::function<void(unsigned int page)> handler) {
+    invalidation_handler = std::move(handler);
+}
+
+void WriteTracker::invalidate(uint64_t pages, unsigned short pc) {
+    if (stats.code_writes == 0) {
+        stats.first_smc_pc = pc;
+    }
+    ++stats.code_writes;
+
+    // The page is no longer cached, it is marked again when it is executed again
+    code_pages &= ~pages;
+
+    for (unsigned int page = 0; page < PAGE_COUNT; ++page) {
+        if (pages & (uint64_t(1) << page)) {
+            ++stats.invalidations;
+            ++stats.page_invalidations[page];
+            if (invalidation_handler) {
+                invalidation_handler(page);
+            }
+        }
+    }
+}
+
+void WriteTracker::report(std::ostream & out, const std::string & romName) const {
+    out << "smc rom=" << romName
+        << " writes=" << stats.writes
+        << " code_writes=" << stats.code_writes
+        << " invalidations=" << stats.invalidations;
+
+    if (stats.code_writes > 0) {
+        out << " first_pc=0x" << std::hex << stats.first_smc_pc << std::dec;
+    }
+
+    out << " pages=";
+    bool first = true;
+    for (unsigned int page = 0; page < PAGE_COUNT; ++page) {
+        if (stats.page_invalidations[page] == 0) {
+            continue;
+        }
+        if (!first) {
+            out << ",";
+        }
+        out << "0x" << std::hex << page * PAGE_SIZE << std::dec << ":" << stats.page_invalidations[page];
+        first = false;
+    }
+    if (first) {
+        out << "-";
+    }
+    out << "\n";
+}
@@ -0,0 +1,125 @@
+//
+// Created by david on 18-10-26.
+//
+
+#ifndef CHIP8_WRITETRACKER_H
+#define CHIP8_WRITETRACKER_H
+
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+
+/**
+ * Self-modifying code detection.
+ *
+ * Memory is split into 64 pages of 64 bytes. A page is marked as code as soon as an instruction is
+ * fetched (and thereby possibly cached) from it, and one bit per page is kept in a single 64-bit bitmap.
+ * Stores only have to test that bitmap: stores into pure data pages cost one AND, stores into code
+ * pages unmark the page and invoke the invalidation handler for exactly that page.
+ */
+class WriteTracker {
+public:
+    static const unsigned int PAGE_SHIFT = 6;
+    static const unsigned int PAGE_SIZE = 1u << PAGE_SHIFT;
+    static const unsigned int PAGE_COUNT = 4096 / PAGE_SIZE;
+
+    struct Statistics {
+        uint64_t writes; // Tracked stores (Fx33, Fx55)
+        uint64_t code_writes; // Stores that hit at least one code page
+        uint64_t invalidations; // Pages invalidated in total
+        uint32_t page_invalidations[PAGE_COUNT]; // Invalidations per page
+        unsigned short first_smc_pc; // pc of the first store into code, only valid if code_writes > 0
+    };
+
+    WriteTracker();
+
+    /**
+     * Remove all code marks and reset the statistics, e.g. when a new program is loaded
+     */
+    void reset();
+
+    /**
+     * Drop the code marks of pages and invalidate the ones that were marked, e.g. when memory is replaced
+     * by a snapshot. This is not counted as self-modifying code.
+     * @param pages Bitmap of pages
+     */
+    void discard(uint64_t pages);
+
+    void invalidateAll() {
+        discard(~uint64_t(0));
+    }
+
+    /**
+     * Set the function that is called with the page number of every invalidated page
+     * @param handler Invalidation handler, may be empty
+     */
+    void setInvalidationHandler(std::function<void(unsigned int page)> handler);
+
+    /**
+     * Mark the page containing an instruction as code
+     * @param address Address of the instruction, the page of the second byte is marked as well
+     */
+    inline void markCode(unsigned short address) {
+        code_pages |= pageSpan(address, 2);
+    }
+
+    /**
+     * Record a store into memory
+     * @param address First address written
+     * @param length Number of bytes written
+     * @param pc Program counter of the storing instruction
+     */
+    inline void noteWrite(unsigned short address, unsigned int length, unsigned short pc) {
+        ++stats.writes;
+        uint64_t hit = code_pages & pageSpan(address, length);
+        if (hit) {
+            invalidate(hit, pc);
+        }
+    }
+
+    bool isCode(unsigned short address) const {
+        return (code_pages >> ((address & 0x0FFF) >> PAGE_SHIFT)) & 1u;
+    }
+
+    uint64_t codePages() const { return code_pages; }
+
+    const Statistics & statistics() const { return stats; }
+
+    /**
+     * Replace the statistics, the code marks are left alone
+     */
+    void loadStatistics(const Statistics & statistics) { stats = statistics; }
+
+    /**
+     * Write a single line summary of the statistics
+     * @param out Stream to write to
+     * @param romName Name of the program the statistics belong to
+     */
+    void report(std::ostream & out, const std::string & romName) const;
+
+private:
+    uint64_t code_pages;
+    Statistics stats;
+    std::function<void(unsigned int page)> invalidation_handler;
+
+    /**
+     * Bitmap of the pages touched by length bytes starting at address.
+     * CHIP-8 addresses wrap at 4096, so does this.
+     */
+    static inline uint64_t pageSpan(unsigned short address, unsigned int length) {
+        unsigned int first = (address & 0x0FFF) >> PAGE_SHIFT;
+        unsigned int last = ((address + length - 1) & 0x0FFF) >> PAGE_SHIFT;
+        if (last >= first) {
+            uint64_t upper = last == PAGE_COUNT - 1 ? ~uint64_t(0) : (uint64_t(1) << (last + 1)) - 1;
+            return upper & ~((uint64_t(1) << first) - 1);
+        }
+        // Wrapped around the end of memory
+        return ~((uint64_t(1) << first) - 1) | ((uint64_t(1) << (last + 1)) - 1);
+    }
+
+    void invalidate(uint64_t pages, unsigned short pc);
+};
+
+
+#endif //CHIP8_WRITETRACKER_H
@@ -1,670 +1,132 @@
 //
 // Created by David Strootman on 9-4-2019.
 //
-// Most of the comments in this file come from Cowgod's Chip-8 Technical reference
-//
 
-#include <thread>
-#include <cmath>
 #include "chip8.h"
 
-chip8::chip8(SDL_Window * screen): I(), sp(), delay_timer(), sound_timer(), draw_flag(), gfx(), screen( screen ), V()
-{
-    pc = 0x200; // Program counter (First 512/0x200 bytes are reserved for Chip8)
-    opcode = 0; // Current opcode
+void chip8::saveCpu(CpuState & cpu) const {
+    cpu.pc = pc;
+    cpu.opcode = opcode;
+    cpu.I = I;
+    cpu.sp = sp;
+    memcpy(cpu.stack, stack, sizeof(cpu.stack));
+
+    memcpy(cpu.V, V, sizeof(cpu.V));
+    cpu.delay_timer = delayTimer();
+    cpu.sound_timer = soundTimer();
+    cpu.draw_flag = draw_flag;
+    cpu.fault = fault_state;
+
+    cpu.rng_state = rng_state;
+    cpu.keys = input.state();
+    cpu.key_wait = key_wait;
+    cpu.quirks = quirk_profile;
+    cpu.timing = timing_mode;
+    memset(cpu.padding, 0, sizeof(cpu.padding));
+
+    cpu.cycles = cycles;
 }
 
-void chip8::loadProgram(const unsigned char * program, int size) {
-    for (int i = 0; i < size; ++i) {
-        memory[i + 512] = program[i];
-    }
+void chip8::loadCpu(const CpuState & cpu) {
+    pc = cpu.pc;
+    opcode = cpu.opcode;
+    I = cpu.I;
+    sp = cpu.sp;
+    memcpy(stack, cpu.stack, sizeof(stack));
+
+    memcpy(V, cpu.V, sizeof(V));
+    draw_flag = cpu.draw_flag != 0;
+    fault_state = (Fault) cpu.fault;
+
+    rng_state = cpu.rng_state;
+    input.load(cpu.keys);
+    key_wait = cpu.key_wait;
+    quirk_profile = (QuirkProfile) cpu.quirks;
+
+    setTiming((TimingMode) cpu.timing);
+    cycles = cpu.cycles;
+    loadTimers(cpu.delay_timer, cpu.sound_timer);
 }
 
-void chip8::initialize()
-{
-    renderer = SDL_CreateRenderer(screen, -1, SDL_RENDERER_ACCELERATED);
-    // zero-initialize gfx, stack, registers and memory
-    memset(gfx, 0, sizeof(gfx));
-    memset(stack, 0, sizeof(stack));
-    memset(V, 0, sizeof(V));
-    memset(memory, 0, sizeof(memory));
-
-    for (int i = 0; i < 80; ++i) {
-        memory[i] = chip8_fontset[i];
-    }
-
-    I = 0; // Index Register
-    sp = 0; // Stack pointer
-    pc = 0x200; // program counter (starts at first byte of program memory: 512)
-
-    draw_flag = false;
-
-    delay_timer = 0;
-    sound_timer = 0;
+void chip8::saveCounters(Counters & counters) const {
+    counters.instructions = instructions;
+    counters.writes = write_tracker.statistics();
+#ifdef CHIP8_PROFILE
+    counters.profile = profile.statistics();
+#endif
 }
 
-void chip8::run() {
-    timer_loop();
+void chip8::loadCounters(const Counters & counters) {
+    instructions = counters.instructions;
+    write_tracker.loadStatistics(counters.writes);
+#ifdef CHIP8_PROFILE
+    profile.load(counters.profile);
+#endif
 }
 
-void chip8::timer_loop()
-{
-    // this obviously doesn't work
-    for(;;) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(1000 / 60));
-        if (delay_timer > 0)
-            --delay_timer;
-        if (sound_timer > 0)
-            --sound_timer;
-        emulateCycle();
-        updateScreen();
-    }
-}
-
-void chip8::emulateCycle()
-{
-    // Program memory starts at 512
-    opcode = memory[pc] << 8 | memory[pc + 1];
-
-    char reg1 = 0x00;
-    std::cout << "pc: " << (pc - 512) << ", opcode: " << std::hex << (opcode) << std::endl;
-
-    // Decode opcode
-    switch (opcode & 0xF000) {
-        case 0x0000: {
-            switch (opcode & 0x0FF0) {
-                case 0x00E0: {
-                    switch (opcode & 0x000F) {
-                        case 0x0000: {
-                            /*
-                             * 00E0 - CLS
-                             * Clear the display.
-                             */
-                            memset(gfx, 0, sizeof(gfx));
-                            return;
-                        }
-                        case 0x000E: {
-
-                            /*
-                             * 00EE - RET
-                             * Return from a subroutine.
-                             *
-                             * The interpreter sets the program counter to the address at the top of the stack,
-                             * then subtracts 1 from the stack pointer.
-                             */
-                            pc = stack[sp--] + 2;
-                            return;
-                        }
-                        default: {
-                            goto unknown_opcode;
-                        }
-                    }
-                }
-                default: {
-                    /**
-                     * 0nnn - SYS addr
-                     * Jump to a machine code routine at nnn.
-                     *
-                     * This instruction is only used on the old computers on which Chip-8 was originally implemented.
-                     * !!!!!!!!!!!!!!It is ignored by modern interpreters.!!!!!!!!!!!!!!!!
-                     */
-                    pc += 2;
-                    return;
-                }
-            }
-        }
-
-        case 0x1000: {
-            /*
-             * 1nnn - JP addr
-             * Jump to location nnn.
-             * The interpreter sets the program counter to nnn.
-             */
-            pc = NNN;
-            return;
-        }
-
-        case 0x2000: {
-            /*
-             * 2nnn - CALL addr
-             * Call subroutine at nnn.
-             *
-             * The interpreter increments the stack pointer, then puts the current PC on the top of the stack.
-             * The PC is then set to nnn.
-             */
-            ++sp;
-            stack[sp] = pc;
-            pc = NNN;
-            return;
-        }
-
-        case 0x3000: {
-            /*
-             * 3xkk - SE Vx, byte
-             * Skip next instruction if Vx = kk.
-             *
-             * The interpreter compares register Vx to kk, and if they are equal, increments the program counter by 2.
-             */
-
-            if (X == KK) {
-                pc += 2;
-            }
-            pc += 2;
-            return;
-        }
-
-        case 0x4000: {
-            /*
-             * 4xkk - SNE Vx, byte
-             * Skip next instruction if Vx != kk.
-             *
-             * The interpreter compares register Vx to kk, and if they are not equal, increments the program counter by 2.
-             */
-
-            if (X != KK) {
-                pc += 2;
-            }
-            pc += 2;
-            return;
-        }
-
-        case 0x5000: {
-            /*
-             * 5xy0 - SE Vx, Vy
-             * Skip next instruction if Vx = Vy.
-             *
-             * The interpreter compares register Vx to register Vy, and if they are equal,
-             * increments the program counter by 2.
-             */
-
-            if (X == Y) {
-                pc += 2;
-            }
-            pc += 2;
-            return;
-        }
-
-        case 0x6000: {
-            /*
-             * 6xkk - LD Vx, byte
-             * Set Vx = kk.
-             *
-             * The interpreter puts the value kk into register Vx.
-             */
-            V[X] = KK;
-
-            pc += 2;
-            return;
-        }
-
-        case 0x7000: {
-            /*
-             * 7xkk - ADD Vx, byte
-             * Set Vx = Vx + kk.
-             *
-             * Adds the value kk to the value of register Vx, then stores the result in Vx.
-             */
-            V[X] += KK;
-
-            pc += 2;
-            return;
-        }
-
-        case 0x8000: {
-            switch (opcode & 0x000F) {
-                case 0x0000: {
-                    /*
-                     * 8xy0 - LD Vx, Vy
-                     * Set Vx = Vy.
-                     *
-                     * Stores the value of register Vy in register Vx.
-                     */
-                    V[X] = V[Y];
-
-                    pc += 2;
-                    return;
-                }
-
-                case 0x0001: {
-                    /*
-                     * 8xy1 - OR Vx, Vy
-                     * Set Vx = Vx OR Vy.
-                     *
-                     * Performs a bitwise OR on the values of Vx and Vy, then stores the result in Vx.
-                     * A bitwise OR compares the corresponding bits from two values, and if either bit is 1,
-                     * then the same bit in the result is also 1. Otherwise, it is 0.
-                     */
-                    V[X] |= V[Y];
-
-                    pc += 2;
-                    return;
-                }
-
-                case 0x0002: {
-                    /*
-                     * 8xy2 - AND Vx, Vy
-                     * Set Vx = Vx AND Vy.
-                     *
-                     * Performs a bitwise AND on the values of Vx and Vy, then stores the result in Vx.
-                     * A bitwise AND compares the corresponding bits from two values, and if both bits are 1,
-                     * then the same bit in the result is also 1. Otherwise, it is 0.
-                     */
-                    V[X] &= V[Y];
-
-                    pc += 2;
-                    return;
-                }
-
-                case 0x0003: {
-                    /*
-                     * 8xy3 - XOR Vx, Vy
-                     * Set Vx = Vx XOR Vy.
-                     *
-                     * Performs a bitwise exclusive OR on the values of Vx and Vy, then stores the result in Vx.
-                     * An exclusive OR compares the corresponding bits from two values,
-                     * and if the bits are not both the same, then the corresponding bit in the result is set to 1.
-                     * Otherwise, it is 0.
-                     */
-                    V[X] ^= V[Y];
-
-                    pc += 2;
-                    return;
-                }
-
-                case 0x0004: {
-                    /*
-                     * 8xy4 - ADD Vx, Vy
-                     * Set Vx = Vx + Vy, set VF = carry.
-                     *
-                     * The values of Vx and Vy are added together.
-                     * If the result is greater than 8 bits (i.e., > 255,) VF is set to 1, otherwise 0.
-                     * Only the lowest 8 bits of the result are kept, and stored in Vx.
-                     */
-                    if ((V[X] += V[Y]) > 255) {
-                        V[0xF] = 1;
-                    } else {
-                        V[0xF] = 0;
-                    }
-
-                    V[X] &= 0x00FF;
-
-                    pc += 2;
-                    return;
-                }
-
-                case 0x0005: {
-                    /*
-                     * 8xy5 - SUB Vx, Vy
-                     * Set Vx = Vx - Vy, set VF = NOT borrow.
-                     *
-                     * If Vx > Vy, then VF is set to 1, otherwise 0.
-                     * Then Vy is subtracted from Vx, and the results stored in Vx.
-                     */
-                    V[X] -= V[Y];
-                    V[0xF] = V[X] > V[Y];
-
-                    pc += 2;
-                    return;
-                }
-
-                case 0x0006: {
-                    /*
-                     * 8xy6 - SHR Vx {, Vy}
-                     * Set Vx = Vx SHR 1.
-                     *
-                     * If the least-significant bit of Vx is 1, then VF is set to 1, otherwise 0.
-                     * Then Vx is divided by 2.
-                     */
-                    V[0xF] = V[X] & 1;
-                    V[X] >>= 1;
-
-                    pc += 2;
-                    return;
-                }
-
-                case 0x0007: {
-                    /*
-                     * 8xy7 - SUBN Vx, Vy
-                     * Set Vx = Vy - Vx, set VF = NOT borrow.
-                     *
-                     * If Vy > Vx, then VF is set to 1, otherwise 0.
-                     * Then Vx is subtracted from Vy, and the results stored in Vx.
-                     */
-                    V[0xF] = V[Y] > V[X];
-                    V[X] = V[Y] - V[X];
+void chip8::snapshot(Snapshot & snapshot) const {
+    snapshot.magic = Snapshot::MAGIC;
+    snapshot.version = Snapshot::VERSION;
 
-                    pc += 2;
-                    return;
-                }
+    saveCpu(snapshot.cpu);
 
-                case 0x000E: {
-                    /*
-                     * 8xyE - SHL Vx {, Vy}
-                     * Set Vx = Vx SHL 1.
-                     *
-                     * If the most-significant bit of Vx is 1, then VF is set to 1, otherwise to 0.
-                     * Then Vx is multiplied by 2.
-                     */
-                    V[X] <<= 1;
-                    V[0xF] = V[X] & 0x80;
-
-                    pc += 2;
-                    return;
-                }
-
-                default: {
-                    goto unknown_opcode;
-                }
-            }
-            return;
-        }
-
-        case 0x9000: {
-            /*
-             * 9xy0 - SNE Vx, Vy
-             * Skip next instruction if Vx != Vy.
-             *
-             * The values of Vx and Vy are compared, and if they are not equal, the program counter is increased by 2.
-             */
-            pc += (V[X] != V[Y]) ? 2 : 0;
-
-            pc += 2;
-            return;
-        }
-
-        case 0xA000: {
-            /*
-             * Annn - LD I, addr
-             * Set I = nnn.
-             *
-             * The value of register I is set to nnn.
-             */
-            I = opcode & 0x0FFF;
-
-            pc += 2;
-            return;
-        }
-
-        case 0xB000: {
-            /*
-             * Bnnn - JP V0, addr
-             * Jump to location nnn + V0.
-             *
-             * The program counter is set to nnn plus the value of V0.
-             */
-            pc = NNN + V[0x0];
-
-            pc += 2;
-            return;
-        }
-
-        case 0xC000: {
-            /*
-             * Cxkk - RND Vx, byte
-             * Set Vx = random byte AND kk.
-             *
-             * The interpreter generates a random number from 0 to 255, which is then ANDed with the value kk.
-             * The results are stored in Vx. See instruction 8xy2 for more information on AND.
-             */
-
-            auto randVal = (unsigned char) rand();
-            V[X] = randVal & KK;
-
-            pc += 2;
-            return;
-        }
-
-        case 0xD000: {
-            /*
-             * Dxyn - DRW Vx, Vy, nibble
-             * Display n-byte sprite starting at memory location I at (Vx, Vy), set VF = collision.
-             *
-             * The interpreter reads n bytes from memory, starting at the address stored in I. These bytes are
-             * then displayed as sprites on screen at coordinates (Vx, Vy). Sprites are XORed onto the existing screen.
-             * If this causes any pixels to be erased, VF is set to 1, otherwise it is set to 0. If the sprite is
-             * positioned so part of it is outside the coordinates of the display, it wraps around to the opposite
-             * side of the screen. See instruction 8xy3 for more information on XOR, and section 2.4, Display,
-             * for more information on the Chip-8 screen and sprites.
-             */
-            uint8_t pixel;
-
-            V[0xF] = 0;
-            for (int yline = 0; yline < N; ++yline) {
-                pixel = memory[I + yline];
-                for (int x_line = 0; x_line < 8; ++x_line) {
-                    if ((pixel & (0x80 >> x_line)) != 0) {
-                        if (gfx[V[X] + x_line + ((V[Y] + yline) * 64)] == 1)
-                            V[0xF] = 1;
-                        gfx[X + x_line + ((Y + yline) * 64)] ^= 1;
-                    }
-                }
-            }
-
-            draw_flag = true;
-
-            pc += 2;
-            return;
-        }
+    memcpy(snapshot.gfx, display.pixels, sizeof(snapshot.gfx));
+    memcpy(snapshot.memory, memory.bytes, sizeof(snapshot.memory));
+}
 
-        case 0xE000: {
-            switch (opcode & 0x00FF) {
-                case 0x009E: {
-                    /*
-                     * Ex9E - SKP Vx
-                     * Skip next instruction if key with the value of Vx is pressed.
-                     *
-                     * Checks the keyboard, and if the key corresponding to the value of Vx is currently in
-                     * the down position, PC is increased by 2.
-                     */
-                    //TODO: key state
-//                    if (getKeyState(V[X]) & 0x8000) {
-//                        pc += 2;
-//                    }
-                    pc += 2;
-                    goto not_implemented;
-                    return;
-                }
+Snapshot chip8::snapshot() const {
+    Snapshot result;
+    snapshot(result);
+    return result;
+}
 
-                case 0x00A1: {
-                    /*
-                     * ExA1 - SKNP Vx
-                     * Skip next instruction if key with the value of Vx is not pressed.
-                     *
-                     * Checks the keyboard, and if the key corresponding to the value of Vx is currently in
-                     * the up position, PC is increased by 2.
-                     */
-                    //TODO: Key state
-//                    if (!(getKeyState(V[X]) & 0x8000)) {
-//                        pc += 2;
-//                    }
+void chip8::restore(const Snapshot & snapshot) {
+    loadCpu(snapshot.cpu);
 
-                    pc += 2;
-                    goto not_implemented;
-                    return;
-                }
+    memcpy(display.pixels, snapshot.gfx, sizeof(display.pixels));
+    display.dirty_rows = ~uint64_t(0);
 
-                default: {
-                    goto unknown_opcode;
-                }
-            }
-            return;
+    // Only the pages that differ are copied, and only what was cached from those is stale. Restoring the
+    // state a run-ahead or a rewind started from keeps the code pages of a program that didn't change them
+    uint64_t changed = 0;
+    for (unsigned int page = 0; page < RAM_SIZE / Memory::PAGE_SIZE; ++page) {
+        unsigned int address = page * Memory::PAGE_SIZE;
+        if (memcmp(memory.bytes + address, snapshot.memory + address, Memory::PAGE_SIZE) != 0) {
+            memory.load(address, snapshot.memory + address, Memory::PAGE_SIZE);
+            changed |= uint64_t(1) << page;
         }
+    }
+    write_tracker.discard(changed);
+}
 
-        case 0xF000: {
-            switch (opcode & 0x00F0) {
-                case 0x0000: {
-                    switch (opcode & 0x000F) {
-                        case 0x0007: {
-                            /*
-                             * Fx07 - LD Vx, DT
-                             * Set Vx = delay timer value.
-                             *
-                             * The value of DT is placed into Vx.
-                             */
-                            V[X] = delay_timer;
-
-                            pc += 2;
-                            return;
-                        }
-
-                        case 0x000A: {
-                            /*
-                             * Fx0A - LD Vx, K
-                             * Wait for a key press, store the value of the key in Vx.
-                             *
-                             * All execution stops until a key is pressed, then the value of that key is stored in Vx.
-                            */
-                            unsigned char key;
-                            //TODO: Key press
-//                            key = getch();
-                            V[X] = key;
-
-                            pc += 2;
-                            goto not_implemented;
-                            return;
-                        }
-
-                        default: {
-                            goto unknown_opcode;
-                        }
-                    }
-                }
-
-                case 0x0010: {
-                    switch (opcode & 0x000F) {
-                        case 0x0005: {
-                            /*
-                             * Fx15 - LD DT, Vx
-                             * Set delay timer = Vx.
-                             *
-                             * DT is set equal to the value of Vx.
-                             */
-                            delay_timer = V[X];
-
-                            pc += 2;
-                            return;
-                        }
-
-                        case 0x0008: {
-                            /*
-                             * Fx18 - LD ST, Vx
-                             * Set sound timer = Vx.
-                             *
-                             * ST is set equal to the value of Vx.
-                             */
-                            sound_timer = V[X];
-
-                            pc += 2;
-                            return;
-                        }
-
-                        case 0x000E: {
-                            /*
-                             * Fx1E - ADD I, Vx
-                             * Set I = I + Vx.
-                             *
-                             * The values of I and Vx are added, and the results are stored in I.
-                             */
-                            I += V[X];
-
-                            pc += 2;
-                            return;
-                        }
-
-                        default: {
-                            goto unknown_opcode;
-                        }
-                    }
-                }
-
-                case 0x0020: {
-                    // TODO: Make sure this works
-                    /*
-                     * Fx29 - LD F, Vx
-                     * Set I = location of sprite for digit Vx.
-                     *
-                     * The value of I is set to the location for the hexadecimal sprite corresponding to
-                     * the value of Vx. See section 2.4, Display, for more information on the Chip-8 hexadecimal font.
-                     */
-                    I = memory[V[X] * 5];
-
-                    pc += 2;
-                    goto not_implemented;
-                    return;
-                }
-
-                case 0x0030: {
-                    /*
-                     * Fx33 - LD B, Vx
-                     * Store BCD representation of Vx in memory locations I, I+1, and I+2.
-                     *
-                     * The interpreter takes the decimal value of Vx, and places the hundreds digit in memory at
-                     * location in I, the tens digit at location I+1, and the ones digit at location I+2.
-                     */
-                    memory[I] = V[X] % 10;
-                    memory[I + 1] = (unsigned char)round((V[X] / 10) % 10);
-                    memory[I + 2] = (unsigned char)round((V[X] / 100) % 10);
-
-                    pc+=2;
-                    return;
-                }
-
-                case 0x0050: {
-                    /*
-                     * Fx55 - LD [I], Vx
-                     * Store registers V0 through Vx in memory starting at location I.
-                     *
-                     * The interpreter copies the values of registers V0 through Vx into memory,
-                     * starting at the address in I.
-                     */
-                    for (unsigned int i = 0; i < X; ++i) {
-                        memory[I + i] = V[0 + i];
-                    }
+void chip8::snapshot(PagedSnapshot & snapshot, PageStore & store) {
+    if (page_cache.store() != &store) {
+        // Nothing in the cache is known to the new store
+        page_cache = PagedSnapshot(store);
+    }
 
-                    pc += 2;
-                    return;
-                }
+    // Copy-on-write: only pages written since the last paged snapshot or restore become new pages,
+    // all others are shared with the previous snapshots
+    page_cache.capture(memory.bytes, memory.dirty_pages, display.pixels, display.dirty_rows);
+    memory.dirty_pages = 0;
+    display.dirty_rows = 0;
 
-                case 0x0060: {
-                    /*
-                     * Fx65 - LD Vx, [I]
-                     * Read registers V0 through Vx from memory starting at location I.
-                     *
-                     * The interpreter reads values from memory starting at location I into registers V0 through Vx.
-                     */
+    saveCpu(page_cache.cpu);
+    snapshot = page_cache;
+}
 
-                    for (int i = 0; i < X; ++i) {
-                        V[i] = memory[I + i];
-                    }
+void chip8::restore(const PagedSnapshot & snapshot) {
+    loadCpu(snapshot.cpu);
 
-                    pc += 2;
-                    return;
-                }
+    // Only pages that differ from what is in memory right now are copied
+    uint64_t changed = snapshot.apply(page_cache, memory.dirty_pages, display.dirty_rows, memory, display.pixels);
+    page_cache = snapshot;
+    memory.dirty_pages = 0;
+    display.dirty_rows = 0;
 
-                default: {
-                    goto unknown_opcode;
-                }
-            }
-        }
-        not_implemented:
-            std::cout << "not implemented: " << opcode << "\n";
-            return;
-        default: {
-        unknown_opcode:
-            std::cout << "Unknown opcode: " << opcode << "\n";
-        }
-    }
+    write_tracker.discard(changed);
 }
 
-void chip8::updateScreen() {
-    //TODO: implement front-end
-//    for (unsigned int y = 0; y < 32; ++y) {
-//        for (unsigned int x = 0; x < 64; ++x) {
-//            if (gfx[x] == 1) {
-//                SDL_RenderDrawPoint(renderer, x, y);
-//            } else {
-//
-//            }
-//        }
-//    }
-};
\ No newline at end of file
+void chip8::releasePages() {
+    page_cache = PagedSnapshot();
+}
@@ -5,66 +5,79 @@
 #ifndef CHIP8_CHIP8_H
 #define CHIP8_CHIP8_H
 
-#include <SDL.h>
-#include <iostream>
-#include <cstring>
-
-#include "opcode_helper.h"
-#include "NotImplementedException.h"
-
-class chip8 {
+#include "Machine.h"
+#include "Snapshot.h"
+#include "PagedSnapshot.h"
+
+/**
+ * The machine the frontends and the tools work with: a byte per pixel framebuffer and the hex keypad,
+ * plus full and paged snapshots of the complete state.
+ */
+class chip8 : public Machine<Memory, FrameBuffer, Keypad> {
     private:
-        unsigned char gfx[64 * 32]; // Temporary display
-        SDL_Window * screen;
-        SDL_Renderer * renderer; // SDL Renderer to use with window
-        unsigned short pc; // Program counter (First 512/0x200 bytes are reserved for Chip8)
-        unsigned short opcode; // Current opcode
-
-        unsigned char V[16]; // Registers
-        unsigned short I; // Index Register
+        PagedSnapshot page_cache; // Pages of the last paged snapshot taken or restored
 
-        unsigned short stack[16] = {}; // Stack
-        unsigned short sp; // Stack pointer
-
-        unsigned char delay_timer;
-        unsigned char sound_timer;
-
-        unsigned char chip8_fontset[80] =
-        {
-            0xF0, 0x90, 0x90, 0x90, 0xF0, // 0
-            0x20, 0x60, 0x20, 0x20, 0x70, // 1
-            0xF0, 0x10, 0xF0, 0x80, 0xF0, // 2
-            0xF0, 0x10, 0xF0, 0x10, 0xF0, // 3
-            0x90, 0x90, 0xF0, 0x10, 0x10, // 4
-            0xF0, 0x80, 0xF0, 0x10, 0xF0, // 5
-            0xF0, 0x80, 0xF0, 0x90, 0xF0, // 6
-            0xF0, 0x10, 0x20, 0x40, 0x40, // 7
-            0xF0, 0x90, 0xF0, 0x90, 0xF0, // 8
-            0xF0, 0x90, 0xF0, 0x10, 0xF0, // 9
-            0xF0, 0x90, 0xF0, 0x90, 0x90, // A
-            0xE0, 0x90, 0xE0, 0x90, 0xE0, // B
-            0xF0, 0x80, 0x80, 0x80, 0xF0, // C
-            0xE0, 0x90, 0x90, 0x90, 0xE0, // D
-            0xF0, 0x80, 0xF0, 0x80, 0xF0, // E
-            0xF0, 0x80, 0xF0, 0x80, 0x80  // F
-        };
+        void saveCpu(CpuState & cpu) const;
+        void loadCpu(const CpuState & cpu);
 
-        void timer_loop();
     public:
-        void loadProgram(const unsigned char * program, int size);
-        bool draw_flag;
-
-        chip8(SDL_Window * screen);
-
-        void initialize();
-
-        void run();
-        void emulateCycle();
-
-        void updateScreen();
-
+        /**
+         * What the machine counted about its run rather than its state: executed instructions, the write
+         * tracker statistics and, with CHIP8_PROFILE, the profiler. Snapshots don't include them.
+         */
+        struct Counters {
+            uint64_t instructions;
+            WriteTracker::Statistics writes;
+#ifdef CHIP8_PROFILE
+            Profiler::Counters profile;
+#endif
+        };
 
-    unsigned char memory[4096] = {};
+        /**
+         * Capture the counters, e.g. before running frames that are thrown away again
+         * @param counters Destination
+         */
+        void saveCounters(Counters & counters) const;
+
+        /**
+         * Replace the counters by ones captured with saveCounters()
+         */
+        void loadCounters(const Counters & counters);
+
+        /**
+         * Capture the complete machine state
+         * @param snapshot Destination
+         */
+        void snapshot(Snapshot & snapshot) const;
+        Snapshot snapshot() const;
+
+        /**
+         * Replace the complete machine state. Only memory pages that differ are copied and lose their
+         * code marks.
+         * @param snapshot State captured by snapshot()
+         */
+        void restore(const Snapshot & snapshot);
+
+        /**
+         * Capture the machine state into a paged snapshot.
+         * Pages that were not written since the last paged snapshot or restore are shared with it.
+         * @param snapshot Destination
+         * @param store Store for the pages, must outlive this machine and the snapshot
+         */
+        void snapshot(PagedSnapshot & snapshot, PageStore & store);
+
+        /**
+         * Replace the machine state by a paged snapshot, only copying the pages that differ.
+         * Restoring a snapshot into another instance clones it, the instances share all unchanged pages.
+         * @param snapshot State captured by snapshot()
+         */
+        void restore(const PagedSnapshot & snapshot);
+
+        /**
+         * Drop the pages of the last paged snapshot taken or restored, so their store can be destroyed
+         * before this machine
+         */
+        void releasePages();
 };
 
 
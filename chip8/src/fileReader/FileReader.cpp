@@ -10,14 +10,13 @@ void FileReader::readFileIntoBuffer(std::ifstream &inFile, unsigned char (&buffe
     // clear memory
     std::memset(buffer, 0, MEMORY_SIZE);
 
-    unsigned char ch;
+    char ch;
     unsigned int i = 0;
 
-    while (inFile.good()) {
-        // get next char from file
-        ch = inFile.get();
+    // get next char from file, anything that doesn't fit in memory is dropped
+    while (i < MEMORY_SIZE && inFile.get(ch)) {
         // load new char into buffer
-        buffer[i] = ch;
+        buffer[i] = (unsigned char) ch;
         i++;
     }
 }
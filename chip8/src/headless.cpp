@@ -0,0 +1,251 @@
+//
+// Created by david on 18-10-26.
+//
+
+#include "includes/globals.h"
+
+#include "fileReader/FileReader.h"
+#include <chrono>
+#include <csignal>
+#include <string>
+#include "chip8.h"
+#include "includes/hash.h"
+#include "Replay/Recorder.h"
+#include "Replay/ReplayFile.h"
+#include "Disassembler/Disassembler.h"
+#include "Trace/Trace.h"
+
+/**
+ * Print how far a headless run got and the state it ended in
+ */
+static void summarize(const chip8 & chip8, const char * what, std::chrono::steady_clock::duration elapsed) {
+    std::cout << what << " up to " << chip8.cycleCount() << " cycles ("
+              << chip8.cycleCount() / (chip8.cyclesPerFrame() * FRAMES_PER_SECOND) << " s of play) in "
+              << std::chrono::duration<double>(elapsed).count() << " s, state hash "
+              << std::hex << chip8.snapshot().hash() << std::dec << std::endl;
+    if (chip8.fault() != chip8::FAULT_NONE) {
+        std::cout << "Program crashed with fault " << (unsigned int) chip8.fault() << " at pc "
+                  << std::hex << chip8.programCounter() << std::dec << std::endl;
+    }
+}
+
+/**
+ * Run a recording as fast as possible.
+ * Replay files are self-contained and can start at any point, plain input logs replay the loaded program
+ * from the start.
+ * @param chip8 Machine with the program the recording was made with loaded
+ * @param program Program the recording was made with
+ * @param path Path of the replay file or input log
+ * @param seekSeconds Point in the recording to start at
+ * @param quirksGiven Whether the quirk profile was picked on the command line, a replay file recorded with
+ *                    another one is rejected. Otherwise the replay file's profile is used.
+ * @param timingGiven The same for the timing model
+ * @return Exit code
+ */
+static int runReplay(chip8 & chip8, const unsigned char * program, const char * path, uint64_t seekSeconds,
+                     bool quirksGiven, bool timingGiven) {
+    auto start = std::chrono::steady_clock::now();
+    ReplayReader reader(path);
+    if (reader.good()) {
+        if (quirksGiven && reader.quirks() != chip8.quirks()) {
+            std::cerr << path << " was recorded with the " << quirksName(reader.quirks())
+                      << " quirk profile, not " << quirksName(chip8.quirks()) << std::endl;
+            return 1;
+        }
+        if (timingGiven && reader.timing() != chip8.timing()) {
+            std::cerr << path << " was recorded with the " << timingName(reader.timing())
+                      << " timing model, not " << timingName(chip8.timing()) << std::endl;
+            return 1;
+        }
+        // Seek positions are in cycles of the recorded timing model
+        chip8.setQuirks(reader.quirks());
+        chip8.setTiming(reader.timing());
+        if (!reader.seek(chip8, seekSeconds * chip8.cyclesPerFrame() * FRAMES_PER_SECOND)) {
+            std::cerr << "Could not seek in replay " << path << std::endl;
+            return 1;
+        }
+        reader.runToEnd(chip8);
+    } else {
+        std::ifstream in(path, std::ios::in | std::ios::binary);
+        InputLog log;
+        if (!InputLog::read(in, log)) {
+            std::cerr << "Could not read replay " << path << std::endl;
+            return 1;
+        }
+        if (log.rom_hash != fnv1a(program, MEMORY_SIZE)) {
+            std::cerr << "Warning: " << path << " was recorded with a different program" << std::endl;
+        }
+
+        Replayer replayer(log);
+        replayer.start(chip8);
+        replayer.runToEnd(chip8);
+    }
+    summarize(chip8, "Replayed", std::chrono::steady_clock::now() - start);
+    return 0;
+}
+
+/**
+ * Run a program for a number of seconds and record the run into a replay file
+ * @param chip8 Machine with the program loaded
+ * @param program Program to record
+ * @param path Replay file to create
+ * @param seconds Seconds of play to record
+ * @return Exit code
+ */
+static int record(chip8 & chip8, const unsigned char * program, const char * path, uint64_t seconds) {
+    auto start = std::chrono::steady_clock::now();
+    uint64_t romHash = fnv1a(program, MEMORY_SIZE);
+    ReplayWriter writer(path, 0, romHash, chip8.quirks(), chip8.timing(),
+                        chip8.cyclesPerFrame() * FRAMES_PER_SECOND);
+    if (!writer.good()) {
+        std::cerr << "Could not create replay " << path << std::endl;
+        return 1;
+    }
+
+    Recorder recorder(chip8, 0, romHash, &writer);
+    uint64_t end = seconds * chip8.cyclesPerFrame() * FRAMES_PER_SECOND;
+    while (chip8.cycleCount() < end) {
+        chip8.runFrame();
+        recorder.frame();
+    }
+    recorder.finish();
+    if (!writer.good()) {
+        std::cerr << "Could not write replay " << path << std::endl;
+        return 1;
+    }
+    summarize(chip8, "Recorded", std::chrono::steady_clock::now() - start);
+    return 0;
+}
+
+/**
+ * Write the disassembly of a program, annotated with a recorded profile if there is one
+ * @param program Program to disassemble
+ * @param profilePath Profile written by --profile, may be null
+ * @return Exit code
+ */
+static int disassemble(const unsigned char * program, const char * profilePath) {
+    Memory memory;
+    memory.load(PROGRAM_START, program, MEMORY_SIZE);
+    Disassembler disassembler(memory);
+
+    if (!profilePath) {
+        disassembler.disassemble(std::cout);
+        return 0;
+    }
+
+    std::ifstream in(profilePath);
+    static uint64_t pcs[RAM_SIZE];
+    if (!Disassembler::readHistogram(in, pcs)) {
+        std::cerr << "Could not read a pc histogram from " << profilePath << std::endl;
+        return 1;
+    }
+    disassembler.annotate(std::cout, pcs);
+    return 0;
+}
+
+/**
+ * chip8-headless [--seconds n [--record file] | --replay file [--seek s]] [--disassemble | --annotate profile]
+ *                [--quirks profile] [--timing model] [--profile file] [--trace file] rom
+ * Runs a program without a window or a clock, as fast as possible
+ */
+int main(int argc, char **argv) {
+    unsigned char buffer[MEMORY_SIZE];
+    const char * romPath = "../pong.rom";
+    const char * replayPath = nullptr;
+    const char * recordPath = nullptr;
+    uint64_t seekSeconds = 0;
+    uint64_t seconds = 60;
+    QuirkProfile quirks = QUIRKS_MODERN;
+    bool quirksGiven = false;
+    bool timingGiven = false;
+    TimingMode timing = TIMING_FIXED;
+    const char * profilePath = nullptr;
+    const char * tracePath = nullptr;
+    const char * annotatePath = nullptr;
+    bool disassembleOnly = false;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string argument = argv[i];
+        if (argument == "--replay" && i + 1 < argc) {
+            replayPath = argv[++i];
+        } else if (argument == "--record" && i + 1 < argc) {
+            recordPath = argv[++i];
+        } else if (argument == "--seek" && i + 1 < argc) {
+            seekSeconds = std::stoull(argv[++i]);
+        } else if (argument == "--seconds" && i + 1 < argc) {
+            seconds = std::stoull(argv[++i]);
+        } else if (argument == "--disassemble") {
+            disassembleOnly = true;
+        } else if (argument == "--annotate" && i + 1 < argc) {
+            disassembleOnly = true;
+            annotatePath = argv[++i];
+        } else if (argument == "--quirks" && i + 1 < argc) {
+            if (!parseQuirks(argv[++i], quirks)) {
+                std::cerr << "Unknown quirk profile " << argv[i] << ", use modern, vip, schip or xochip" << std::endl;
+                return 1;
+            }
+            quirksGiven = true;
+        } else if (argument == "--timing" && i + 1 < argc) {
+            if (!parseTiming(argv[++i], timing)) {
+                std::cerr << "Unknown timing model " << argv[i] << ", use fixed or vip" << std::endl;
+                return 1;
+            }
+            timingGiven = true;
+        } else if (argument == "--trace" && i + 1 < argc) {
+            tracePath = argv[++i];
+        } else if (argument == "--profile" && i + 1 < argc) {
+            profilePath = argv[++i];
+        } else {
+            romPath = argv[i];
+        }
+    }
+
+    std::ifstream rom = std::ifstream(romPath, std::ios::in | std::ios::binary);
+
+    FileReader::readFileIntoBuffer(rom, buffer);
+
+    if (disassembleOnly) {
+        return disassemble(buffer, annotatePath);
+    }
+
+#ifndef CHIP8_PROFILE
+    if (profilePath) {
+        std::cerr << "Built without CHIP8_PROFILE, --profile is ignored" << std::endl;
+    }
+#endif
+    if (tracePath) {
+        trace::setOutput(tracePath);
+        trace::start();
+    }
+
+    chip8 chip8;
+    chip8.initialize();
+    chip8.loadProgram(buffer, MEMORY_SIZE);
+    chip8.setQuirks(quirks);
+    chip8.setTiming(timing);
+
+    int result = 0;
+    if (replayPath) {
+        result = runReplay(chip8, buffer, replayPath, seekSeconds, quirksGiven, timingGiven);
+    } else if (recordPath) {
+        result = record(chip8, buffer, recordPath, seconds);
+    } else {
+        auto start = std::chrono::steady_clock::now();
+        chip8.runUntil(seconds * chip8.cyclesPerFrame() * FRAMES_PER_SECOND);
+        summarize(chip8, "Ran", std::chrono::steady_clock::now() - start);
+    }
+    chip8.writeTracker().report(std::cout, romPath);
+
+#ifdef CHIP8_PROFILE
+    if (profilePath) {
+        chip8.profiler().setOutput(profilePath);
+        if (!chip8.profiler().dump()) {
+            std::cerr << "Could not write profile to " << profilePath << std::endl;
+        }
+    }
+#endif
+    if (tracePath && !trace::dump()) {
+        std::cerr << "Could not write trace to " << tracePath << std::endl;
+    }
+    return result;
+}
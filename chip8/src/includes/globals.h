@@ -12,4 +12,24 @@
  */
 const int MEMORY_SIZE = 1792 * 2;
 
+/**
+ * The full address space is 4096 bytes, the first 512 bytes are reserved for the interpreter
+ */
+const int RAM_SIZE = 4096;
+const int PROGRAM_START = 0x200;
+
+/**
+ * The display is 64 by 32 monochrome pixels
+ */
+const int SCREEN_WIDTH = 64;
+const int SCREEN_HEIGHT = 32;
+
+/**
+ * The delay and sound timers count down at 60 Hz, one frame.
+ * Instructions run at a fixed rate of CYCLES_PER_FRAME per frame, unless a machine uses another
+ * timing model (see Timing.h).
+ */
+const int FRAMES_PER_SECOND = 60;
+const int CYCLES_PER_FRAME = 10;
+
 #endif //CHIP8_GLOBALS_H
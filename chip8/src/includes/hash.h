@@ -0,0 +1,27 @@
+//
+// Created by david on 18-10-26.
+//
+
+#ifndef CHIP8_HASH_H
+#define CHIP8_HASH_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * 64-bit FNV-1a hash, used to compare ROMs and machine states
+ * @param data Bytes to hash
+ * @param size Number of bytes
+ * @return Hash
+ */
+inline uint64_t fnv1a(const void * data, size_t size) {
+    const unsigned char * bytes = static_cast<const unsigned char *>(data);
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+#endif //CHIP8_HASH_H
@@ -1,37 +1,167 @@
 #include "includes/globals.h"
 
 #include "fileReader/FileReader.h"
-#include "dumpBuffer.cpp"
 #include <SDL.h>
+#include <csignal>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
 #include "chip8.h"
+#include "includes/hash.h"
+#include "Replay/Recorder.h"
+#include "Replay/ReplayFile.h"
+#include "Frontend/SdlFrontend.h"
+#include "Trace/Trace.h"
 
+/**
+ * Window pixels per CHIP-8 pixel
+ */
+static const int WINDOW_SCALE = 10;
+
+/**
+ * chip8-sdl [--run-ahead frames] [--stats-file file] [--stats-socket path] [--stats-overlay]
+ *           [--quirks profile] [--timing model] [--record file] [--profile file] [--trace file] rom
+ * Plays a program in real time, chip8-headless runs replays and disassembles
+ */
 int main(int argc, char **argv) {
     unsigned char buffer[MEMORY_SIZE];
+    const char * romPath = "../pong.rom";
+    unsigned int runAheadFrames = 0;
+    QuirkProfile quirks = QUIRKS_MODERN;
+    TimingMode timing = TIMING_FIXED;
+    const char * profilePath = nullptr;
+    const char * tracePath = nullptr;
+    const char * recordPath = nullptr;
+    const char * statsFile = nullptr;
+    const char * statsSocket = nullptr;
+    bool statsOverlay = false;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string argument = argv[i];
+        if (argument == "--run-ahead" && i + 1 < argc) {
+            runAheadFrames = (unsigned int) std::stoul(argv[++i]);
+        } else if (argument == "--stats-file" && i + 1 < argc) {
+            statsFile = argv[++i];
+        } else if (argument == "--stats-socket" && i + 1 < argc) {
+            statsSocket = argv[++i];
+        } else if (argument == "--stats-overlay") {
+            statsOverlay = true;
+        } else if (argument == "--quirks" && i + 1 < argc) {
+            if (!parseQuirks(argv[++i], quirks)) {
+                std::cerr << "Unknown quirk profile " << argv[i] << ", use modern, vip, schip or xochip" << std::endl;
+                return 1;
+            }
+        } else if (argument == "--timing" && i + 1 < argc) {
+            if (!parseTiming(argv[++i], timing)) {
+                std::cerr << "Unknown timing model " << argv[i] << ", use fixed or vip" << std::endl;
+                return 1;
+            }
+        } else if (argument == "--record" && i + 1 < argc) {
+            recordPath = argv[++i];
+        } else if (argument == "--trace" && i + 1 < argc) {
+            tracePath = argv[++i];
+        } else if (argument == "--profile" && i + 1 < argc) {
+            profilePath = argv[++i];
+        } else {
+            romPath = argv[i];
+        }
+    }
 
-    std::ifstream rom = std::ifstream("../pong.rom", std::ios::in | std::ios::binary);
+    std::ifstream rom = std::ifstream(romPath, std::ios::in | std::ios::binary);
 
     FileReader::readFileIntoBuffer(rom, buffer);
 
-    SDL_Window * screen = nullptr;
+#ifndef CHIP8_PROFILE
+    if (profilePath) {
+        std::cerr << "Built without CHIP8_PROFILE, --profile is ignored" << std::endl;
+    }
+#endif
+    if (tracePath) {
+        trace::setOutput(tracePath);
+        trace::start();
+    }
 
-    SDL_Init(SDL_INIT_VIDEO);              // Initialize SDL2
+    // kill -USR1 writes the profile and the trace of a running session
+    std::signal(SIGUSR1, [](int) {
+#ifdef CHIP8_PROFILE
+        Profiler::requestDump();
+#endif
+        trace::requestDump();
+    });
 
-    //TODO: implement front-end
-    // Create an application window with the following settings:
-//    screen = SDL_CreateWindow(
-//            "An SDL2 window",                  // window title
-//            SDL_WINDOWPOS_UNDEFINED,           // initial x position
-//            SDL_WINDOWPOS_UNDEFINED,           // initial y position
-//            64,                               // width, in pixels
-//            32,                               // height, in pixels
-//            SDL_WINDOW_OPENGL                  // flags - see below
-//    );
+    if (SDL_Init(SDL_INIT_VIDEO) != 0) {
+        std::cerr << "Could not initialize SDL: " << SDL_GetError() << std::endl;
+        return 1;
+    }
+    std::atexit(SDL_Quit);
 
+    // Key events only arrive with a window that has the focus. Declared before the frontend, so its
+    // renderer is destroyed first.
+    std::unique_ptr<SDL_Window, void (*)(SDL_Window *)> screen(
+            SDL_CreateWindow("chip8", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED,
+                             SCREEN_WIDTH * WINDOW_SCALE, SCREEN_HEIGHT * WINDOW_SCALE,
+                             SDL_WINDOW_SHOWN | SDL_WINDOW_RESIZABLE),
+            SDL_DestroyWindow);
+    if (!screen) {
+        std::cerr << "Could not create a window: " << SDL_GetError() << std::endl;
+        return 1;
+    }
 
-    chip8 chip8(screen);
+    chip8 chip8;
     chip8.initialize();
     chip8.loadProgram(buffer, MEMORY_SIZE);
-    chip8.run();
+    chip8.setQuirks(quirks);
+    chip8.setTiming(timing);
+#ifdef CHIP8_PROFILE
+    if (profilePath) {
+        chip8.profiler().setOutput(profilePath);
+    }
+#endif
+
+    SdlFrontend frontend(chip8, screen.get());
+    frontend.setRunAhead(runAheadFrames);
+    frontend.setStatsOverlay(statsOverlay);
+    if (statsFile) {
+        frontend.statsExporter().setFile(statsFile);
+    }
+    if (statsSocket && !frontend.statsExporter().listen(statsSocket)) {
+        std::cerr << "Could not listen on " << statsSocket << std::endl;
+    }
+
+    // A replay file for chip8-headless --replay, keyframed once per emulated second
+    std::unique_ptr<ReplayWriter> writer;
+    std::unique_ptr<Recorder> recorder;
+    if (recordPath) {
+        uint64_t romHash = fnv1a(buffer, MEMORY_SIZE);
+        writer.reset(new ReplayWriter(recordPath, 0, romHash, chip8.quirks(), chip8.timing(),
+                                      chip8.cyclesPerFrame() * FRAMES_PER_SECOND));
+        if (!writer->good()) {
+            std::cerr << "Could not create replay " << recordPath << std::endl;
+            return 1;
+        }
+        recorder.reset(new Recorder(chip8, 0, romHash, writer.get()));
+        frontend.setRecorder(recorder.get());
+    }
+
+    frontend.run();
+    if (recorder) {
+        recorder->finish();
+        if (!writer->good()) {
+            std::cerr << "Could not write replay " << recordPath << std::endl;
+        }
+    }
+#ifdef CHIP8_PROFILE
+    if (!chip8.profiler().dump()) {
+        std::cerr << "Could not write profile to " << profilePath << std::endl;
+    }
+#endif
+    if (!trace::dump()) {
+        std::cerr << "Could not write trace to " << tracePath << std::endl;
+    }
+
+    chip8.writeTracker().report(std::cout, romPath);
 
     return 0;
 }
\ No newline at end of file
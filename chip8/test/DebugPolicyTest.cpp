@@ -0,0 +1,90 @@
+//
+// Created by david on 18-10-26.
+//
+
+#include "Test.h"
+#include "../src/chip8.h"
+
+static void breakpoints() {
+    chip8 machine;
+    test::load(machine, test::counter());
+    DebugPolicy debug;
+    debug.setBreakpoint(0x20A);
+
+    CHECK(!machine.runUntil(1000, debug));
+    CHECK_EQUAL(debug.stopReason(), DebugPolicy::STOP_BREAKPOINT);
+    CHECK_EQUAL(debug.stopAddress(), 0x20A);
+    CHECK_EQUAL(machine.programCounter(), 0x20A);
+    CHECK_EQUAL(machine.cycleCount(), 5u);
+
+    // Continuing executes the instruction at the breakpoint, the next stop is one loop later
+    CHECK(!machine.runUntil(1000, debug));
+    CHECK_EQUAL(machine.cycleCount(), 10u);
+
+    debug.clear();
+    CHECK(machine.runUntil(1000, debug));
+    CHECK_EQUAL(machine.cycleCount(), 1000u);
+}
+
+static void watchpoints() {
+    chip8 machine;
+    test::load(machine, test::counter());
+    DebugPolicy debug;
+    debug.setWatchpoint(0x302);
+
+    // Stops after the BCD store
+    CHECK(!machine.runUntil(1000, debug));
+    CHECK_EQUAL(debug.stopReason(), DebugPolicy::STOP_WATCHPOINT);
+    CHECK_EQUAL(debug.stopAddress(), 0x302);
+    CHECK_EQUAL(machine.programCounter(), 0x20A);
+    CHECK_EQUAL(machine.memory.read(0x302), 1);
+}
+
+static void registers() {
+    chip8 machine;
+    test::load(machine, test::counter());
+    DebugPolicy debug;
+    unsigned int changes = 0;
+    debug.setRegisterHook([&changes](unsigned int reg, uint16_t before, uint16_t after) {
+        if (reg == 0) {
+            CHECK_EQUAL(after, (uint16_t) ((before + 1) & 0xFF));
+            ++changes;
+        }
+    });
+    debug.watchRegister(2);
+
+    CHECK(!machine.runUntil(1000, debug));
+    CHECK_EQUAL(debug.stopReason(), DebugPolicy::STOP_REGISTER);
+    CHECK_EQUAL(debug.stopAddress(), 2);
+    CHECK_EQUAL(machine.programCounter(), 0x20E);
+    CHECK_EQUAL(changes, 1u);
+
+    // Cleared, neither the hook nor the watch is left
+    debug.clear();
+    CHECK_EQUAL(debug.stopReason(), DebugPolicy::STOP_NONE);
+    CHECK(machine.runUntil(1000, debug));
+    CHECK_EQUAL(machine.cycleCount(), 1000u);
+    CHECK_EQUAL(changes, 1u);
+}
+
+/**
+ * Hooks don't change what the program does
+ */
+static void sameRun() {
+    chip8 plain;
+    chip8 debugged;
+    test::load(plain, test::counter());
+    test::load(debugged, test::counter());
+    DebugPolicy debug;
+    debug.setRegisterHook([](unsigned int, uint16_t, uint16_t) {});
+    plain.runUntil(5000);
+    CHECK(debugged.runUntil(5000, debug));
+    CHECK_EQUAL(debugged.snapshot().hash(), plain.snapshot().hash());
+}
+
+void testDebugPolicy() {
+    breakpoints();
+    watchpoints();
+    registers();
+    sameRun();
+}
@@ -0,0 +1,75 @@
+//
+// Created by david on 18-10-26.
+//
+
+#include <sstream>
+#include <vector>
+#include "Test.h"
+#include "../src/Disassembler/Disassembler.h"
+
+static void instructions() {
+    CHECK(Disassembler::instruction(0x00E0) == "CLS");
+    CHECK(Disassembler::instruction(0x1234) == "JP 0x234");
+    CHECK(Disassembler::instruction(0x3A12) == "SE VA, 0x12");
+    CHECK(Disassembler::instruction(0x8AB4) == "ADD VA, VB");
+    CHECK(Disassembler::instruction(0xB200) == "JP V0, 0x200");
+    CHECK(Disassembler::instruction(0xD013) == "DRW V0, V1, 3");
+    CHECK(Disassembler::instruction(0xF365) == "LD V3, [I]");
+    CHECK(Disassembler::instruction(0x5121) == "DW 0x5121");
+}
+
+/**
+ * Blocks end at jumps and where the execution count changes, hottest first
+ */
+static void blocks() {
+    const std::vector<unsigned char> & program = test::counter();
+    Memory memory;
+    memory.load(PROGRAM_START, program.data(), (unsigned int) program.size());
+    Disassembler disassembler(memory);
+
+    std::vector<uint64_t> pcs(RAM_SIZE);
+    for (unsigned short pc = 0x200; pc < 0x206; pc += 2) {
+        pcs[pc] = 1;
+    }
+    for (unsigned short pc = 0x206; pc < 0x210; pc += 2) {
+        pcs[pc] = 100;
+    }
+
+    std::vector<Disassembler::Block> found = disassembler.blocks(pcs.data());
+    CHECK_EQUAL(found.size(), 2u);
+    if (found.size() == 2) {
+        CHECK_EQUAL(found[0].start, 0x206);
+        CHECK_EQUAL(found[0].end, 0x20E);
+        CHECK_EQUAL(found[0].entries, 100u);
+        CHECK_EQUAL(found[0].executions, 500u);
+        CHECK_EQUAL(found[1].start, 0x200);
+        CHECK_EQUAL(found[1].end, 0x204);
+        CHECK_EQUAL(found[1].executions, 3u);
+    }
+}
+
+/**
+ * Histograms come from the profiler's CSV or JSON
+ */
+static void histograms() {
+    std::vector<uint64_t> pcs(RAM_SIZE);
+    std::istringstream csv("kind,key,count\ntotal,instructions,7\nopcode,CLS,1\npc,0x200,3\npc,0x20e,4\n");
+    CHECK(Disassembler::readHistogram(csv, pcs.data()));
+    CHECK_EQUAL(pcs[0x200], 3u);
+    CHECK_EQUAL(pcs[0x20E], 4u);
+
+    std::vector<uint64_t> json(RAM_SIZE);
+    std::istringstream profile("{\n  \"instructions\": 7,\n  \"opcodes\": {\n    \"CLS\": 1\n  },\n"
+                               "  \"pcs\": {\n    \"0x200\": 3,\n    \"0x20e\": 4\n  }\n}\n");
+    CHECK(Disassembler::readHistogram(profile, json.data()));
+    CHECK(json == pcs);
+
+    std::istringstream empty("kind,key,count\ntotal,instructions,0\n");
+    CHECK(!Disassembler::readHistogram(empty, pcs.data()));
+}
+
+void testDisassembler() {
+    instructions();
+    blocks();
+    histograms();
+}
@@ -0,0 +1,89 @@
+//
+// Created by david on 18-10-26.
+//
+
+#include <thread>
+#include "Test.h"
+#include "../src/KeyChannel/KeyChannel.h"
+
+/**
+ * Change number n of a sequence where every change flips a key, so none is dropped as a repeat
+ */
+static uint8_t changeKey(unsigned int n) { return (uint8_t) (n / 2 % 16); }
+static bool changePressed(unsigned int n) { return n % 2 == 0; }
+
+/**
+ * Events from a producer thread arrive complete and in order while the consumer drains concurrently
+ */
+static void twoThreads() {
+    const unsigned int CHANGES = 100000;
+    KeyChannel channel;
+    uint64_t full = 0;
+
+    std::thread producer([&channel, &full]() {
+        for (unsigned int change = 0; change < CHANGES; ++change) {
+            // The consumer is slower at times, retry until there is room
+            while (!channel.send(changeKey(change), changePressed(change))) {
+                ++full;
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    unsigned int next = 0;
+    unsigned int outOfOrder = 0;
+    while (next < CHANGES) {
+        channel.receive([&next, &outOfOrder](const KeyChannel::KeyEvent & event) {
+            if (event.key != changeKey(next) || event.pressed != changePressed(next)) {
+                ++outOfOrder;
+            }
+            ++next;
+        });
+    }
+    producer.join();
+
+    CHECK_EQUAL(outOfOrder, 0u);
+    CHECK_EQUAL(channel.received(), (uint64_t) CHANGES);
+    CHECK_EQUAL(channel.dropped(), full);
+    CHECK(channel.empty());
+    CHECK_EQUAL(channel.keys(), 0);
+}
+
+/**
+ * A full ring refuses changes without touching the queued ones or the key mask
+ */
+static void fullRing() {
+    KeyChannel channel;
+    for (unsigned int change = 0; change < KeyChannel::CAPACITY; ++change) {
+        CHECK(channel.send(changeKey(change), changePressed(change)));
+    }
+    uint16_t keys = channel.keys();
+    CHECK(!channel.send(0xF, (keys & 0x8000) == 0));
+    CHECK_EQUAL(channel.dropped(), 1u);
+    CHECK_EQUAL(channel.keys(), keys);
+
+    // Repeats are dropped before the ring is looked at, so they don't count as lost
+    CHECK(!channel.send(0x3, (keys & 0x0008) != 0));
+    CHECK_EQUAL(channel.dropped(), 1u);
+
+    unsigned int next = 0;
+    CHECK_EQUAL(channel.receive([&next](const KeyChannel::KeyEvent & event) {
+        CHECK_EQUAL(event.key, changeKey(next));
+        CHECK_EQUAL(event.pressed, changePressed(next));
+        ++next;
+    }), KeyChannel::CAPACITY);
+    CHECK(channel.empty());
+    CHECK(channel.send(0xF, true));
+    CHECK(!channel.empty());
+
+    // A repeat queues nothing, so the sender has no one to wake
+    CHECK(!channel.send(0xF, true));
+    CHECK_EQUAL(channel.receive([](const KeyChannel::KeyEvent &) {}), 1u);
+    CHECK(!channel.send(0xF, true));
+    CHECK(channel.empty());
+}
+
+void testKeyChannel() {
+    twoThreads();
+    fullRing();
+}
@@ -0,0 +1,85 @@
+//
+// Created by david on 18-10-26.
+//
+
+#include "Test.h"
+#include "../src/chip8.h"
+
+static const std::vector<unsigned char> WAIT_PROGRAM = {
+        0xF3, 0x0A, // 200: LD V3, K
+        0x73, 0x01, // 202: ADD V3, 1
+        0x12, 0x02, // 204: JP 0x202
+};
+
+/**
+ * Fx0A blocks the machine until a key press, which ends the wait and lands in the register
+ */
+static void pressEndsWait() {
+    chip8 machine;
+    test::load(machine, WAIT_PROGRAM);
+    machine.runUntil(100);
+    CHECK(machine.waitingForKey());
+    CHECK_EQUAL(machine.cycleCount(), 100u);
+    CHECK_EQUAL(machine.programCounter(), 0x202);
+
+    // Time passes, nothing runs
+    machine.runUntil(1000);
+    CHECK(machine.waitingForKey());
+    CHECK_EQUAL(machine.cycleCount(), 1000u);
+    CHECK_EQUAL(machine.instructionCount(), 1u);
+
+    // Releasing a key doesn't end the wait
+    machine.setKey(0x7, false);
+    CHECK(machine.waitingForKey());
+
+    machine.setKey(0x5, true);
+    CHECK(!machine.waitingForKey());
+    CHECK_EQUAL(machine.registerValue(3), 5);
+    machine.runUntil(1010);
+    CHECK_EQUAL(machine.instructionCount(), 11u);
+    CHECK_EQUAL(machine.registerValue(3), 10);
+}
+
+/**
+ * Under VIP timing a wait still ends the frame exactly on its boundary, so frames and timers don't drift
+ */
+static void vipWaitEndsOnBoundary() {
+    chip8 machine;
+    test::load(machine, WAIT_PROGRAM);
+    machine.setTiming(TIMING_VIP);
+    machine.runFrame();
+    CHECK(machine.waitingForKey());
+    CHECK_EQUAL(machine.cycleCount(), VipTiming::CYCLES_PER_FRAME);
+    machine.runFrame();
+    CHECK_EQUAL(machine.cycleCount(), 2 * VipTiming::CYCLES_PER_FRAME);
+}
+
+/**
+ * The vip display wait makes every sprite end a frame, on its boundary under both timing models
+ */
+static void displayWaitEndsOnBoundary() {
+    const std::vector<unsigned char> program = {
+            0xA0, 0x00, // 200: LD I, 0x000
+            0xD0, 0x15, // 202: DRW V0, V0, 5
+            0x12, 0x02, // 204: JP 0x202
+    };
+    for (TimingMode timing : {TIMING_FIXED, TIMING_VIP}) {
+        chip8 machine;
+        test::load(machine, program);
+        machine.setQuirks(QUIRKS_VIP);
+        machine.setTiming(timing);
+        for (uint64_t frame = 1; frame <= 5; ++frame) {
+            machine.runFrame();
+            CHECK_EQUAL(machine.cycleCount(), frame * machine.cyclesPerFrame());
+            CHECK_EQUAL(machine.programCounter(), 0x204);
+        }
+        // One sprite per frame
+        CHECK_EQUAL(machine.instructionCount(), 1u + 2 * 5 - 1);
+    }
+}
+
+void testKeyWait() {
+    pressEndsWait();
+    vipWaitEndsOnBoundary();
+    displayWaitEndsOnBoundary();
+}
@@ -0,0 +1,55 @@
+//
+// Created by david on 18-10-26.
+//
+
+#include "Test.h"
+#include "../src/Memory.h"
+
+/**
+ * The word view follows every store, also for the word that ends at the stored byte
+ */
+static void wordView() {
+    Memory memory;
+    memory.write(0x300, 0x12);
+    memory.write(0x301, 0x34);
+    memory.write(0x302, 0x56);
+    CHECK_EQUAL(memory.getOpcode(0x300), 0x1234);
+    CHECK_EQUAL(memory.getOpcode(0x301), 0x3456);
+    CHECK_EQUAL(memory.getOpcode(0x2FF), 0x0012);
+
+    // Wraps at the end of memory
+    memory.write(RAM_SIZE - 1, 0xAB);
+    memory.write(0, 0xCD);
+    CHECK_EQUAL(memory.getOpcode(RAM_SIZE - 1), 0xABCD);
+    CHECK_EQUAL(memory.getOpcode(RAM_SIZE), 0xCD00);
+    CHECK_EQUAL(memory.read(RAM_SIZE), 0xCD);
+}
+
+static void load() {
+    const unsigned char program[] = {0x60, 0x0A, 0x12, 0x00};
+    Memory memory;
+    memory.load(PROGRAM_START, program, sizeof(program));
+    CHECK_EQUAL(memory.getOpcode(PROGRAM_START), 0x600A);
+    CHECK_EQUAL(memory.getOpcode(PROGRAM_START + 1), 0x0A12);
+    CHECK_EQUAL(memory.getOpcode(PROGRAM_START + 2), 0x1200);
+    CHECK_EQUAL(memory.getOpcode(PROGRAM_START - 1), 0x0060);
+
+    // Dropped beyond the end of memory
+    memory.load(RAM_SIZE - 2, program, sizeof(program));
+    CHECK_EQUAL(memory.getOpcode(RAM_SIZE - 2), 0x600A);
+    CHECK_EQUAL(memory.read(0), 0);
+}
+
+static void dirtyPages() {
+    Memory memory;
+    memory.dirty_pages = 0;
+    memory.write(0x000, 1);
+    memory.write(0x7C1, 1);
+    CHECK_EQUAL(memory.dirty_pages, (uint64_t(1) << 0) | (uint64_t(1) << (0x7C1 >> Memory::PAGE_SHIFT)));
+}
+
+void testMemory() {
+    wordView();
+    load();
+    dirtyPages();
+}
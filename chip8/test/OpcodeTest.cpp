@@ -0,0 +1,122 @@
+//
+// Created by david on 18-10-26.
+//
+
+#include "Test.h"
+#include "../src/chip8.h"
+
+static void fontDigits() {
+    chip8 machine;
+    for (unsigned char digit = 0; digit < 16; ++digit) {
+        // 200: LD V3, digit, 202: LD F, V3
+        test::load(machine, {0x63, digit, 0xF3, 0x29});
+        machine.runUntil(2);
+        CHECK_EQUAL(machine.indexRegister(), digit * 5);
+        CHECK_EQUAL(machine.programCounter(), 0x204);
+        CHECK_EQUAL(machine.fault(), chip8::FAULT_NONE);
+    }
+}
+
+static void drawDigit() {
+    chip8 machine;
+    test::load(machine, {
+            0x60, 0x08, // 200: LD V0, 8
+            0xF0, 0x29, // 202: LD F, V0
+            0x61, 0x02, // 204: LD V1, 2
+            0x62, 0x03, // 206: LD V2, 3
+            0xD1, 0x25, // 208: DRW V1, V2, 5
+    });
+    machine.runUntil(5);
+    CHECK_EQUAL(machine.fault(), chip8::FAULT_NONE);
+
+    // The rows of the 8 in the font
+    const unsigned char rows[5] = {0xF0, 0x90, 0xF0, 0x90, 0xF0};
+    const unsigned char * frame = machine.framebuffer();
+    for (unsigned int y = 0; y < 5; ++y) {
+        for (unsigned int x = 0; x < 8; ++x) {
+            CHECK_EQUAL(frame[(3 + y) * SCREEN_WIDTH + 2 + x], (rows[y] >> (7 - x)) & 1);
+        }
+    }
+}
+
+/**
+ * Load and run LD Vx, x, LD V4, y and the arithmetic instruction 8x4op
+ */
+static void arithmetic(chip8 & machine, unsigned char x, unsigned char y, unsigned char reg, unsigned char op) {
+    test::load(machine, {(unsigned char) (0x60 | reg), x, 0x64, y, (unsigned char) (0x80 | reg), (unsigned char) (0x40 | op)});
+    machine.runUntil(3);
+    CHECK_EQUAL(machine.fault(), chip8::FAULT_NONE);
+}
+
+static void addCarry() {
+    chip8 machine;
+    // 8xy4 - ADD Vx, Vy
+    arithmetic(machine, 0x12, 0x34, 3, 0x4);
+    CHECK_EQUAL(machine.registerValue(3), 0x46);
+    CHECK_EQUAL(machine.registerValue(0xF), 0);
+
+    arithmetic(machine, 0xF0, 0x20, 3, 0x4);
+    CHECK_EQUAL(machine.registerValue(3), 0x10);
+    CHECK_EQUAL(machine.registerValue(0xF), 1);
+
+    arithmetic(machine, 0x80, 0x7F, 3, 0x4);
+    CHECK_EQUAL(machine.registerValue(3), 0xFF);
+    CHECK_EQUAL(machine.registerValue(0xF), 0);
+
+    // With VF as Vx the flag replaces the sum
+    arithmetic(machine, 0xF0, 0x20, 0xF, 0x4);
+    CHECK_EQUAL(machine.registerValue(0xF), 1);
+    arithmetic(machine, 0x01, 0x02, 0xF, 0x4);
+    CHECK_EQUAL(machine.registerValue(0xF), 0);
+}
+
+static void subBorrow() {
+    chip8 machine;
+    // 8xy5 - SUB Vx, Vy, VF is NOT borrow
+    arithmetic(machine, 0x30, 0x10, 3, 0x5);
+    CHECK_EQUAL(machine.registerValue(3), 0x20);
+    CHECK_EQUAL(machine.registerValue(0xF), 1);
+
+    arithmetic(machine, 0x10, 0x30, 3, 0x5);
+    CHECK_EQUAL(machine.registerValue(3), 0xE0);
+    CHECK_EQUAL(machine.registerValue(0xF), 0);
+
+    // Equal operands don't borrow
+    arithmetic(machine, 0x42, 0x42, 3, 0x5);
+    CHECK_EQUAL(machine.registerValue(3), 0x00);
+    CHECK_EQUAL(machine.registerValue(0xF), 1);
+
+    arithmetic(machine, 0x30, 0x10, 0xF, 0x5);
+    CHECK_EQUAL(machine.registerValue(0xF), 1);
+    arithmetic(machine, 0x10, 0x30, 0xF, 0x5);
+    CHECK_EQUAL(machine.registerValue(0xF), 0);
+}
+
+static void subnBorrow() {
+    chip8 machine;
+    // 8xy7 - SUBN Vx, Vy, Vx = Vy - Vx, VF is NOT borrow
+    arithmetic(machine, 0x10, 0x30, 3, 0x7);
+    CHECK_EQUAL(machine.registerValue(3), 0x20);
+    CHECK_EQUAL(machine.registerValue(0xF), 1);
+
+    arithmetic(machine, 0x30, 0x10, 3, 0x7);
+    CHECK_EQUAL(machine.registerValue(3), 0xE0);
+    CHECK_EQUAL(machine.registerValue(0xF), 0);
+
+    arithmetic(machine, 0x42, 0x42, 3, 0x7);
+    CHECK_EQUAL(machine.registerValue(3), 0x00);
+    CHECK_EQUAL(machine.registerValue(0xF), 1);
+
+    arithmetic(machine, 0x10, 0x30, 0xF, 0x7);
+    CHECK_EQUAL(machine.registerValue(0xF), 1);
+    arithmetic(machine, 0x30, 0x10, 0xF, 0x7);
+    CHECK_EQUAL(machine.registerValue(0xF), 0);
+}
+
+void testOpcodes() {
+    fontDigits();
+    drawDigit();
+    addCarry();
+    subBorrow();
+    subnBorrow();
+}
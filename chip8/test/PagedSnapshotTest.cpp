@@ -0,0 +1,85 @@
+//
+// Created by david on 18-10-26.
+//
+
+#include "Test.h"
+#include "../src/chip8.h"
+
+/**
+ * Consecutive snapshots only add the pages written in between
+ */
+static void sharing() {
+    PageStore store;
+    chip8 machine;
+    test::load(machine, test::counter());
+
+    PagedSnapshot first;
+    machine.snapshot(first, store);
+    size_t pages = store.pageCount();
+    CHECK_EQUAL(pages, (size_t) (PagedSnapshot::MEMORY_PAGES + PagedSnapshot::GFX_PAGES));
+
+    // One frame stores a BCD number and draws three rows
+    machine.runFrame();
+    PagedSnapshot second;
+    machine.snapshot(second, store);
+    CHECK(store.pageCount() > pages);
+    CHECK(store.pageCount() <= pages + 4);
+
+    // Nothing written, nothing added
+    size_t shared = store.pageCount();
+    PagedSnapshot third;
+    machine.snapshot(third, store);
+    CHECK_EQUAL(store.pageCount(), shared);
+    machine.releasePages();
+}
+
+/**
+ * Restoring a paged snapshot gives the same state as a full snapshot, in the same or another instance
+ */
+static void restore() {
+    PageStore store;
+    chip8 machine;
+    test::load(machine, test::counter());
+    machine.runUntil(500);
+    Snapshot full = machine.snapshot();
+    PagedSnapshot paged;
+    machine.snapshot(paged, store);
+
+    machine.runUntil(3000);
+    machine.restore(paged);
+    CHECK_EQUAL(machine.snapshot().hash(), full.hash());
+
+    chip8 clone;
+    clone.restore(paged);
+    CHECK_EQUAL(clone.snapshot().hash(), full.hash());
+
+    clone.runUntil(3000);
+    machine.runUntil(3000);
+    CHECK_EQUAL(clone.snapshot().hash(), machine.snapshot().hash());
+    clone.releasePages();
+    machine.releasePages();
+}
+
+/**
+ * Pages go back to the store when the last snapshot sharing them is gone
+ */
+static void release() {
+    PageStore store;
+    chip8 machine;
+    test::load(machine, test::counter());
+    {
+        PagedSnapshot snapshot;
+        for (int frame = 0; frame < 10; ++frame) {
+            machine.runFrame();
+            machine.snapshot(snapshot, store);
+        }
+    }
+    machine.releasePages();
+    CHECK_EQUAL(store.pageCount(), 0u);
+}
+
+void testPagedSnapshot() {
+    sharing();
+    restore();
+    release();
+}
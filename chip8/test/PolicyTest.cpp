@@ -0,0 +1,53 @@
+//
+// Created by david on 18-10-26.
+//
+
+#include <cstring>
+#include "Test.h"
+#include "../src/chip8.h"
+
+template<typename M>
+static void checkRegisters(const M & machine, const chip8 & reference) {
+    CHECK_EQUAL(machine.cycleCount(), reference.cycleCount());
+    CHECK_EQUAL(machine.programCounter(), reference.programCounter());
+    CHECK_EQUAL(machine.indexRegister(), reference.indexRegister());
+    for (unsigned int i = 0; i < 0xF; ++i) {
+        CHECK_EQUAL(machine.registerValue(i), reference.registerValue(i));
+    }
+}
+
+/**
+ * Every display and memory policy runs a program to the same state as chip8
+ */
+static void samePrograms() {
+    chip8 reference;
+    test::load(reference, test::counter());
+    reference.runUntil(1000);
+
+    PackedMachine packed;
+    test::load(packed, test::counter());
+    packed.runUntil(1000);
+    checkRegisters(packed, reference);
+    CHECK_EQUAL(packed.registerValue(0xF), reference.registerValue(0xF));
+    CHECK(memcmp(packed.framebuffer(), reference.framebuffer(), SCREEN_WIDTH * SCREEN_HEIGHT) == 0);
+
+    TracingMachine tracing;
+    test::load(tracing, test::counter());
+    tracing.runUntil(1000);
+    checkRegisters(tracing, reference);
+    CHECK(memcmp(tracing.framebuffer(), reference.framebuffer(), SCREEN_WIDTH * SCREEN_HEIGHT) == 0);
+    // The loop starts at the fourth instruction and runs 200 times, each time storing the BCD at 0x300
+    CHECK_EQUAL(tracing.memory.fetches[0x206], 200u);
+    CHECK_EQUAL(tracing.memory.writes[0x300], 200u);
+
+    // Sprites never collide without a display, so only VF differs
+    HeadlessMachine headless;
+    test::load(headless, test::counter());
+    headless.runUntil(1000);
+    checkRegisters(headless, reference);
+    CHECK_EQUAL(headless.registerValue(0xF), 0);
+}
+
+void testPolicies() {
+    samePrograms();
+}
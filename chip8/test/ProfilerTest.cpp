@@ -0,0 +1,44 @@
+//
+// Created by david on 18-10-26.
+//
+
+#include "Test.h"
+#include "../src/chip8.h"
+
+static void classify() {
+    CHECK_EQUAL(Profiler::classify(0x00E0), Profiler::OP_CLS);
+    CHECK_EQUAL(Profiler::classify(0x00EE), Profiler::OP_RET);
+    CHECK_EQUAL(Profiler::classify(0x0123), Profiler::OP_SYS);
+    CHECK_EQUAL(Profiler::classify(0x00E1), Profiler::OP_UNKNOWN);
+    CHECK_EQUAL(Profiler::classify(0x00EF), Profiler::OP_UNKNOWN);
+    CHECK_EQUAL(Profiler::classify(0x00F0), Profiler::OP_SYS);
+    CHECK_EQUAL(Profiler::classify(0x8AB6), Profiler::OP_SHR);
+    CHECK_EQUAL(Profiler::classify(0x8AB8), Profiler::OP_UNKNOWN);
+    CHECK_EQUAL(Profiler::classify(0xE19E), Profiler::OP_SKP);
+    CHECK_EQUAL(Profiler::classify(0xF229), Profiler::OP_LD_F);
+    CHECK_EQUAL(Profiler::classify(0xF2FF), Profiler::OP_UNKNOWN);
+}
+
+/**
+ * Every executed instruction is counted once, by class and by address
+ */
+static void counters() {
+    chip8 machine;
+    test::load(machine, test::counter());
+    machine.profiler().reset();
+    machine.runUntil(1003);
+
+    const Profiler::Counters & counters = machine.profiler().statistics();
+    CHECK_EQUAL(counters.instructions, 1003u);
+    CHECK_EQUAL(counters.pcs[0x200], 1u);
+    CHECK_EQUAL(counters.pcs[0x206], 200u);
+    CHECK_EQUAL(counters.pcs[0x20E], 200u);
+    CHECK_EQUAL(counters.opcodes[Profiler::OP_DRW], 200u);
+    CHECK_EQUAL(counters.opcodes[Profiler::OP_LD_BYTE], 2u);
+    CHECK_EQUAL(counters.sprites, 200u);
+}
+
+void testProfiler() {
+    classify();
+    counters();
+}
@@ -0,0 +1,68 @@
+//
+// Created by david on 18-10-26.
+//
+
+#include "Test.h"
+#include "../src/chip8.h"
+#include "../src/Debugger/TimeTravelDebugger.h"
+
+/**
+ * 200: LD VF, 5, 202: LD V0, 1, 204: OR V0, V1, 206: LD I, 0x300, 208: LD [I], V1, 20A: JP 0x20A
+ */
+static const std::vector<unsigned char> PROGRAM = {
+        0x6F, 0x05, 0x60, 0x01, 0x80, 0x11, 0xA3, 0x00, 0xF1, 0x55, 0x12, 0x0A,
+};
+
+static void profiles() {
+    chip8 machine;
+    test::load(machine, PROGRAM);
+    machine.runUntil(10);
+    CHECK_EQUAL(machine.registerValue(0xF), 5);
+    CHECK_EQUAL(machine.indexRegister(), 0x300);
+
+    // The logic opcodes reset VF and Fx55 leaves I past the stored registers
+    test::load(machine, PROGRAM);
+    machine.setQuirks(QUIRKS_VIP);
+    machine.runUntil(10);
+    CHECK_EQUAL(machine.registerValue(0xF), 0);
+    CHECK_EQUAL(machine.indexRegister(), 0x302);
+}
+
+/**
+ * A snapshot restores the profile it was taken with
+ */
+static void snapshots() {
+    chip8 vip;
+    test::load(vip, PROGRAM);
+    vip.setQuirks(QUIRKS_VIP);
+    Snapshot snapshot = vip.snapshot();
+    CHECK_EQUAL(snapshot.cpu.quirks, QUIRKS_VIP);
+
+    chip8 machine;
+    machine.initialize();
+    machine.restore(snapshot);
+    CHECK_EQUAL(machine.quirks(), QUIRKS_VIP);
+}
+
+/**
+ * Reverse searches find the writes the profile's quirks add
+ */
+static void timeTravel() {
+    chip8 machine;
+    test::load(machine, PROGRAM);
+    machine.setQuirks(QUIRKS_VIP);
+    TimeTravelDebugger debugger(machine, 4);
+    debugger.run(20);
+
+    CHECK(debugger.reverseToRegisterWrite(TimeTravelDebugger::REGISTER_I));
+    CHECK_EQUAL(machine.programCounter(), 0x208);
+    CHECK(debugger.reverseToRegisterWrite(0xF));
+    CHECK_EQUAL(machine.programCounter(), 0x204);
+    CHECK_EQUAL(debugger.position(), 2u);
+}
+
+void testQuirks() {
+    profiles();
+    snapshots();
+    timeTravel();
+}
@@ -0,0 +1,122 @@
+//
+// Created by david on 18-10-26.
+//
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <vector>
+#include "Test.h"
+#include "../src/chip8.h"
+#include "../src/includes/hash.h"
+#include "../src/Replay/Recorder.h"
+#include "../src/Replay/ReplayFile.h"
+
+static const char * PATH = "replay_file_test.c8r";
+static const uint64_t KEYFRAME_INTERVAL = 1000;
+
+/**
+ * Record a run with a key event every 300 cycles into PATH
+ * @param hashes Snapshot hash at every 100 cycles
+ */
+static void recordFile(std::vector<uint64_t> & hashes) {
+    chip8 machine;
+    test::load(machine, test::counter());
+    uint64_t romHash = fnv1a(test::counter().data(), test::counter().size());
+    ReplayWriter writer(PATH, 99, romHash, machine.quirks(), machine.timing(), KEYFRAME_INTERVAL);
+    CHECK(writer.good());
+
+    Recorder recorder(machine, 99, romHash, &writer);
+    hashes.push_back(machine.snapshot().hash());
+    for (uint64_t cycle = 100; cycle <= 5000; cycle += 100) {
+        machine.runUntil(cycle);
+        recorder.frame();
+        if (cycle % 300 == 0) {
+            recorder.setKey((uint8_t) (cycle / 300 % 16), true);
+        }
+        hashes.push_back(machine.snapshot().hash());
+    }
+    recorder.finish();
+    CHECK(writer.good());
+}
+
+/**
+ * Seeking anywhere, forwards or backwards, gives the recorded state
+ */
+static void seek() {
+    std::vector<uint64_t> hashes;
+    recordFile(hashes);
+
+    ReplayReader reader(PATH);
+    CHECK(reader.good());
+    CHECK_EQUAL(reader.seed(), 99u);
+    CHECK_EQUAL(reader.endCycle(), 5000u);
+    CHECK(reader.keyframes().size() >= 5);
+
+    chip8 machine;
+    for (uint64_t cycle : {4700u, 0u, 2300u, 1000u, 3100u}) {
+        CHECK(reader.seek(machine, cycle));
+        CHECK_EQUAL(machine.cycleCount(), cycle);
+        CHECK_EQUAL(machine.snapshot().hash(), hashes[cycle / 100]);
+    }
+
+    // Play on from a seek
+    CHECK(reader.seek(machine, 1200));
+    reader.runToEnd(machine);
+    CHECK_EQUAL(machine.snapshot().hash(), hashes.back());
+    std::remove(PATH);
+}
+
+/**
+ * A file cut short has no footer and is rejected
+ */
+static void truncated() {
+    std::vector<uint64_t> hashes;
+    recordFile(hashes);
+    {
+        std::ifstream in(PATH, std::ios::in | std::ios::binary);
+        std::vector<char> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        in.close();
+        std::ofstream out(PATH, std::ios::out | std::ios::binary | std::ios::trunc);
+        out.write(bytes.data(), (std::streamsize) (bytes.size() - 10));
+    }
+    ReplayReader reader(PATH);
+    CHECK(!reader.good());
+    std::remove(PATH);
+}
+
+/**
+ * A replay plays back with the quirk profile and timing model it was recorded with
+ */
+static void configuration() {
+    {
+        chip8 machine;
+        test::load(machine, test::counter());
+        machine.setQuirks(QUIRKS_VIP);
+        machine.setTiming(TIMING_VIP);
+        ReplayWriter writer(PATH, 0, 0, machine.quirks(), machine.timing(), KEYFRAME_INTERVAL);
+        Recorder recorder(machine, 0, 0, &writer);
+        machine.runUntil(5000);
+        recorder.frame();
+        recorder.finish();
+    }
+
+    ReplayReader reader(PATH);
+    CHECK(reader.good());
+    CHECK_EQUAL(reader.quirks(), QUIRKS_VIP);
+    CHECK_EQUAL(reader.timing(), TIMING_VIP);
+
+    chip8 machine;
+    machine.initialize();
+    CHECK(reader.seek(machine, 4200));
+    CHECK_EQUAL(machine.quirks(), QUIRKS_VIP);
+    CHECK_EQUAL(machine.timing(), TIMING_VIP);
+    CHECK_EQUAL(machine.cyclesPerFrame(), VipTiming::CYCLES_PER_FRAME);
+    std::remove(PATH);
+}
+
+void testReplayFile() {
+    seek();
+    truncated();
+    configuration();
+}
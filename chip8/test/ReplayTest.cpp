@@ -0,0 +1,118 @@
+//
+// Created by david on 18-10-26.
+//
+
+#include <sstream>
+#include <vector>
+#include "Test.h"
+#include "../src/chip8.h"
+#include "../src/includes/hash.h"
+#include "../src/Replay/Recorder.h"
+
+/**
+ * Mixes random numbers with a count of the cycles key 0 was up
+ */
+static const std::vector<unsigned char> & keyProgram() {
+    static const std::vector<unsigned char> program = {
+            0xC0, 0xFF, // 200: RND V0, 0xFF
+            0xE3, 0x9E, // 202: SKP V3
+            0x72, 0x01, // 204: ADD V2, 1
+            0x80, 0x24, // 206: ADD V0, V2
+            0x12, 0x00, // 208: JP 0x200
+    };
+    return program;
+}
+
+/**
+ * Record a run with key events at odd cycles
+ * @return Snapshot hash at the end of the run
+ */
+static uint64_t recordRun(InputLog & log) {
+    chip8 machine;
+    test::load(machine, keyProgram());
+    Recorder recorder(machine, 4321, fnv1a(keyProgram().data(), keyProgram().size()));
+    for (uint64_t cycle = 7; cycle < 2000; cycle += 131) {
+        machine.runUntil(cycle);
+        recorder.setKey(0, (cycle / 131) % 2 == 0);
+    }
+    machine.runUntil(2500);
+    log = recorder.finish();
+    return machine.snapshot().hash();
+}
+
+static void replay() {
+    InputLog log;
+    uint64_t expected = recordRun(log);
+    CHECK_EQUAL(log.end_cycle, 2500u);
+    CHECK_EQUAL(log.events.size(), 16u);
+
+    chip8 machine;
+    test::load(machine, keyProgram());
+    Replayer replayer(log);
+    replayer.start(machine);
+    replayer.runToEnd(machine);
+    CHECK(replayer.finished(machine));
+    CHECK_EQUAL(machine.snapshot().hash(), expected);
+
+    // Replaying in steps that don't line up with the events changes nothing
+    test::load(machine, keyProgram());
+    replayer.start(machine);
+    for (uint64_t cycle = 0; cycle < log.end_cycle; cycle += 97) {
+        replayer.runUntil(machine, cycle);
+    }
+    replayer.runToEnd(machine);
+    CHECK_EQUAL(machine.snapshot().hash(), expected);
+
+    // One event less diverges
+    InputLog missing = log;
+    missing.events.pop_back();
+    test::load(machine, keyProgram());
+    Replayer partial(missing);
+    partial.start(machine);
+    partial.runToEnd(machine);
+    CHECK(machine.snapshot().hash() != expected);
+}
+
+static void stream() {
+    InputLog log;
+    recordRun(log);
+
+    std::stringstream buffer;
+    CHECK(log.write(buffer));
+    InputLog loaded;
+    CHECK(InputLog::read(buffer, loaded));
+    CHECK_EQUAL(loaded.seed, log.seed);
+    CHECK_EQUAL(loaded.rom_hash, log.rom_hash);
+    CHECK_EQUAL(loaded.end_cycle, log.end_cycle);
+    CHECK_EQUAL(loaded.events.size(), log.events.size());
+    for (size_t i = 0; i < log.events.size() && i < loaded.events.size(); ++i) {
+        CHECK_EQUAL(loaded.events[i].cycle, log.events[i].cycle);
+        CHECK_EQUAL(loaded.events[i].pressed, log.events[i].pressed);
+    }
+}
+
+/**
+ * The seed is part of the run, the same program with another seed diverges
+ */
+static void seed() {
+    chip8 first;
+    chip8 second;
+    test::load(first, keyProgram());
+    test::load(second, keyProgram());
+    first.seed(1);
+    second.seed(1);
+    first.runUntil(1000);
+    second.runUntil(1000);
+    CHECK_EQUAL(first.snapshot().hash(), second.snapshot().hash());
+
+    test::load(second, keyProgram());
+    second.seed(2);
+    second.runUntil(1000);
+    CHECK(first.snapshot().hash() != second.snapshot().hash());
+}
+
+void testReplay() {
+    replay();
+    stream();
+    seed();
+}
@@ -0,0 +1,71 @@
+//
+// Created by david on 18-10-26.
+//
+
+#include <vector>
+#include "Test.h"
+#include "../src/chip8.h"
+#include "../src/Rewind/RewindBuffer.h"
+
+/**
+ * Every frame in the buffer, keyframe or delta, decodes to the state it was captured from
+ */
+static void restoreFrames() {
+    chip8 machine;
+    test::load(machine, test::counter());
+    RewindBuffer buffer(1, 8);
+
+    std::vector<uint64_t> hashes;
+    for (int frame = 0; frame < 50; ++frame) {
+        buffer.capture(machine);
+        hashes.push_back(machine.snapshot().hash());
+        machine.runFrame();
+    }
+    CHECK_EQUAL(buffer.frameCount(), 50u);
+    CHECK_EQUAL(buffer.oldestFrame(), 0u);
+    CHECK_EQUAL(buffer.newestFrame(), 49u);
+
+    Snapshot snapshot;
+    for (uint64_t frame = 0; frame < 50; ++frame) {
+        CHECK(buffer.decode(frame, snapshot));
+        CHECK_EQUAL(snapshot.hash(), hashes[frame]);
+    }
+
+    // Restoring drops the newer frames and continues from there
+    CHECK(buffer.rewind(10, machine));
+    CHECK_EQUAL(machine.snapshot().hash(), hashes[39]);
+    CHECK_EQUAL(buffer.newestFrame(), 39u);
+    machine.runFrame();
+    buffer.capture(machine);
+    CHECK_EQUAL(buffer.newestFrame(), 40u);
+    CHECK(buffer.decode(40, snapshot));
+    CHECK_EQUAL(snapshot.hash(), hashes[40]);
+
+    CHECK(!buffer.restore(41, machine));
+}
+
+/**
+ * A full ring drops the oldest keyframe group, never leaving deltas without their keyframe
+ */
+static void budget() {
+    chip8 machine;
+    test::load(machine, test::counter());
+    RewindBuffer buffer(0.05, 10);
+
+    for (int frame = 0; frame < 2000; ++frame) {
+        buffer.capture(machine);
+        machine.runFrame();
+    }
+    CHECK(buffer.oldestFrame() > 0);
+    CHECK_EQUAL(buffer.oldestFrame() % 10, 0u);
+    CHECK(buffer.bytesUsed() <= buffer.capacity());
+
+    Snapshot snapshot;
+    CHECK(buffer.decode(buffer.oldestFrame(), snapshot));
+    CHECK(!buffer.decode(buffer.oldestFrame() - 1, snapshot));
+}
+
+void testRewind() {
+    restoreFrames();
+    budget();
+}
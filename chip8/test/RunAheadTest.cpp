@@ -0,0 +1,93 @@
+//
+// Created by david on 18-10-26.
+//
+
+#include <cstring>
+#include <vector>
+#include "Test.h"
+#include "../src/chip8.h"
+#include "../src/RunAhead/RunAhead.h"
+
+/**
+ * Running ahead shows a future frame and leaves the machine as it was
+ */
+static void ahead() {
+    chip8 machine;
+    chip8 future;
+    test::load(machine, test::counter());
+    test::load(future, test::counter());
+    RunAhead runAhead(2);
+
+    for (int frame = 0; frame < 20; ++frame) {
+        const unsigned char * shown = runAhead.frame(machine);
+        future.runFrame();
+
+        chip8 check;
+        check.restore(future.snapshot());
+        check.runFrame();
+        check.runFrame();
+        CHECK(std::memcmp(shown, check.framebuffer(), SCREEN_WIDTH * SCREEN_HEIGHT) == 0);
+        CHECK_EQUAL(machine.snapshot().hash(), future.snapshot().hash());
+    }
+
+    // Disabled, the machine's own frame
+    runAhead.setFrames(0);
+    CHECK(runAhead.frame(machine) == machine.framebuffer());
+}
+
+/**
+ * Restoring after every run-ahead keeps the code pages the program didn't write
+ */
+static void codePages() {
+    chip8 machine;
+    test::load(machine, test::counter());
+    std::vector<unsigned int> invalidated;
+    machine.writeTracker().setInvalidationHandler([&invalidated](unsigned int page) {
+        invalidated.push_back(page);
+    });
+    RunAhead runAhead(3);
+
+    for (int frame = 0; frame < 10; ++frame) {
+        runAhead.frame(machine);
+        CHECK(machine.writeTracker().isCode(PROGRAM_START));
+    }
+    for (unsigned int page : invalidated) {
+        CHECK(page != PROGRAM_START >> WriteTracker::PAGE_SHIFT);
+    }
+
+    // A restore that does change code invalidates it
+    Snapshot snapshot = machine.snapshot();
+    snapshot.memory[PROGRAM_START + 4] ^= 0xFF;
+    machine.restore(snapshot);
+    CHECK(!machine.writeTracker().isCode(PROGRAM_START));
+    CHECK_EQUAL(machine.memory.getOpcode(PROGRAM_START + 3), (uint16_t) (0x08 << 8 | (0xA3 ^ 0xFF)));
+}
+
+/**
+ * The frames run ahead don't count, the machine counts what its real frames executed and wrote
+ */
+static void counters() {
+    chip8 machine;
+    chip8 real;
+    test::load(machine, test::counter());
+    test::load(real, test::counter());
+    RunAhead runAhead(3);
+
+    for (int frame = 0; frame < 10; ++frame) {
+        runAhead.frame(machine);
+        real.runFrame();
+    }
+    CHECK(real.writeTracker().statistics().writes > 0);
+    CHECK_EQUAL(machine.instructionCount(), real.instructionCount());
+    CHECK_EQUAL(machine.writeTracker().statistics().writes, real.writeTracker().statistics().writes);
+#ifdef CHIP8_PROFILE
+    CHECK_EQUAL(machine.profiler().statistics().instructions, real.profiler().statistics().instructions);
+    CHECK_EQUAL(machine.profiler().statistics().pcs[PROGRAM_START + 6], real.profiler().statistics().pcs[PROGRAM_START + 6]);
+#endif
+}
+
+void testRunAhead() {
+    ahead();
+    codePages();
+    counters();
+}
@@ -0,0 +1,91 @@
+//
+// Created by david on 18-10-26.
+//
+
+#include <vector>
+#include "Test.h"
+#include "../src/chip8.h"
+#include "../src/Scheduler/Scheduler.h"
+
+/**
+ * Take every event due up to a cycle, as (cycle, id) pairs
+ */
+static std::vector<std::pair<uint64_t, unsigned int>> takeUntil(Scheduler & scheduler, uint64_t end) {
+    std::vector<std::pair<uint64_t, unsigned int>> fired;
+    Scheduler::Event event;
+    for (uint64_t cycle = 0; cycle <= end; ++cycle) {
+        while (scheduler.take(cycle, event)) {
+            fired.emplace_back(cycle, event.id);
+        }
+    }
+    return fired;
+}
+
+/**
+ * Events come out by due cycle, events due together in the order they were first scheduled
+ */
+static void ordering() {
+    Scheduler scheduler;
+    scheduler.schedule(1, 10, 10);
+    scheduler.schedule(2, 20);
+    scheduler.schedule(3, 5);
+    scheduler.schedule(4, 20);
+    CHECK_EQUAL(scheduler.nextCycle(), 5u);
+
+    std::vector<std::pair<uint64_t, unsigned int>> expected = {
+            {5, 3}, {10, 1}, {20, 1}, {20, 2}, {20, 4}, {30, 1},
+    };
+    CHECK(takeUntil(scheduler, 30) == expected);
+    // The periodic event stays scheduled
+    CHECK_EQUAL(scheduler.size(), 1u);
+    CHECK_EQUAL(scheduler.nextCycle(), 40u);
+}
+
+static void cancelAndDelay() {
+    Scheduler scheduler;
+    scheduler.schedule(1, 10, 10);
+    scheduler.schedule(2, 15);
+    scheduler.schedule(1, 12);
+    scheduler.cancel(1);
+    CHECK_EQUAL(scheduler.size(), 1u);
+
+    scheduler.delay(100);
+    CHECK_EQUAL(scheduler.nextCycle(), 115u);
+    Scheduler::Event event;
+    CHECK(!scheduler.take(114, event));
+    CHECK(scheduler.take(115, event));
+    CHECK_EQUAL(event.id, 2u);
+    CHECK(scheduler.empty());
+    CHECK_EQUAL(scheduler.nextCycle(), Scheduler::NEVER);
+}
+
+/**
+ * run() hands every event over at exactly the cycle it is due and stops when a handler says so
+ */
+static void run() {
+    chip8 machine;
+    test::load(machine, test::counter());
+    Scheduler scheduler;
+    scheduler.schedule(1, CYCLES_PER_FRAME, CYCLES_PER_FRAME);
+    scheduler.schedule(2, 25);
+
+    std::vector<std::pair<uint64_t, unsigned int>> fired;
+    CHECK(scheduler.run(machine, 40, [&](const Scheduler::Event & event) {
+        fired.emplace_back(machine.cycleCount(), event.id);
+        return true;
+    }));
+    CHECK_EQUAL(machine.cycleCount(), 40u);
+    std::vector<std::pair<uint64_t, unsigned int>> expected = {{10, 1}, {20, 1}, {25, 2}, {30, 1}, {40, 1}};
+    CHECK(fired == expected);
+
+    CHECK(!scheduler.run(machine, Scheduler::NEVER, [&](const Scheduler::Event &) {
+        return machine.cycleCount() < 70;
+    }));
+    CHECK_EQUAL(machine.cycleCount(), 70u);
+}
+
+void testScheduler() {
+    ordering();
+    cancelAndDelay();
+    run();
+}
@@ -0,0 +1,131 @@
+//
+// Created by david on 18-10-26.
+//
+
+#include "Test.h"
+#include "../src/chip8.h"
+#include "../src/Session/Session.h"
+#include "../src/Session/SessionExecutor.h"
+
+static const std::vector<unsigned char> WAIT_PROGRAM = {
+        0xF3, 0x0A, // 200: LD V3, K
+        0x73, 0x01, // 202: ADD V3, 1
+        0x12, 0x02, // 204: JP 0x202
+};
+
+/**
+ * A session runs a frame per resume and is done after its frames
+ */
+static void session() {
+    chip8 machine;
+    test::load(machine, test::counter());
+    Session session = play(machine, 3);
+    CHECK_EQUAL(machine.cycleCount(), 0u);
+
+    for (uint64_t frame = 1; frame <= 3; ++frame) {
+        CHECK_EQUAL(session.resume(), Session::SESSION_FRAME);
+        CHECK_EQUAL(machine.cycleCount(), frame * CYCLES_PER_FRAME);
+    }
+    CHECK(!session.done());
+    CHECK_EQUAL(session.resume(), Session::SESSION_DONE);
+    CHECK(session.done());
+    CHECK_EQUAL(machine.cycleCount(), 3u * CYCLES_PER_FRAME);
+
+    chip8 waiting;
+    test::load(waiting, WAIT_PROGRAM);
+    Session blocked = play(waiting);
+    CHECK_EQUAL(blocked.resume(), Session::SESSION_KEY_WAIT);
+}
+
+/**
+ * A session blocked on Fx0A is parked, a key press catches it up and makes it ready again
+ */
+static void parking() {
+    chip8 running;
+    test::load(running, test::counter());
+    chip8 waiting;
+    test::load(waiting, WAIT_PROGRAM);
+
+    SessionExecutor executor;
+    executor.add(running);
+    SessionExecutor::Id id = executor.add(waiting);
+    CHECK_EQUAL(executor.runFrame(), 2u);
+    CHECK_EQUAL(executor.parked(), 1u);
+    CHECK_EQUAL(executor.ready(), 1u);
+
+    for (int frame = 0; frame < 4; ++frame) {
+        CHECK_EQUAL(executor.runFrame(), 1u);
+    }
+    CHECK_EQUAL(running.cycleCount(), 5u * CYCLES_PER_FRAME);
+    CHECK_EQUAL(waiting.cycleCount(), 1u * CYCLES_PER_FRAME);
+
+    // A release doesn't end the wait, the session stays parked
+    executor.setKey(id, 0x2, false);
+    CHECK_EQUAL(executor.parked(), 1u);
+
+    executor.setKey(id, 0x5, true);
+    CHECK_EQUAL(executor.parked(), 0u);
+    CHECK_EQUAL(executor.ready(), 2u);
+    CHECK_EQUAL(waiting.cycleCount(), 5u * CYCLES_PER_FRAME);
+    CHECK_EQUAL(waiting.registerValue(3), 5);
+
+    CHECK_EQUAL(executor.runFrame(), 2u);
+    CHECK_EQUAL(waiting.cycleCount(), running.cycleCount());
+    CHECK_EQUAL(executor.frame(), 6u);
+}
+
+/**
+ * Done sessions drop out of the ready list
+ */
+static void done() {
+    chip8 machine;
+    test::load(machine, test::counter());
+    SessionExecutor executor;
+    executor.add(machine, 2);
+    CHECK_EQUAL(executor.runFrame(), 1u);
+    CHECK_EQUAL(executor.runFrame(), 1u);
+    CHECK_EQUAL(executor.runFrame(), 1u);
+    CHECK_EQUAL(executor.ready(), 0u);
+    CHECK_EQUAL(executor.runFrame(), 0u);
+    CHECK_EQUAL(machine.cycleCount(), 2u * CYCLES_PER_FRAME);
+}
+
+/**
+ * Frames sat out parked count toward the session's frames
+ */
+static void parkedBudget() {
+    chip8 waiting;
+    test::load(waiting, WAIT_PROGRAM);
+    SessionExecutor executor;
+    SessionExecutor::Id id = executor.add(waiting, 6);
+    for (int frame = 0; frame < 4; ++frame) {
+        executor.runFrame();
+    }
+    executor.setKey(id, 0x5, true);
+    CHECK_EQUAL(waiting.cycleCount(), 4u * CYCLES_PER_FRAME);
+    for (int frame = 0; frame < 5; ++frame) {
+        executor.runFrame();
+    }
+    CHECK_EQUAL(executor.ready(), 0u);
+    CHECK_EQUAL(waiting.cycleCount(), 6u * CYCLES_PER_FRAME);
+
+    // A key after the last frame doesn't run the machine past it
+    chip8 late;
+    test::load(late, WAIT_PROGRAM);
+    id = executor.add(late, 3);
+    for (int frame = 0; frame < 10; ++frame) {
+        executor.runFrame();
+    }
+    executor.setKey(id, 0x5, true);
+    CHECK_EQUAL(late.cycleCount(), 3u * CYCLES_PER_FRAME);
+    CHECK_EQUAL(executor.runFrame(), 1u);
+    CHECK_EQUAL(executor.ready(), 0u);
+    CHECK_EQUAL(late.cycleCount(), 3u * CYCLES_PER_FRAME);
+}
+
+void testSessions() {
+    session();
+    parking();
+    done();
+    parkedBudget();
+}
@@ -0,0 +1,103 @@
+//
+// Created by david on 18-10-26.
+//
+
+#include <sstream>
+#include "Test.h"
+#include "../src/chip8.h"
+
+/**
+ * A restored machine continues exactly like the one the snapshot was taken from
+ */
+static void restoreContinues() {
+    chip8 machine;
+    test::load(machine, test::counter());
+    machine.runUntil(1234);
+    Snapshot saved = machine.snapshot();
+
+    machine.runUntil(5000);
+    uint64_t expected = machine.snapshot().hash();
+
+    chip8 other;
+    other.restore(saved);
+    CHECK_EQUAL(other.snapshot().hash(), saved.hash());
+    CHECK_EQUAL(other.cycleCount(), 1234u);
+    other.runUntil(5000);
+    CHECK_EQUAL(other.snapshot().hash(), expected);
+
+    machine.restore(saved);
+    machine.runUntil(5000);
+    CHECK_EQUAL(machine.snapshot().hash(), expected);
+}
+
+/**
+ * Timers, keys and a pending Fx0A survive a snapshot
+ */
+static void cpuState() {
+    chip8 machine;
+    test::load(machine, {
+            0x60, 0x20, // 200: LD V0, 0x20
+            0xF0, 0x15, // 202: LD DT, V0
+            0xF0, 0x18, // 204: LD ST, V0
+            0xF5, 0x0A, // 206: LD V5, K
+            0x12, 0x08, // 208: JP 0x208
+    });
+    machine.setKey(3, true);
+    machine.runUntil(35);
+
+    chip8 other;
+    other.restore(machine.snapshot());
+    CHECK_EQUAL(other.delayTimer(), machine.delayTimer());
+    CHECK_EQUAL(other.soundTimer(), machine.soundTimer());
+    CHECK_EQUAL(other.keyState(), 1u << 3);
+    CHECK(other.waitingForKey());
+
+    other.setKey(7, true);
+    CHECK(!other.waitingForKey());
+    CHECK_EQUAL(other.registerValue(5), 7);
+}
+
+/**
+ * Restoring only drops the code marks of the memory pages it changes
+ */
+static void codePages() {
+    chip8 machine;
+    test::load(machine, test::counter());
+    machine.runUntil(10);
+    CHECK(machine.writeTracker().isCode(PROGRAM_START));
+
+    uint64_t code = machine.writeTracker().codePages();
+    machine.restore(machine.snapshot());
+    CHECK_EQUAL(machine.writeTracker().codePages(), code);
+
+    Snapshot changed = machine.snapshot();
+    changed.memory[PROGRAM_START] ^= 0xFF;
+    machine.restore(changed);
+    CHECK(!machine.writeTracker().isCode(PROGRAM_START));
+}
+
+static void stream() {
+    chip8 machine;
+    test::load(machine, test::counter());
+    machine.runUntil(777);
+    Snapshot saved = machine.snapshot();
+
+    std::stringstream buffer;
+    CHECK(saved.write(buffer));
+    Snapshot loaded;
+    CHECK(Snapshot::read(buffer, loaded));
+    CHECK_EQUAL(loaded.hash(), saved.hash());
+
+    // Wrong magic
+    std::string bytes = buffer.str();
+    bytes[0] ^= 0xFF;
+    std::stringstream corrupt(bytes);
+    CHECK(!Snapshot::read(corrupt, loaded));
+}
+
+void testSnapshot() {
+    restoreContinues();
+    cpuState();
+    codePages();
+    stream();
+}
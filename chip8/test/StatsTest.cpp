@@ -0,0 +1,126 @@
+//
+// Created by david on 18-10-26.
+//
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include "Test.h"
+#include "../src/chip8.h"
+#include "../src/Stats/Stats.h"
+#include "../src/Stats/StatsExporter.h"
+
+// One 60 Hz period in nanoseconds
+static const uint64_t PERIOD = 1000000000 / FRAMES_PER_SECOND;
+
+static void frames() {
+    Stats stats;
+    uint64_t now = 1000000000;
+    uint64_t cycles = 0;
+    for (int frame = 0; frame < 100; ++frame) {
+        stats.frame(cycles, cycles, now);
+        now += PERIOD;
+        cycles += CYCLES_PER_FRAME;
+    }
+
+    Stats::Summary summary = stats.summary();
+    CHECK_EQUAL(summary.frames, 100u);
+    CHECK_EQUAL(summary.dropped, 0u);
+    CHECK_EQUAL(summary.duplicated, 0u);
+    CHECK(summary.frame_p50 > 16.6 && summary.frame_p50 < 16.7);
+    CHECK(summary.ips > 599 && summary.ips < 601);
+    CHECK(summary.drift_ms > -1 && summary.drift_ms < 1);
+
+    // Three periods late, without the machine having advanced: two frames were never shown
+    now += 2 * PERIOD;
+    stats.frame(cycles - CYCLES_PER_FRAME, cycles - CYCLES_PER_FRAME, now);
+    CHECK_EQUAL(stats.summary().dropped, 2u);
+    CHECK_EQUAL(stats.summary().duplicated, 1u);
+    CHECK(stats.frameTime(0) > 49 && stats.frameTime(0) < 51);
+    CHECK(stats.frameTime(1) > 16.6 && stats.frameTime(1) < 16.7);
+}
+
+/**
+ * Sleeping while the program waits for a key drops no frames
+ */
+static void idle() {
+    Stats stats;
+    uint64_t now = 0;
+    stats.frame(0, 0, now);
+    now += PERIOD;
+    stats.frame(CYCLES_PER_FRAME, CYCLES_PER_FRAME, now);
+
+    now += 90 * PERIOD;
+    stats.wake(now);
+    now += PERIOD / 2;
+    stats.frame(92 * CYCLES_PER_FRAME, 92 * CYCLES_PER_FRAME, now);
+
+    CHECK_EQUAL(stats.summary().dropped, 0u);
+    CHECK(stats.frameTime(0) > 8.3 && stats.frameTime(0) < 8.4);
+}
+
+/**
+ * Instructions per second count instructions, not cycles of the timing model
+ */
+static void vipInstructions() {
+    chip8 machine;
+    test::load(machine, test::counter());
+    machine.setTiming(TIMING_VIP);
+    Stats stats;
+    stats.setCyclesPerFrame(machine.cyclesPerFrame());
+    for (uint64_t frame = 0; frame <= FRAMES_PER_SECOND; ++frame) {
+        stats.frame(machine.cycleCount(), machine.instructionCount(), frame * PERIOD);
+        machine.runFrame();
+    }
+
+    Stats::Summary summary = stats.summary();
+    CHECK(summary.instructions < summary.cycles / 40);
+    // One second of play in one second of wall clock time
+    CHECK(summary.ips > summary.instructions * 0.99 && summary.ips < summary.instructions * 1.01);
+    CHECK(summary.drift_ms > -1 && summary.drift_ms < 1);
+
+    std::ostringstream out;
+    stats.write(out);
+    CHECK(out.str().find("chip8_instructions_total " + std::to_string(summary.instructions) + "\n")
+          != std::string::npos);
+    CHECK(out.str().find("chip8_cycles_total " + std::to_string(summary.cycles) + "\n") != std::string::npos);
+}
+
+/**
+ * The writer thread writes the published stats to the file
+ */
+static void exporter() {
+    const char * path = "stats_test.prom";
+    Stats stats;
+    stats.frame(0, 0, 0);
+    stats.frame(CYCLES_PER_FRAME, CYCLES_PER_FRAME, PERIOD);
+    {
+        StatsExporter exporter;
+        exporter.setFile(path);
+        CHECK(exporter.enabled());
+        exporter.publish(stats);
+        exporter.flush();
+
+        std::ifstream in(path);
+        std::stringstream text;
+        text << in.rdbuf();
+        CHECK(text.str().find("chip8_frames_total 2\n") != std::string::npos);
+
+        // The last dump is written before the exporter goes away
+        stats.frame(2 * CYCLES_PER_FRAME, 2 * CYCLES_PER_FRAME, 2 * PERIOD);
+        exporter.publish(stats);
+    }
+    std::ifstream in(path);
+    std::stringstream text;
+    text << in.rdbuf();
+    CHECK(text.str().find("chip8_frames_total 3\n") != std::string::npos);
+    std::remove(path);
+}
+
+void testStats() {
+    frames();
+    idle();
+    vipInstructions();
+    exporter();
+}
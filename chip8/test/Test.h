@@ -0,0 +1,100 @@
+//
+// Created by david on 18-10-26.
+//
+
+#ifndef CHIP8_TEST_H
+#define CHIP8_TEST_H
+
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+namespace test {
+
+    /**
+     * @return Checks failed so far
+     */
+    inline unsigned int & failures() {
+        static unsigned int count = 0;
+        return count;
+    }
+
+    inline bool check(bool passed, const char * expression, const char * file, int line) {
+        if (!passed) {
+            ++failures();
+            std::cerr << file << ":" << line << ": check failed: " << expression << std::endl;
+        }
+        return passed;
+    }
+
+    template<typename A, typename B>
+    bool checkEqual(const A & actual, const B & expected, const char * expression, const char * file, int line) {
+        if (actual == expected) {
+            return true;
+        }
+        ++failures();
+        std::cerr << file << ":" << line << ": check failed: " << expression << ", got " << +actual
+                  << ", expected " << +expected << std::endl;
+        return false;
+    }
+
+    /**
+     * Counts in V0, stores it as BCD, draws it and takes a random number, so every frame changes registers,
+     * memory, the framebuffer and the RNG state
+     */
+    inline const std::vector<unsigned char> & counter() {
+        static const std::vector<unsigned char> program = {
+                0x60, 0x00, // 200: LD V0, 0
+                0x61, 0x08, // 202: LD V1, 8
+                0xA3, 0x00, // 204: LD I, 0x300
+                0x70, 0x01, // 206: ADD V0, 1
+                0xF0, 0x33, // 208: LD B, V0
+                0xD0, 0x13, // 20A: DRW V0, V1, 3
+                0xC2, 0xFF, // 20C: RND V2, 0xFF
+                0x12, 0x06, // 20E: JP 0x206
+        };
+        return program;
+    }
+
+    /**
+     * Initialize a machine and load a program into it
+     */
+    template<typename M>
+    void load(M & machine, const std::vector<unsigned char> & program) {
+        machine.initialize();
+        machine.loadProgram(program.data(), (int) program.size());
+    }
+}
+
+#define CHECK(expression) test::check((expression), #expression, __FILE__, __LINE__)
+#define CHECK_EQUAL(actual, expected) \
+    test::checkEqual((actual), (expected), #actual " == " #expected, __FILE__, __LINE__)
+
+void testWriteTracker();
+void testMemory();
+void testSnapshot();
+void testPagedSnapshot();
+void testRewind();
+void testReplay();
+void testReplayFile();
+void testRunAhead();
+void testTimeTravelDebugger();
+void testDebugPolicy();
+#ifdef CHIP8_PROFILE
+void testProfiler();
+#endif
+void testDisassembler();
+void testTrace();
+void testStats();
+void testOpcodes();
+void testQuirks();
+void testPolicies();
+void testTimers();
+void testScheduler();
+void testTiming();
+void testTimer();
+void testKeyWait();
+void testSessions();
+void testKeyChannel();
+
+#endif //CHIP8_TEST_H
@@ -0,0 +1,121 @@
+//
+// Created by david on 18-10-26.
+//
+
+#include <vector>
+#include "Test.h"
+#include "../src/chip8.h"
+#include "../src/Debugger/TimeTravelDebugger.h"
+
+/**
+ * Any recorded cycle is reached with the state the machine had there
+ */
+static void seek() {
+    chip8 machine;
+    test::load(machine, test::counter());
+    TimeTravelDebugger debugger(machine, 100);
+
+    std::vector<uint64_t> hashes;
+    for (int i = 0; i < 1000; ++i) {
+        hashes.push_back(machine.snapshot().hash());
+        CHECK(debugger.step());
+    }
+    hashes.push_back(machine.snapshot().hash());
+    CHECK_EQUAL(debugger.frontier(), 1000u);
+
+    for (uint64_t cycle : {0u, 517u, 1000u, 999u, 250u}) {
+        CHECK(debugger.seek(cycle));
+        CHECK_EQUAL(debugger.position(), cycle);
+        CHECK_EQUAL(machine.snapshot().hash(), hashes[cycle]);
+    }
+
+    CHECK(debugger.reverseStep());
+    CHECK_EQUAL(debugger.position(), 249u);
+    CHECK_EQUAL(machine.snapshot().hash(), hashes[249]);
+
+    CHECK(debugger.seek(0));
+    CHECK(!debugger.reverseStep());
+    CHECK(!debugger.seek(1001));
+}
+
+/**
+ * Reverse searches stop before the last matching instruction
+ */
+static void reverseSearches() {
+    chip8 machine;
+    test::load(machine, test::counter());
+    TimeTravelDebugger debugger(machine, 100);
+    debugger.run(1000);
+
+    // RND V2 at 0x20C, at cycle 6 + 5n
+    CHECK(debugger.reverseToRegisterWrite(2));
+    CHECK_EQUAL(machine.programCounter(), 0x20C);
+    CHECK_EQUAL(debugger.position(), 996u);
+
+    CHECK(debugger.reverseToMemoryWrite(0x301));
+    CHECK_EQUAL(machine.programCounter(), 0x208);
+    CHECK_EQUAL(debugger.position(), 994u);
+
+    CHECK(debugger.reverseToRegisterWrite(TimeTravelDebugger::REGISTER_I));
+    CHECK_EQUAL(machine.programCounter(), 0x204);
+    CHECK_EQUAL(debugger.position(), 2u);
+    CHECK(!debugger.reverseToRegisterWrite(TimeTravelDebugger::REGISTER_I));
+    CHECK_EQUAL(debugger.position(), 2u);
+
+    uint64_t cycle = 0;
+    CHECK(debugger.firstReach(0x20C, cycle));
+    CHECK_EQUAL(cycle, 6u);
+    CHECK(!debugger.firstReach(0x400, cycle));
+}
+
+/**
+ * A key event in the past replaces the recorded future, key events replay when seeking
+ */
+static void keys() {
+    chip8 machine;
+    test::load(machine, {
+            0xF3, 0x0A, // 200: LD V3, K
+            0x73, 0x01, // 202: ADD V3, 1
+            0x12, 0x02, // 204: JP 0x202
+    });
+    TimeTravelDebugger debugger(machine, 50);
+    debugger.run(100);
+    debugger.setKey(6, true);
+    debugger.run(100);
+    CHECK_EQUAL(machine.registerValue(3), 6 + 50);
+    uint64_t expected = machine.snapshot().hash();
+
+    CHECK(debugger.seek(20));
+    CHECK(machine.waitingForKey());
+    CHECK(debugger.seek(200));
+    CHECK_EQUAL(machine.snapshot().hash(), expected);
+
+    CHECK(debugger.seek(150));
+    debugger.setKey(6, false);
+    CHECK_EQUAL(debugger.frontier(), 150u);
+}
+
+/**
+ * By default there is a checkpoint every emulated second, whatever the timing model
+ */
+static void defaultInterval() {
+    for (TimingMode mode : {TIMING_FIXED, TIMING_VIP}) {
+        chip8 machine;
+        test::load(machine, test::counter());
+        machine.setTiming(mode);
+        TimeTravelDebugger debugger(machine);
+
+        uint64_t second = machine.cyclesPerFrame() * FRAMES_PER_SECOND;
+        while (machine.cycleCount() < 3 * second) {
+            CHECK(debugger.step());
+        }
+        CHECK_EQUAL(debugger.checkpointCount(), 4u);
+    }
+}
+
+void testTimeTravelDebugger() {
+    seek();
+    reverseSearches();
+    keys();
+    defaultInterval();
+}
@@ -0,0 +1,66 @@
+//
+// Created by david on 18-10-26.
+//
+
+#include <thread>
+#include "Test.h"
+#include "../src/Timer.h"
+
+using std::chrono::milliseconds;
+
+/**
+ * Deadlines are at start + n periods however late the waits return
+ */
+static void deadlines() {
+    Timer timer(100);
+    Timer::Clock::time_point before = Timer::Clock::now();
+    timer.start();
+    for (int i = 0; i < 5; ++i) {
+        timer.wait();
+        // Late, but not by a whole period
+        std::this_thread::sleep_for(milliseconds(3));
+    }
+    CHECK(Timer::Clock::now() - before >= milliseconds(50));
+    // A busy host can make a wait miss deadlines, the later ones stay on the grid anyway
+    milliseconds next = milliseconds(10 * (6 + timer.missed()));
+    CHECK(timer.deadline() - before >= next);
+    // Only a preemption between taking before and start() shifts the grid
+    CHECK(timer.deadline() - before < next + milliseconds(5));
+}
+
+/**
+ * Deadlines passed by a whole period are counted and skipped, not caught up
+ */
+static void missed() {
+    Timer timer(100);
+    timer.start();
+    std::this_thread::sleep_for(milliseconds(55));
+    Timer::Clock::time_point before = Timer::Clock::now();
+    timer.wait();
+    CHECK(timer.missed() >= 4u && timer.missed() <= 6u);
+    // Only the last passed deadline is served, the next one is a period away at most
+    timer.wait();
+    CHECK(Timer::Clock::now() - before < milliseconds(35));
+}
+
+/**
+ * skip() drops the passed deadlines without counting them as missed
+ */
+static void skip() {
+    Timer timer(100);
+    timer.start();
+    std::this_thread::sleep_for(milliseconds(55));
+    uint64_t skipped = timer.skip();
+    CHECK(skipped >= 5u && skipped <= 7u);
+    CHECK_EQUAL(timer.skip(), 0u);
+    Timer::Clock::time_point before = Timer::Clock::now();
+    timer.wait();
+    CHECK(Timer::Clock::now() - before < milliseconds(20));
+    CHECK_EQUAL(timer.missed(), 0u);
+}
+
+void testTimer() {
+    deadlines();
+    missed();
+    skip();
+}
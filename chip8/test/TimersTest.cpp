@@ -0,0 +1,67 @@
+//
+// Created by david on 18-10-26.
+//
+
+#include <algorithm>
+#include "Test.h"
+#include "../src/chip8.h"
+
+static const std::vector<unsigned char> PROGRAM = {
+        0x60, 0x05, // 200: LD V0, 5
+        0xF0, 0x15, // 202: LD DT, V0
+        0x61, 0x03, // 204: LD V1, 3
+        0xF1, 0x18, // 206: LD ST, V1
+        0xF2, 0x07, // 208: LD V2, DT
+        0x12, 0x08, // 20A: JP 0x208
+};
+
+/**
+ * The timers count down once every CYCLES_PER_FRAME cycles from the tick they were set in and stop at 0
+ */
+static void countDown() {
+    chip8 machine;
+    test::load(machine, PROGRAM);
+
+    machine.runUntil(CYCLES_PER_FRAME);
+    CHECK_EQUAL(machine.delayTimer(), 4);
+    CHECK_EQUAL(machine.soundTimer(), 2);
+
+    // The last Fx07 ran at cycle 34, in tick 3
+    machine.runUntil(CYCLES_PER_FRAME * 3 + 5);
+    CHECK_EQUAL(machine.delayTimer(), 2);
+    CHECK_EQUAL(machine.soundTimer(), 0);
+    CHECK_EQUAL(machine.registerValue(2), 2);
+
+    machine.runUntil(CYCLES_PER_FRAME * 100);
+    CHECK_EQUAL(machine.delayTimer(), 0);
+    CHECK_EQUAL(machine.registerValue(2), 0);
+
+    machine.loadTimers(9, 1);
+    CHECK_EQUAL(machine.delayTimer(), 9);
+    CHECK_EQUAL(machine.soundTimer(), 1);
+    machine.runUntil(CYCLES_PER_FRAME * 103);
+    CHECK_EQUAL(machine.delayTimer(), 6);
+    CHECK_EQUAL(machine.soundTimer(), 0);
+}
+
+/**
+ * Where runs start and stop doesn't change when the timers tick
+ */
+static void batches() {
+    chip8 whole;
+    test::load(whole, PROGRAM);
+    whole.runUntil(97);
+
+    chip8 pieces;
+    test::load(pieces, PROGRAM);
+    for (uint64_t step = 1; pieces.cycleCount() < 97; step = step % 7 + 1) {
+        pieces.runUntil(std::min<uint64_t>(pieces.cycleCount() + step, 97));
+    }
+    CHECK_EQUAL(pieces.snapshot().hash(), whole.snapshot().hash());
+    CHECK_EQUAL(pieces.registerValue(2), whole.registerValue(2));
+}
+
+void testTimers() {
+    countDown();
+    batches();
+}
@@ -0,0 +1,78 @@
+//
+// Created by david on 18-10-26.
+//
+
+#include "Test.h"
+#include "../src/chip8.h"
+
+static void costs() {
+    CHECK_EQUAL(FixedTiming::cost(0xD01F), 1u);
+    CHECK_EQUAL(FixedTiming::cost(0xF033), 1u);
+
+    CHECK_EQUAL(VipTiming::cost(0x6012), VipTiming::FETCH_CYCLES + 6);
+    CHECK_EQUAL(VipTiming::cost(0x8014), VipTiming::FETCH_CYCLES + 44);
+    CHECK_EQUAL(VipTiming::cost(0xE09E), VipTiming::FETCH_CYCLES + 16);
+    // Sprites by row, loads and stores by register
+    CHECK_EQUAL(VipTiming::cost(0xD011), VipTiming::FETCH_CYCLES + 26 + VipTiming::ROW_CYCLES);
+    CHECK_EQUAL(VipTiming::cost(0xD01F), VipTiming::FETCH_CYCLES + 26 + 15 * VipTiming::ROW_CYCLES);
+    CHECK_EQUAL(VipTiming::cost(0xF055), VipTiming::FETCH_CYCLES + VipTiming::ROW_CYCLES);
+    CHECK_EQUAL(VipTiming::cost(0xFF65), VipTiming::FETCH_CYCLES + 16 * VipTiming::ROW_CYCLES);
+    CHECK_EQUAL(VipTiming::cost(0xF033), VipTiming::FETCH_CYCLES + 204);
+    CHECK_EQUAL(VipTiming::cost(0xF007), VipTiming::FETCH_CYCLES + 10);
+}
+
+/**
+ * Under VIP timing an instruction advances the cycle count by its cost, the timers tick every 3668 cycles
+ */
+static void vipMachine() {
+    chip8 machine;
+    test::load(machine, {
+            0x60, 0x02, // 200: LD V0, 2
+            0xF0, 0x15, // 202: LD DT, V0
+            0x70, 0x01, // 204: ADD V0, 1
+            0x12, 0x04, // 206: JP 0x204
+    });
+    machine.setTiming(TIMING_VIP);
+    CHECK_EQUAL(machine.cyclesPerFrame(), VipTiming::CYCLES_PER_FRAME);
+
+    machine.runUntil(1);
+    CHECK_EQUAL(machine.cycleCount(), (uint64_t) VipTiming::cost(0x6002));
+    machine.runUntil(machine.cycleCount() + 1);
+    CHECK_EQUAL(machine.cycleCount(), (uint64_t) (VipTiming::cost(0x6002) + VipTiming::cost(0xF015)));
+    CHECK_EQUAL(machine.instructionCount(), 2u);
+
+    machine.runUntil(VipTiming::CYCLES_PER_FRAME);
+    CHECK_EQUAL(machine.delayTimer(), 1);
+    machine.runUntil(VipTiming::CYCLES_PER_FRAME * 2);
+    CHECK_EQUAL(machine.delayTimer(), 0);
+    // Two instructions every 113 cycles, 50 for ADD and 63 for JP
+    CHECK(machine.instructionCount() > 4 * VipTiming::CYCLES_PER_FRAME / 113 - 2);
+    CHECK(machine.instructionCount() < 4 * VipTiming::CYCLES_PER_FRAME / 113 + 4);
+}
+
+/**
+ * Snapshots keep the timing model, their cycle counts are in its cycles
+ */
+static void snapshots() {
+    chip8 vip;
+    test::load(vip, test::counter());
+    vip.setTiming(TIMING_VIP);
+    vip.runUntil(10000);
+    Snapshot snapshot = vip.snapshot();
+    CHECK_EQUAL(snapshot.cpu.timing, TIMING_VIP);
+
+    chip8 machine;
+    test::load(machine, test::counter());
+    machine.restore(snapshot);
+    CHECK_EQUAL(machine.timing(), TIMING_VIP);
+    CHECK_EQUAL(machine.cyclesPerFrame(), VipTiming::CYCLES_PER_FRAME);
+    machine.runUntil(20000);
+    vip.runUntil(20000);
+    CHECK_EQUAL(machine.snapshot().hash(), vip.snapshot().hash());
+}
+
+void testTiming() {
+    costs();
+    vipMachine();
+    snapshots();
+}
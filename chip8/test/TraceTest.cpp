@@ -0,0 +1,62 @@
+//
+// Created by david on 18-10-26.
+//
+
+#include <sstream>
+#include <string>
+#include <thread>
+#include "Test.h"
+#include "../src/Trace/Trace.h"
+
+/**
+ * @return Number of spans with a name in a trace
+ */
+static unsigned int spans(const std::string & json, const std::string & name) {
+    unsigned int count = 0;
+    std::string key = "{\"name\":\"" + name + "\"";
+    for (size_t at = json.find(key); at != std::string::npos; at = json.find(key, at + 1)) {
+        ++count;
+    }
+    return count;
+}
+
+static void record() {
+    { TRACE_SPAN("test_before_start"); }
+
+    trace::start();
+    {
+        TRACE_SPAN("test_outer");
+        for (int i = 0; i < 3; ++i) {
+            TRACE_SPAN("test_inner");
+        }
+    }
+    std::thread other([]() {
+        TRACE_SPAN("test_thread");
+    });
+    other.join();
+    trace::stop();
+
+    { TRACE_SPAN("test_after_stop"); }
+
+    std::ostringstream out;
+    trace::write(out);
+    std::string json = out.str();
+    CHECK(json.find("\"traceEvents\":[") != std::string::npos);
+    CHECK_EQUAL(spans(json, "test_outer"), 1u);
+    CHECK_EQUAL(spans(json, "test_inner"), 3u);
+    CHECK_EQUAL(spans(json, "test_thread"), 1u);
+    CHECK_EQUAL(spans(json, "test_before_start"), 0u);
+    CHECK_EQUAL(spans(json, "test_after_stop"), 0u);
+
+    // The other thread's span is on its own track
+    size_t thread = json.find("{\"name\":\"test_thread\"");
+    size_t outer = json.find("{\"name\":\"test_outer\"");
+    if (thread != std::string::npos && outer != std::string::npos) {
+        std::string tid = "\"tid\":";
+        CHECK(json.substr(json.find(tid, thread), 8) != json.substr(json.find(tid, outer), 8));
+    }
+}
+
+void testTrace() {
+    record();
+}
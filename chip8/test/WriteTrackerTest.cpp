@@ -0,0 +1,64 @@
+//
+// Created by david on 18-10-26.
+//
+
+#include <vector>
+#include "Test.h"
+#include "../src/chip8.h"
+
+/**
+ * Stores into a page an instruction was fetched from invalidate exactly that page
+ */
+static void codeWrites() {
+    WriteTracker tracker;
+    std::vector<unsigned int> pages;
+    tracker.setInvalidationHandler([&pages](unsigned int page) { pages.push_back(page); });
+
+    tracker.markCode(0x300);
+    CHECK(tracker.isCode(0x300));
+    CHECK(tracker.isCode(0x33F));
+    CHECK(!tracker.isCode(0x340));
+
+    // Data page
+    tracker.noteWrite(0x400, 16, 0x302);
+    CHECK_EQUAL(tracker.statistics().code_writes, 0u);
+    CHECK(pages.empty());
+
+    tracker.noteWrite(0x33E, 4, 0x302);
+    CHECK_EQUAL(tracker.statistics().writes, 2u);
+    CHECK_EQUAL(tracker.statistics().code_writes, 1u);
+    CHECK_EQUAL(tracker.statistics().first_smc_pc, 0x302);
+    CHECK_EQUAL(tracker.statistics().page_invalidations[0x300 >> WriteTracker::PAGE_SHIFT], 1u);
+    CHECK_EQUAL(pages.size(), 1u);
+    CHECK(!pages.empty() && pages[0] == 0x300 >> WriteTracker::PAGE_SHIFT);
+    CHECK(!tracker.isCode(0x300));
+}
+
+/**
+ * A program storing into its own page through Fx55
+ */
+static void selfModifyingProgram() {
+    chip8 machine;
+    test::load(machine, {
+            0xA2, 0x20, // LD I, 0x220
+            0xF0, 0x55, // LD [I], V0
+            0x12, 0x04, // JP 0x204
+    });
+
+    machine.runUntil(1);
+    CHECK(machine.writeTracker().isCode(PROGRAM_START));
+
+    machine.runUntil(2);
+    CHECK(!machine.writeTracker().isCode(PROGRAM_START));
+    CHECK_EQUAL(machine.writeTracker().statistics().code_writes, 1u);
+    CHECK_EQUAL(machine.writeTracker().statistics().first_smc_pc, 0x202);
+
+    // Executing the page marks it again
+    machine.runUntil(3);
+    CHECK(machine.writeTracker().isCode(PROGRAM_START));
+}
+
+void testWriteTracker() {
+    codeWrites();
+    selfModifyingProgram();
+}
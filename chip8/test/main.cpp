@@ -0,0 +1,73 @@
+//
+// Created by david on 18-10-26.
+//
+
+#include <string>
+#include "Test.h"
+
+struct Suite {
+    const char * name;
+    void (* run)();
+};
+
+static const Suite SUITES[] = {
+        {"write_tracker", testWriteTracker},
+        {"memory", testMemory},
+        {"snapshot", testSnapshot},
+        {"paged_snapshot", testPagedSnapshot},
+        {"rewind", testRewind},
+        {"replay", testReplay},
+        {"replay_file", testReplayFile},
+        {"run_ahead", testRunAhead},
+        {"time_travel", testTimeTravelDebugger},
+        {"debug_policy", testDebugPolicy},
+#ifdef CHIP8_PROFILE
+        {"profiler", testProfiler},
+#endif
+        {"disassembler", testDisassembler},
+        {"trace", testTrace},
+        {"stats", testStats},
+        {"opcodes", testOpcodes},
+        {"quirks", testQuirks},
+        {"policies", testPolicies},
+        {"timers", testTimers},
+        {"scheduler", testScheduler},
+        {"timing", testTiming},
+        {"timer", testTimer},
+        {"key_wait", testKeyWait},
+        {"sessions", testSessions},
+        {"key_channel", testKeyChannel},
+};
+
+/**
+ * chip8-test [suite...]
+ * Runs the named suites, or all of them, and fails if any check failed
+ */
+int main(int argc, char **argv) {
+    for (int i = 1; i < argc; ++i) {
+        bool known = false;
+        for (const Suite & suite : SUITES) {
+            known = known || argv[i] == std::string(suite.name);
+        }
+        if (!known) {
+            std::cerr << "Unknown suite " << argv[i] << std::endl;
+            return 1;
+        }
+    }
+
+    for (const Suite & suite : SUITES) {
+        bool run = argc == 1;
+        for (int i = 1; i < argc; ++i) {
+            run = run || argv[i] == std::string(suite.name);
+        }
+        if (run) {
+            suite.run();
+        }
+    }
+
+    if (test::failures() > 0) {
+        std::cerr << test::failures() << " checks failed" << std::endl;
+        return 1;
+    }
+    return 0;
+}